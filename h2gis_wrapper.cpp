@@ -3,16 +3,23 @@
 /*******************************************************************************
  * h2gis_wrapper.cpp - Implementation of function pointer wrappers for H2GIS
  * 
- * ALL H2GIS/GraalVM operations are routed through a SINGLE dedicated worker
- * thread with a 64MB stack to avoid StackOverflowError in GraalVM Native Image.
+ * ALL H2GIS/GraalVM operations are routed through dedicated worker threads
+ * with a 64MB stack to avoid StackOverflowError in GraalVM Native Image.
  * 
  * Architecture:
  *   Caller Thread (QGIS worker, 8MB stack)
  *         |
- *         v
- *   [Task Queue] --> [Worker Thread with 64MB stack] --> GraalVM/H2GIS
+ *         v            (routed by connection handle)
+ *   [Task Queue 0] --> [Worker 0, 64MB stack, creates isolate] --> GraalVM
+ *   [Task Queue N] --> [Worker N, 64MB stack, attached thread] --> GraalVM
  *         ^                       |
  *         |_______________________| (result via condition variable)
+ *
+ * The pool size comes from the H2GIS_WORKER_THREADS config option (default
+ * 1). Each connection is pinned to one worker when it is opened, and every
+ * statement, result set and buffer derived from it runs on that same worker,
+ * so calls on one connection stay serialized in submission order while
+ * separate connections execute in parallel.
  ******************************************************************************/
 
 #include "h2gis_wrapper.h"
@@ -54,11 +61,15 @@ typedef pthread_t h2gis_thread_t;
 #include <string.h>
 #include <stdarg.h>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
 #include <queue>
-#include <functional>
 #include <future>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 // Platform abstraction functions - forward declarations
 static h2gis_lib_handle_t h2gis_load_library(const char *path);
@@ -66,7 +77,6 @@ static void *h2gis_get_symbol(h2gis_lib_handle_t handle, const char *name);
 static void h2gis_free_library(h2gis_lib_handle_t handle);
 static const char *h2gis_get_load_error(void);
 static int h2gis_file_exists(const char *path);
-static void h2gis_sleep_ms(unsigned int milliseconds);
 static int h2gis_create_thread_with_stack(h2gis_thread_t *thread,
                                           size_t stack_size,
                                           void *(*func)(void *), void *arg);
@@ -110,11 +120,6 @@ static int h2gis_file_exists(const char *path)
     return _access(path, 0) == 0;
 }
 
-static void h2gis_sleep_ms(unsigned int milliseconds)
-{
-    Sleep(milliseconds);
-}
-
 static int h2gis_create_thread_with_stack(h2gis_thread_t *thread,
                                           size_t stack_size,
                                           void *(*func)(void *), void *arg)
@@ -175,11 +180,6 @@ static int h2gis_file_exists(const char *path)
     return access(path, F_OK) == 0;
 }
 
-static void h2gis_sleep_ms(unsigned int milliseconds)
-{
-    usleep(milliseconds * 1000);
-}
-
 static int h2gis_create_thread_with_stack(h2gis_thread_t *thread,
                                           size_t stack_size,
                                           void *(*func)(void *), void *arg)
@@ -299,17 +299,91 @@ static std::atomic<bool> g_shutdown{false};
 static h2gis_lib_handle_t g_h2gis_handle = nullptr;
 static graal_isolate_t *g_isolate = nullptr;
 static graal_isolatethread_t *g_worker_thread =
-    nullptr;  // Thread handle for the worker
+    nullptr;  // Thread handle of worker 0, which created the isolate
 
-// Worker thread state
-static h2gis_thread_t g_worker_thread_handle;
-static std::mutex g_queue_mutex;
-static std::condition_variable g_queue_cv;
-static std::queue<std::function<void()>> g_task_queue;
+// A queued task is a plain function pointer and the context it runs on,
+// which the submitter keeps alive until the task has run. Queuing one never
+// allocates, unlike a std::function holding a promise.
+struct h2gis_task
+{
+    void (*invoke)(void *context);
+    void *context;
+    std::chrono::steady_clock::time_point queued;  // Set by post_to_worker
+};
+
+// Worker thread state. Worker 0 loads the library and creates the isolate;
+// the others attach to it. Each worker drains its own FIFO queue.
+struct h2gis_worker
+{
+    int index = 0;
+    h2gis_thread_t handle{};
+    graal_isolatethread_t *thread = nullptr;
+    std::atomic<int> state{0};  // 0 starting, 1 ready, -1 failed
+    int connections = 0;        // Open connections pinned here
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::queue<h2gis_task> task_queue;
+    // Buffers given to wrap_h2gis_release_result_buffer(), freed by the
+    // worker before its next task. Guarded by queue_mutex.
+    std::vector<void *> released_buffers;
+};
+
+#define H2GIS_MAX_WORKER_THREADS 64
+
+// Released buffers a worker may hold before a task is queued to free them
+#define H2GIS_MAX_RELEASED_BUFFERS 16
+
+static std::vector<std::unique_ptr<h2gis_worker>> g_workers;
+
+// Handle routing: connection, statement and result set handles share one
+// namespace in the native library, so a single map records which worker
+// owns each of them (and which connection it was derived from).
+struct h2gis_route
+{
+    h2gis_worker *worker;
+    long long conn;
+};
+
+static std::mutex g_route_mutex;
+static std::unordered_map<long long, h2gis_route> g_handle_routes;
+static std::unordered_map<void *, h2gis_worker *> g_buffer_routes;
+
+// Index of the worker that ran the calling thread's last task, so that
+// get_last_error() asks the thread that actually saw the failure
+static thread_local size_t t_last_worker = 0;
 
 // Reference counting for proper shutdown
 static std::atomic<int> g_refcount{0};
 
+// Counters reported by h2gis_wrapper_get_stats(), process-wide. Times are
+// accumulated in nanoseconds.
+static std::atomic<long long> g_stat_tasks{0};
+static std::atomic<long long> g_stat_queue_wait_ns{0};
+static std::atomic<long long> g_stat_worker_ns{0};
+static std::atomic<long long> g_stat_prepares{0};
+static std::atomic<long long> g_stat_executes{0};
+static std::atomic<long long> g_stat_closes{0};
+static std::atomic<long long> g_stat_fetch_batches{0};
+static std::atomic<long long> g_stat_fetch_rows{0};
+static std::atomic<long long> g_stat_fetch_bytes{0};
+
+static void count_stat(std::atomic<long long> &counter, long long value = 1)
+{
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+// Size and row count of a buffer returned by fetch_batch
+static void count_fetch_batch(void *buffer, long long size)
+{
+    count_stat(g_stat_fetch_batches);
+    if (!buffer || size < 8)
+        return;
+    int32_t rows = 0;
+    memcpy(&rows, static_cast<uint8_t *>(buffer) + 4, 4);
+    count_stat(g_stat_fetch_bytes, size);
+    count_stat(g_stat_fetch_rows, rows > 0 ? rows : 0);
+}
+
 // Function pointers
 static fn_h2gis_get_last_error fp_h2gis_get_last_error = nullptr;
 static fn_h2gis_connect fp_h2gis_connect = nullptr;
@@ -343,42 +417,257 @@ static fn_graal_attach_thread fp_graal_attach_thread = nullptr;
 static fn_graal_detach_thread fp_graal_detach_thread = nullptr;
 
 // ============================================================================
-// Task execution helper - runs a task on the worker thread and waits
+// Handle routing - picks the worker that owns a connection-derived handle
+// ============================================================================
+
+static h2gis_worker *worker_for_handle(long long handle)
+{
+    if (g_workers.size() == 1)
+        return g_workers[0].get();
+
+    std::lock_guard<std::mutex> lock(g_route_mutex);
+    auto it = g_handle_routes.find(handle);
+    return it != g_handle_routes.end() ? it->second.worker
+                                       : g_workers[0].get();
+}
+
+static h2gis_worker *worker_for_buffer(void *buffer)
+{
+    if (g_workers.size() == 1)
+        return g_workers[0].get();
+
+    std::lock_guard<std::mutex> lock(g_route_mutex);
+    auto it = g_buffer_routes.find(buffer);
+    return it != g_buffer_routes.end() ? it->second : g_workers[0].get();
+}
+
+// Pins a new connection to the worker with the fewest open connections
+static h2gis_worker *worker_for_new_connection(void)
+{
+    std::lock_guard<std::mutex> lock(g_route_mutex);
+    h2gis_worker *best = g_workers[0].get();
+    for (const auto &worker : g_workers)
+    {
+        if (worker->connections < best->connections)
+            best = worker.get();
+    }
+    best->connections++;
+    return best;
+}
+
+// Records that a statement or result set derived from conn lives on worker
+static void route_handle(long long handle, long long conn,
+                         h2gis_worker *worker)
+{
+    if (g_workers.size() == 1 || handle <= 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_route_mutex);
+    g_handle_routes[handle] = {worker, conn};
+}
+
+static void route_buffer(void *buffer, h2gis_worker *worker)
+{
+    if (g_workers.size() == 1 || buffer == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_route_mutex);
+    g_buffer_routes[buffer] = worker;
+}
+
+static void forget_handle(long long handle)
+{
+    if (g_workers.size() == 1)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_route_mutex);
+    g_handle_routes.erase(handle);
+}
+
+static void forget_buffer(void *buffer)
+{
+    if (g_workers.size() == 1)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_route_mutex);
+    g_buffer_routes.erase(buffer);
+}
+
+// Drops a closed connection and every handle that was derived from it
+static void forget_connection(long long conn, h2gis_worker *worker)
+{
+    std::lock_guard<std::mutex> lock(g_route_mutex);
+    if (worker->connections > 0)
+        worker->connections--;
+    for (auto it = g_handle_routes.begin(); it != g_handle_routes.end();)
+    {
+        if (it->second.conn == conn)
+            it = g_handle_routes.erase(it);
+        else
+            ++it;
+    }
+}
+
+// ============================================================================
+// Task execution helper - runs a task on a worker thread and waits
 // ============================================================================
 
-template <typename Func> auto execute_on_worker(Func &&func) -> decltype(func())
+static void post_to_worker(h2gis_worker *worker, h2gis_task task)
+{
+    task.queued = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(worker->queue_mutex);
+        worker->task_queue.push(task);
+    }
+    worker->queue_cv.notify_one();
+}
+
+// Completion slot of the synchronous calls made by one caller thread. A
+// thread has at most one such call in flight, so the slot is reused.
+struct h2gis_completion
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+};
+
+static thread_local h2gis_completion t_completion;
+
+template <typename Func>
+auto execute_on_worker(h2gis_worker *worker, Func &&func) -> decltype(func())
 {
     using ReturnType = decltype(func());
+    using ResultSlot =
+        typename std::conditional<std::is_void_v<ReturnType>, char,
+                                  ReturnType>::type;
+
+    // Everything the task needs lives on this stack frame, which outlives
+    // the task since the caller blocks until it completes
+    struct call_context
+    {
+        typename std::remove_reference<Func>::type *func;
+        h2gis_completion *completion;
+        ResultSlot result;
+        std::exception_ptr error;
+    } call{&func, &t_completion, ResultSlot(), nullptr};
+
+    h2gis_task task;
+    task.context = &call;
+    task.invoke = [](void *context)
+    {
+        call_context *pCall = static_cast<call_context *>(context);
+        try
+        {
+            if constexpr (std::is_void_v<ReturnType>)
+                (*pCall->func)();
+            else
+                pCall->result = (*pCall->func)();
+        }
+        catch (...)
+        {
+            pCall->error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(pCall->completion->mutex);
+        pCall->completion->done = true;
+        pCall->completion->cv.notify_one();
+    };
 
-    std::promise<ReturnType> promise;
-    std::future<ReturnType> future = promise.get_future();
+    t_last_worker = static_cast<size_t>(worker->index);
+    post_to_worker(worker, task);
 
     {
-        std::lock_guard<std::mutex> lock(g_queue_mutex);
-        g_task_queue.push(
-            [&promise, &func]()
+        std::unique_lock<std::mutex> lock(t_completion.mutex);
+        t_completion.cv.wait(lock, [] { return t_completion.done; });
+        t_completion.done = false;
+    }
+
+    if (call.error)
+        std::rethrow_exception(call.error);
+    if constexpr (!std::is_void_v<ReturnType>)
+        return call.result;
+}
+
+// ============================================================================
+// Task loop shared by all workers
+// ============================================================================
+
+// Frees, on the worker, the buffers released since its previous task
+static void free_released_buffers(h2gis_worker *worker,
+                                  std::vector<void *> &buffers)
+{
+    for (void *buffer : buffers)
+        fp_h2gis_free_result_buffer(worker->thread, buffer);
+    buffers.clear();
+}
+
+// Task queued once H2GIS_MAX_RELEASED_BUFFERS buffers wait: the loop frees
+// them before running it
+static void run_no_task(void *)
+{
+}
+
+static void run_task_loop(h2gis_worker *worker)
+{
+    std::vector<void *> released;
+    while (!g_shutdown.load())
+    {
+        h2gis_task task = {nullptr, nullptr, {}};
+        {
+            std::unique_lock<std::mutex> lock(worker->queue_mutex);
+            worker->queue_cv.wait(
+                lock, [worker]
+                { return !worker->task_queue.empty() || g_shutdown.load(); });
+
+            if (g_shutdown.load() && worker->task_queue.empty())
             {
-                try
-                {
-                    if constexpr (std::is_void_v<ReturnType>)
-                    {
-                        func();
-                        promise.set_value();
-                    }
-                    else
-                    {
-                        promise.set_value(func());
-                    }
-                }
-                catch (...)
-                {
-                    promise.set_exception(std::current_exception());
-                }
-            });
+                break;
+            }
+
+            if (!worker->task_queue.empty())
+            {
+                task = worker->task_queue.front();
+                worker->task_queue.pop();
+            }
+            released.swap(worker->released_buffers);
+        }
+        free_released_buffers(worker, released);
+
+        if (task.invoke)
+        {
+            // The context may be gone once invoke() returns (the submitter
+            // is woken up): only the local copy of the task is used after
+            const auto start = std::chrono::steady_clock::now();
+            task.invoke(task.context);
+            const auto end = std::chrono::steady_clock::now();
+            count_stat(g_stat_tasks);
+            count_stat(g_stat_queue_wait_ns,
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           start - task.queued)
+                           .count());
+            count_stat(g_stat_worker_ns,
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           end - start)
+                           .count());
+        }
+    }
+
+    // Released after the last task
+    {
+        std::lock_guard<std::mutex> lock(worker->queue_mutex);
+        released.swap(worker->released_buffers);
     }
-    g_queue_cv.notify_one();
+    free_released_buffers(worker, released);
+}
 
-    return future.get();
+// Publishes the outcome of a worker's startup to wait_for_worker(), which
+// waits on the queue condition variable (no task is queued before that)
+static void set_worker_state(h2gis_worker *worker, int state)
+{
+    {
+        std::lock_guard<std::mutex> lock(worker->queue_mutex);
+        worker->state.store(state);
+    }
+    worker->queue_cv.notify_all();
 }
 
 // ============================================================================
@@ -387,6 +676,7 @@ template <typename Func> auto execute_on_worker(Func &&func) -> decltype(func())
 
 static void *worker_thread_func(void *arg)
 {
+    h2gis_worker *worker = static_cast<h2gis_worker *>(arg);
     debug_log("worker_thread_func: Starting worker thread with 64MB stack");
 
     // Load library and create isolate HERE (on the large-stack thread)
@@ -427,6 +717,7 @@ static void *worker_thread_func(void *arg)
     {
         debug_log("worker_thread_func: Library load failed: %s",
                   h2gis_get_load_error());
+        set_worker_state(worker, -1);
         return (void *)-1;
     }
 
@@ -450,6 +741,7 @@ static void *worker_thread_func(void *arg)
         debug_log("worker_thread_func: Failed to resolve graal_create_isolate");
         h2gis_free_library(g_h2gis_handle);
         g_h2gis_handle = nullptr;
+        set_worker_state(worker, -1);
         return (void *)-1;
     }
 
@@ -514,6 +806,7 @@ static void *worker_thread_func(void *arg)
             "worker_thread_func: Failed to resolve required H2GIS functions");
         h2gis_free_library(g_h2gis_handle);
         g_h2gis_handle = nullptr;
+        set_worker_state(worker, -1);
         return (void *)-1;
     }
 
@@ -535,6 +828,7 @@ static void *worker_thread_func(void *arg)
         debug_log("worker_thread_func: graal_create_isolate failed: %d", rc);
         h2gis_free_library(g_h2gis_handle);
         g_h2gis_handle = nullptr;
+        set_worker_state(worker, -1);
         return (void *)-1;
     }
 
@@ -542,48 +836,66 @@ static void *worker_thread_func(void *arg)
               (void *)g_isolate, (void *)g_worker_thread);
 
     // Signal that initialization is complete
-    g_initialized.store(true);
+    worker->thread = g_worker_thread;
+    set_worker_state(worker, 1);
 
     // Main task processing loop
     debug_log("worker_thread_func: Entering task loop...");
-    while (!g_shutdown.load())
+    run_task_loop(worker);
+
+    debug_log("worker_thread_func: Shutting down...");
+
+    // Cleanup
+    if (g_worker_thread && fp_graal_detach_thread)
     {
-        std::function<void()> task;
-        {
-            std::unique_lock<std::mutex> lock(g_queue_mutex);
-            g_queue_cv.wait(
-                lock,
-                [] { return !g_task_queue.empty() || g_shutdown.load(); });
+        fp_graal_detach_thread(g_worker_thread);
+    }
 
-            if (g_shutdown.load() && g_task_queue.empty())
-            {
-                break;
-            }
+    return nullptr;
+}
 
-            if (!g_task_queue.empty())
-            {
-                task = std::move(g_task_queue.front());
-                g_task_queue.pop();
-            }
-        }
+// ============================================================================
+// Additional pool workers - attach to the isolate created by worker 0
+// ============================================================================
 
-        if (task)
-        {
-            task();
-        }
+static void *pool_worker_func(void *arg)
+{
+    h2gis_worker *worker = static_cast<h2gis_worker *>(arg);
+
+    graal_isolatethread_t *thread = nullptr;
+    if (!fp_graal_attach_thread ||
+        fp_graal_attach_thread(g_isolate, &thread) != 0)
+    {
+        debug_log("pool_worker_func: Worker %d failed to attach to isolate",
+                  worker->index);
+        set_worker_state(worker, -1);
+        return (void *)-1;
     }
 
-    debug_log("worker_thread_func: Shutting down...");
+    worker->thread = thread;
+    set_worker_state(worker, 1);
+    debug_log("pool_worker_func: Worker %d attached, thread=%p",
+              worker->index, (void *)thread);
 
-    // Cleanup
-    if (g_worker_thread && fp_graal_detach_thread)
+    run_task_loop(worker);
+
+    if (fp_graal_detach_thread)
     {
-        fp_graal_detach_thread(g_worker_thread);
+        fp_graal_detach_thread(thread);
     }
 
     return nullptr;
 }
 
+// Waits up to 10 seconds for a worker to leave the starting state
+static bool wait_for_worker(h2gis_worker *worker)
+{
+    std::unique_lock<std::mutex> lock(worker->queue_mutex);
+    worker->queue_cv.wait_for(lock, std::chrono::seconds(10),
+                              [worker] { return worker->state.load() != 0; });
+    return worker->state.load() == 1;
+}
+
 // ============================================================================
 // Public initialization
 // ============================================================================
@@ -603,33 +915,62 @@ extern "C" int h2gis_wrapper_init(void)
         return 0;
     }
 
+    int nWorkers = atoi(CPLGetConfigOption("H2GIS_WORKER_THREADS", "1"));
+    if (nWorkers < 1)
+        nWorkers = 1;
+    else if (nWorkers > H2GIS_MAX_WORKER_THREADS)
+        nWorkers = H2GIS_MAX_WORKER_THREADS;
+
     debug_log("h2gis_wrapper_init: Creating worker thread with 64MB stack...");
 
     size_t stack_size = 64 * 1024 * 1024;  // 64 MB
-    if (h2gis_create_thread_with_stack(&g_worker_thread_handle, stack_size,
-                                        worker_thread_func, nullptr) != 0)
+    g_workers.clear();
+    g_workers.emplace_back(new h2gis_worker());
+    h2gis_worker *primary = g_workers[0].get();
+    if (h2gis_create_thread_with_stack(&primary->handle, stack_size,
+                                        worker_thread_func, primary) != 0)
     {
         debug_log("h2gis_wrapper_init: Failed to create worker thread");
+        g_workers.clear();
         return -1;
     }
 
     // Wait for initialization to complete (with timeout)
-    int wait_count = 0;
-    while (!g_initialized.load() && wait_count < 100)
-    {  // 10 second timeout
-        h2gis_sleep_ms(100);
-        wait_count++;
-    }
-
-    if (!g_initialized.load())
+    if (!wait_for_worker(primary))
     {
         debug_log("h2gis_wrapper_init: Timeout waiting for worker thread init");
         g_shutdown.store(true);
-        g_queue_cv.notify_all();
-        h2gis_join_thread(g_worker_thread_handle);
+        primary->queue_cv.notify_all();
+        h2gis_join_thread(primary->handle);
+        g_workers.clear();
         return -1;
     }
 
+    // Start the rest of the pool. A worker that cannot attach only shrinks
+    // the pool: connections are spread over the workers that did start.
+    for (int i = 1; i < nWorkers; i++)
+    {
+        std::unique_ptr<h2gis_worker> worker(new h2gis_worker());
+        worker->index = i;
+        if (h2gis_create_thread_with_stack(&worker->handle, stack_size,
+                                            pool_worker_func,
+                                            worker.get()) != 0)
+        {
+            debug_log("h2gis_wrapper_init: Failed to create worker %d", i);
+            break;
+        }
+        if (!wait_for_worker(worker.get()))
+        {
+            h2gis_join_thread(worker->handle);
+            break;
+        }
+        g_workers.push_back(std::move(worker));
+    }
+    debug_log("h2gis_wrapper_init: %d worker thread(s) running",
+              (int)g_workers.size());
+
+    g_initialized.store(true);
+
     // NOTE: We use GDAL's pfnUnloadDriver mechanism (OGRH2GISDriverUnload)
     // to trigger shutdown instead of atexit which may run too late.
 
@@ -637,11 +978,35 @@ extern "C" int h2gis_wrapper_init(void)
     return 0;
 }
 
+extern "C" void h2gis_wrapper_init_async(void)
+{
+    // Nothing else runs on this thread: it only waits for worker 0, which
+    // creates the isolate on its own large stack, and for the pool
+    static std::atomic<bool> s_started{false};
+    if (g_initialized.load() || s_started.exchange(true))
+        return;
+    debug_log("h2gis_wrapper_init_async: Starting background initialization");
+    try
+    {
+        std::thread([]() { h2gis_wrapper_init(); }).detach();
+    }
+    catch (const std::system_error &)
+    {
+        debug_log("h2gis_wrapper_init_async: Failed to start thread");
+    }
+}
+
 extern "C" int h2gis_wrapper_is_initialized(void)
 {
     return g_initialized.load() ? 1 : 0;
 }
 
+extern "C" int h2gis_wrapper_get_worker_count(void)
+{
+    // The pool is only changed by initialization and shutdown
+    return g_initialized.load() ? static_cast<int>(g_workers.size()) : 0;
+}
+
 extern "C" void h2gis_wrapper_add_ref(void)
 {
     g_refcount.fetch_add(1);
@@ -662,6 +1027,8 @@ extern "C" void h2gis_wrapper_release(void)
 
 extern "C" void h2gis_wrapper_shutdown(void)
 {
+    // Waits for an initialization in progress (H2GIS_EAGER_INIT) to end
+    std::lock_guard<std::mutex> init_lock(g_init_mutex);
     if (!g_initialized.load())
     {
         return;
@@ -670,10 +1037,27 @@ extern "C" void h2gis_wrapper_shutdown(void)
     debug_log("h2gis_wrapper_shutdown: Signaling shutdown...");
 
     g_shutdown.store(true);
-    g_queue_cv.notify_all();
 
-    debug_log("h2gis_wrapper_shutdown: Waiting for worker thread to exit...");
-    h2gis_join_thread(g_worker_thread_handle);
+    debug_log("h2gis_wrapper_shutdown: Waiting for worker threads to exit...");
+    // Stop the attached workers first so they detach before worker 0, which
+    // owns the isolate, does
+    for (size_t i = g_workers.size(); i-- > 0;)
+    {
+        h2gis_worker *worker = g_workers[i].get();
+        {
+            // Take the queue lock so the worker cannot miss the wakeup
+            // between its predicate check and its wait
+            std::lock_guard<std::mutex> lock(worker->queue_mutex);
+            worker->queue_cv.notify_all();
+        }
+        h2gis_join_thread(worker->handle);
+    }
+    g_workers.clear();
+    {
+        std::lock_guard<std::mutex> lock(g_route_mutex);
+        g_handle_routes.clear();
+        g_buffer_routes.clear();
+    }
 
     if (g_h2gis_handle)
     {
@@ -703,20 +1087,40 @@ extern "C" graal_isolatethread_t *h2gis_wrapper_get_thread(void)
     {
         return nullptr;
     }
-    // Always return the worker thread - all operations go through it
+    // Return worker 0's thread - every call is rerouted to the worker that
+    // owns its handle, so the value is only a placeholder for callers
     return g_worker_thread;
 }
 
+extern "C" void h2gis_wrapper_get_stats(h2gis_wrapper_stats_t *stats)
+{
+    if (!stats)
+        return;
+    stats->tasks = g_stat_tasks.load(std::memory_order_relaxed);
+    stats->queue_wait_us =
+        g_stat_queue_wait_ns.load(std::memory_order_relaxed) / 1000;
+    stats->worker_us = g_stat_worker_ns.load(std::memory_order_relaxed) / 1000;
+    stats->prepares = g_stat_prepares.load(std::memory_order_relaxed);
+    stats->executes = g_stat_executes.load(std::memory_order_relaxed);
+    stats->closes = g_stat_closes.load(std::memory_order_relaxed);
+    stats->fetch_batches = g_stat_fetch_batches.load(std::memory_order_relaxed);
+    stats->fetch_rows = g_stat_fetch_rows.load(std::memory_order_relaxed);
+    stats->fetch_bytes = g_stat_fetch_bytes.load(std::memory_order_relaxed);
+}
+
 // ============================================================================
-// Wrapper functions - ALL operations are routed through the worker thread
+// Wrapper functions - ALL operations are routed through the worker threads
 // ============================================================================
 
 extern "C" char *wrap_h2gis_get_last_error(graal_isolatethread_t *thread)
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_get_last_error)
         return nullptr;
+    h2gis_worker *worker = t_last_worker < g_workers.size()
+                               ? g_workers[t_last_worker].get()
+                               : g_workers[0].get();
     return execute_on_worker(
-        [&]() { return fp_h2gis_get_last_error(g_worker_thread); });
+        worker, [&]() { return fp_h2gis_get_last_error(worker->thread); });
 }
 
 extern "C" long long int wrap_h2gis_connect(graal_isolatethread_t *thread,
@@ -727,9 +1131,16 @@ extern "C" long long int wrap_h2gis_connect(graal_isolatethread_t *thread,
     if (!fp_h2gis_connect)
         return -1;
     debug_log("wrap_h2gis_connect: Connecting to %s", path);
+    h2gis_worker *worker = worker_for_new_connection();
     long long conn = execute_on_worker(
-        [&]() { return fp_h2gis_connect(g_worker_thread, path, user, pass); });
-    debug_log("wrap_h2gis_connect: Result %lld", conn);
+        worker,
+        [&]() { return fp_h2gis_connect(worker->thread, path, user, pass); });
+    if (conn > 0)
+        route_handle(conn, conn, worker);
+    else
+        forget_connection(conn, worker);
+    debug_log("wrap_h2gis_connect: Result %lld on worker %d", conn,
+              worker->index);
     return conn;
 }
 
@@ -739,17 +1150,22 @@ extern "C" long long int wrap_h2gis_load(graal_isolatethread_t *thread,
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_load)
         return -1;
     debug_log("wrap_h2gis_load: Loading functions for conn %lld", conn);
-    return execute_on_worker([&]()
-                             { return fp_h2gis_load(g_worker_thread, conn); });
+    h2gis_worker *worker = worker_for_handle(conn);
+    return execute_on_worker(
+        worker, [&]() { return fp_h2gis_load(worker->thread, conn); });
 }
 
 extern "C" long long int wrap_h2gis_fetch(graal_isolatethread_t *thread,
-                                          long long int rs, char *sql)
+                                          long long int conn, char *sql)
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_fetch)
         return -1;
-    return execute_on_worker(
-        [&]() { return fp_h2gis_fetch(g_worker_thread, rs, sql); });
+    h2gis_worker *worker = worker_for_handle(conn);
+    count_stat(g_stat_executes);
+    long long rs = execute_on_worker(
+        worker, [&]() { return fp_h2gis_fetch(worker->thread, conn, sql); });
+    route_handle(rs, conn, worker);
+    return rs;
 }
 
 extern "C" int wrap_h2gis_execute(graal_isolatethread_t *thread,
@@ -757,8 +1173,10 @@ extern "C" int wrap_h2gis_execute(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_execute)
         return -1;
+    h2gis_worker *worker = worker_for_handle(conn);
+    count_stat(g_stat_executes);
     return execute_on_worker(
-        [&]() { return fp_h2gis_execute(g_worker_thread, conn, sql); });
+        worker, [&]() { return fp_h2gis_execute(worker->thread, conn, sql); });
 }
 
 extern "C" long long int wrap_h2gis_prepare(graal_isolatethread_t *thread,
@@ -767,8 +1185,12 @@ extern "C" long long int wrap_h2gis_prepare(graal_isolatethread_t *thread,
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_prepare)
         return 0;
     debug_log("wrap_h2gis_prepare: SQL = %.100s...", sql);
-    return execute_on_worker(
-        [&]() { return fp_h2gis_prepare(g_worker_thread, conn, sql); });
+    h2gis_worker *worker = worker_for_handle(conn);
+    count_stat(g_stat_prepares);
+    long long stmt = execute_on_worker(
+        worker, [&]() { return fp_h2gis_prepare(worker->thread, conn, sql); });
+    route_handle(stmt, conn, worker);
+    return stmt;
 }
 
 extern "C" void wrap_h2gis_bind_double(graal_isolatethread_t *thread,
@@ -776,8 +1198,10 @@ extern "C" void wrap_h2gis_bind_double(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_bind_double)
         return;
+    h2gis_worker *worker = worker_for_handle(stmt);
     execute_on_worker(
-        [&]() { fp_h2gis_bind_double(g_worker_thread, stmt, idx, val); });
+        worker,
+        [&]() { fp_h2gis_bind_double(worker->thread, stmt, idx, val); });
 }
 
 extern "C" void wrap_h2gis_bind_int(graal_isolatethread_t *thread,
@@ -785,8 +1209,9 @@ extern "C" void wrap_h2gis_bind_int(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_bind_int)
         return;
-    execute_on_worker([&]()
-                      { fp_h2gis_bind_int(g_worker_thread, stmt, idx, val); });
+    h2gis_worker *worker = worker_for_handle(stmt);
+    execute_on_worker(
+        worker, [&]() { fp_h2gis_bind_int(worker->thread, stmt, idx, val); });
 }
 
 extern "C" void wrap_h2gis_bind_long(graal_isolatethread_t *thread,
@@ -795,8 +1220,9 @@ extern "C" void wrap_h2gis_bind_long(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_bind_long)
         return;
-    execute_on_worker([&]()
-                      { fp_h2gis_bind_long(g_worker_thread, stmt, idx, val); });
+    h2gis_worker *worker = worker_for_handle(stmt);
+    execute_on_worker(
+        worker, [&]() { fp_h2gis_bind_long(worker->thread, stmt, idx, val); });
 }
 
 extern "C" void wrap_h2gis_bind_string(graal_isolatethread_t *thread,
@@ -804,8 +1230,10 @@ extern "C" void wrap_h2gis_bind_string(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_bind_string)
         return;
+    h2gis_worker *worker = worker_for_handle(stmt);
     execute_on_worker(
-        [&]() { fp_h2gis_bind_string(g_worker_thread, stmt, idx, val); });
+        worker,
+        [&]() { fp_h2gis_bind_string(worker->thread, stmt, idx, val); });
 }
 
 extern "C" void wrap_h2gis_bind_blob(graal_isolatethread_t *thread,
@@ -814,8 +1242,10 @@ extern "C" void wrap_h2gis_bind_blob(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_bind_blob)
         return;
+    h2gis_worker *worker = worker_for_handle(stmt);
     execute_on_worker(
-        [&]() { fp_h2gis_bind_blob(g_worker_thread, stmt, idx, data, len); });
+        worker,
+        [&]() { fp_h2gis_bind_blob(worker->thread, stmt, idx, data, len); });
 }
 
 extern "C" int wrap_h2gis_execute_prepared_update(graal_isolatethread_t *thread,
@@ -823,9 +1253,12 @@ extern "C" int wrap_h2gis_execute_prepared_update(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_execute_prepared_update)
         return -1;
+    h2gis_worker *worker = worker_for_handle(stmt);
+    count_stat(g_stat_executes);
     return execute_on_worker(
+        worker,
         [&]()
-        { return fp_h2gis_execute_prepared_update(g_worker_thread, stmt); });
+        { return fp_h2gis_execute_prepared_update(worker->thread, stmt); });
 }
 
 extern "C" long long int
@@ -833,8 +1266,19 @@ wrap_h2gis_execute_prepared(graal_isolatethread_t *thread, long long int stmt)
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_execute_prepared)
         return 0;
-    return execute_on_worker(
-        [&]() { return fp_h2gis_execute_prepared(g_worker_thread, stmt); });
+    h2gis_worker *worker = worker_for_handle(stmt);
+    count_stat(g_stat_executes);
+    long long rs = execute_on_worker(
+        worker,
+        [&]() { return fp_h2gis_execute_prepared(worker->thread, stmt); });
+    if (g_workers.size() > 1 && rs > 0)
+    {
+        std::lock_guard<std::mutex> lock(g_route_mutex);
+        auto it = g_handle_routes.find(stmt);
+        if (it != g_handle_routes.end())
+            g_handle_routes[rs] = it->second;
+    }
+    return rs;
 }
 
 extern "C" void wrap_h2gis_close_query(graal_isolatethread_t *thread,
@@ -842,7 +1286,11 @@ extern "C" void wrap_h2gis_close_query(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_close_query || handle == 0)
         return;
-    execute_on_worker([&]() { fp_h2gis_close_query(g_worker_thread, handle); });
+    h2gis_worker *worker = worker_for_handle(handle);
+    count_stat(g_stat_closes);
+    execute_on_worker(worker,
+                      [&]() { fp_h2gis_close_query(worker->thread, handle); });
+    forget_handle(handle);
 }
 
 extern "C" void wrap_h2gis_close_connection(graal_isolatethread_t *thread,
@@ -851,8 +1299,10 @@ extern "C" void wrap_h2gis_close_connection(graal_isolatethread_t *thread,
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_close_connection ||
         conn < 0)
         return;
-    execute_on_worker([&]()
-                      { fp_h2gis_close_connection(g_worker_thread, conn); });
+    h2gis_worker *worker = worker_for_handle(conn);
+    execute_on_worker(
+        worker, [&]() { fp_h2gis_close_connection(worker->thread, conn); });
+    forget_connection(conn, worker);
 }
 
 extern "C" void
@@ -861,8 +1311,11 @@ wrap_h2gis_delete_database_and_close(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_delete_database_and_close)
         return;
+    h2gis_worker *worker = worker_for_handle(conn);
     execute_on_worker(
-        [&]() { fp_h2gis_delete_database_and_close(g_worker_thread, conn); });
+        worker,
+        [&]() { fp_h2gis_delete_database_and_close(worker->thread, conn); });
+    forget_connection(conn, worker);
 }
 
 extern "C" void *wrap_h2gis_fetch_all(graal_isolatethread_t *thread,
@@ -870,8 +1323,12 @@ extern "C" void *wrap_h2gis_fetch_all(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_fetch_all)
         return nullptr;
-    return execute_on_worker(
-        [&]() { return fp_h2gis_fetch_all(g_worker_thread, rs, sizeOut); });
+    h2gis_worker *worker = worker_for_handle(rs);
+    void *buffer = execute_on_worker(
+        worker,
+        [&]() { return fp_h2gis_fetch_all(worker->thread, rs, sizeOut); });
+    route_buffer(buffer, worker);
+    return buffer;
 }
 
 extern "C" void *wrap_h2gis_fetch_one(graal_isolatethread_t *thread,
@@ -879,8 +1336,12 @@ extern "C" void *wrap_h2gis_fetch_one(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_fetch_one)
         return nullptr;
-    return execute_on_worker(
-        [&]() { return fp_h2gis_fetch_one(g_worker_thread, rs, sizeOut); });
+    h2gis_worker *worker = worker_for_handle(rs);
+    void *buffer = execute_on_worker(
+        worker,
+        [&]() { return fp_h2gis_fetch_one(worker->thread, rs, sizeOut); });
+    route_buffer(buffer, worker);
+    return buffer;
 }
 
 extern "C" void *wrap_h2gis_fetch_batch(graal_isolatethread_t *thread,
@@ -889,11 +1350,134 @@ extern "C" void *wrap_h2gis_fetch_batch(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_fetch_batch)
         return nullptr;
-    return execute_on_worker(
+    h2gis_worker *worker = worker_for_handle(rs);
+    void *buffer = execute_on_worker(
+        worker,
         [&]() {
-            return fp_h2gis_fetch_batch(g_worker_thread, rs, batchSize,
+            return fp_h2gis_fetch_batch(worker->thread, rs, batchSize,
                                         sizeOut);
         });
+    count_fetch_batch(buffer, sizeOut ? *static_cast<long long *>(sizeOut) : 0);
+    route_buffer(buffer, worker);
+    return buffer;
+}
+
+// ============================================================================
+// Asynchronous batch fetch - queued on the worker, collected later
+// ============================================================================
+
+struct h2gis_async_fetch
+{
+    std::promise<void *> promise;
+    long long size = 0;
+    h2gis_worker *worker = nullptr;
+    long long rs = 0;
+    int batchSize = 0;
+};
+
+static void run_async_fetch(void *context)
+{
+    h2gis_async_fetch_t *handle = static_cast<h2gis_async_fetch_t *>(context);
+    long long size = 0;
+    void *buffer = fp_h2gis_fetch_batch(handle->worker->thread, handle->rs,
+                                        handle->batchSize, &size);
+    count_fetch_batch(buffer, size);
+    route_buffer(buffer, handle->worker);
+    handle->size = size;
+    handle->promise.set_value(buffer);
+}
+
+extern "C" h2gis_async_fetch_t *
+wrap_h2gis_fetch_batch_async(graal_isolatethread_t *thread, long long int rs,
+                             int batchSize)
+{
+    if (!h2gis_wrapper_is_initialized() || !fp_h2gis_fetch_batch)
+        return nullptr;
+
+    // The handle owns everything the task touches: the caller does not wait
+    // here, so nothing may be captured by reference.
+    h2gis_async_fetch_t *handle = new h2gis_async_fetch_t();
+    handle->worker = worker_for_handle(rs);
+    handle->rs = rs;
+    handle->batchSize = batchSize;
+    post_to_worker(handle->worker, {run_async_fetch, handle, {}});
+    return handle;
+}
+
+extern "C" void *wrap_h2gis_fetch_batch_wait(h2gis_async_fetch_t *handle,
+                                             long long int *sizeOut)
+{
+    if (sizeOut)
+        *sizeOut = 0;
+    if (!handle)
+        return nullptr;
+
+    void *buffer = handle->promise.get_future().get();
+    if (sizeOut)
+        *sizeOut = handle->size;
+    delete handle;
+    return buffer;
+}
+
+// ============================================================================
+// Compound calls - a whole statement round trip as a single worker task
+// ============================================================================
+
+// Executes stmt and fetches its first row; runs on the worker
+static void *fetch_first_row(h2gis_worker *worker, long long stmt,
+                             void *sizeOut)
+{
+    count_stat(g_stat_executes);
+    long long rs = fp_h2gis_execute_prepared(worker->thread, stmt);
+    if (!rs)
+        return nullptr;
+    void *buffer = fp_h2gis_fetch_one(worker->thread, rs, sizeOut);
+    count_stat(g_stat_closes);
+    fp_h2gis_close_query(worker->thread, rs);
+    return buffer;
+}
+
+extern "C" void *wrap_h2gis_query_first_row(graal_isolatethread_t *thread,
+                                            long long int conn, char *sql,
+                                            char **params, int paramCount,
+                                            void *sizeOut)
+{
+    if (!h2gis_wrapper_is_initialized() || !fp_h2gis_prepare ||
+        !fp_h2gis_execute_prepared || !fp_h2gis_fetch_one ||
+        !fp_h2gis_close_query || (paramCount > 0 && !fp_h2gis_bind_string))
+        return nullptr;
+    h2gis_worker *worker = worker_for_handle(conn);
+    void *buffer = execute_on_worker(
+        worker,
+        [&]() -> void *
+        {
+            count_stat(g_stat_prepares);
+            long long stmt = fp_h2gis_prepare(worker->thread, conn, sql);
+            if (!stmt)
+                return nullptr;
+            for (int i = 0; i < paramCount; i++)
+                fp_h2gis_bind_string(worker->thread, stmt, i + 1, params[i]);
+            void *firstRow = fetch_first_row(worker, stmt, sizeOut);
+            count_stat(g_stat_closes);
+            fp_h2gis_close_query(worker->thread, stmt);
+            return firstRow;
+        });
+    route_buffer(buffer, worker);
+    return buffer;
+}
+
+extern "C" void *
+wrap_h2gis_execute_prepared_first_row(graal_isolatethread_t *thread,
+                                      long long int stmt, void *sizeOut)
+{
+    if (!h2gis_wrapper_is_initialized() || !fp_h2gis_execute_prepared ||
+        !fp_h2gis_fetch_one || !fp_h2gis_close_query)
+        return nullptr;
+    h2gis_worker *worker = worker_for_handle(stmt);
+    void *buffer = execute_on_worker(
+        worker, [&]() { return fetch_first_row(worker, stmt, sizeOut); });
+    route_buffer(buffer, worker);
+    return buffer;
 }
 
 extern "C" void *wrap_h2gis_get_column_types(graal_isolatethread_t *thread,
@@ -901,9 +1485,13 @@ extern "C" void *wrap_h2gis_get_column_types(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_get_column_types)
         return nullptr;
-    return execute_on_worker(
+    h2gis_worker *worker = worker_for_handle(stmt);
+    void *buffer = execute_on_worker(
+        worker,
         [&]()
-        { return fp_h2gis_get_column_types(g_worker_thread, stmt, sizeOut); });
+        { return fp_h2gis_get_column_types(worker->thread, stmt, sizeOut); });
+    route_buffer(buffer, worker);
+    return buffer;
 }
 
 extern "C" char *wrap_h2gis_get_metadata_json(graal_isolatethread_t *thread,
@@ -911,8 +1499,10 @@ extern "C" char *wrap_h2gis_get_metadata_json(graal_isolatethread_t *thread,
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_get_metadata_json)
         return nullptr;
+    h2gis_worker *worker = worker_for_handle(conn);
     return execute_on_worker(
-        [&]() { return fp_h2gis_get_metadata_json(g_worker_thread, conn); });
+        worker,
+        [&]() { return fp_h2gis_get_metadata_json(worker->thread, conn); });
 }
 
 extern "C" long long int
@@ -920,8 +1510,33 @@ wrap_h2gis_free_result_set(graal_isolatethread_t *thread, long long int rs)
 {
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_free_result_set)
         return -1;
-    return execute_on_worker(
-        [&]() { return fp_h2gis_free_result_set(g_worker_thread, rs); });
+    h2gis_worker *worker = worker_for_handle(rs);
+    count_stat(g_stat_closes);
+    long long ret = execute_on_worker(
+        worker, [&]() { return fp_h2gis_free_result_set(worker->thread, rs); });
+    forget_handle(rs);
+    return ret;
+}
+
+extern "C" void wrap_h2gis_release_result_buffer(graal_isolatethread_t *thread,
+                                                 void *buffer)
+{
+    if (!h2gis_wrapper_is_initialized() || !fp_h2gis_free_result_buffer ||
+        buffer == nullptr)
+        return;
+    // The address cannot be handed out again before the worker frees it, but
+    // its route must be gone by then
+    h2gis_worker *worker = worker_for_buffer(buffer);
+    forget_buffer(buffer);
+    bool bDrain;
+    {
+        std::lock_guard<std::mutex> lock(worker->queue_mutex);
+        worker->released_buffers.push_back(buffer);
+        bDrain = worker->released_buffers.size() >= H2GIS_MAX_RELEASED_BUFFERS;
+    }
+    // Not waited for: the caller goes on while the worker frees them
+    if (bDrain)
+        post_to_worker(worker, {run_no_task, nullptr, {}});
 }
 
 extern "C" void wrap_h2gis_free_result_buffer(graal_isolatethread_t *thread,
@@ -930,6 +1545,10 @@ extern "C" void wrap_h2gis_free_result_buffer(graal_isolatethread_t *thread,
     if (!h2gis_wrapper_is_initialized() || !fp_h2gis_free_result_buffer ||
         buffer == nullptr)
         return;
+    // Forget the route before freeing: once freed, the address may be handed
+    // out again by a fetch running on another worker
+    h2gis_worker *worker = worker_for_buffer(buffer);
+    forget_buffer(buffer);
     execute_on_worker(
-        [&]() { fp_h2gis_free_result_buffer(g_worker_thread, buffer); });
+        worker, [&]() { fp_h2gis_free_result_buffer(worker->thread, buffer); });
 }
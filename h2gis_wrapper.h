@@ -28,9 +28,16 @@ extern "C"
     // Returns 0 on success, -1 on failure
     int h2gis_wrapper_init(void);
 
+    // Start h2gis_wrapper_init() on a background thread and return at once.
+    // A later h2gis_wrapper_init() call waits for it to complete.
+    void h2gis_wrapper_init_async(void);
+
     // Check if wrapper is initialized
     int h2gis_wrapper_is_initialized(void);
 
+    // Number of worker threads of the pool, 0 before initialization
+    int h2gis_wrapper_get_worker_count(void);
+
     // Reference counting for proper shutdown
     // Call add_ref when opening a datasource, release when closing
     void h2gis_wrapper_add_ref(void);
@@ -39,12 +46,31 @@ extern "C"
     // Force shutdown (called when last datasource closes)
     void h2gis_wrapper_shutdown(void);
 
-    // Get the global isolate thread (attaches current thread if needed)
+    // Get the global isolate thread. Calls are routed to the pool worker that
+    // owns their handle (see H2GIS_WORKER_THREADS), whatever thread is passed
     graal_isolatethread_t *h2gis_wrapper_get_thread(void);
 
     // Get the global isolate
     graal_isolate_t *h2gis_wrapper_get_isolate(void);
 
+    // Process-wide counters of the calls made through the wrapper, since the
+    // plugin was loaded. A task is one call queued on a worker thread:
+    // queue_wait_us is the time tasks waited in the queues, worker_us the
+    // time the workers spent running them (mostly inside the library).
+    typedef struct h2gis_wrapper_stats
+    {
+        long long tasks;
+        long long queue_wait_us;
+        long long worker_us;
+        long long prepares;      // Statements prepared
+        long long executes;      // Statements executed
+        long long closes;        // Statements and result sets closed
+        long long fetch_batches; // fetch_batch calls, async ones included
+        long long fetch_rows;    // Rows returned by them
+        long long fetch_bytes;   // Bytes returned by them
+    } h2gis_wrapper_stats_t;
+    void h2gis_wrapper_get_stats(h2gis_wrapper_stats_t *stats);
+
     // H2GIS Function wrappers - same signatures as h2gis.h but resolved via dlsym
     char *wrap_h2gis_get_last_error(graal_isolatethread_t *thread);
     long long int wrap_h2gis_connect(graal_isolatethread_t *thread, char *path,
@@ -52,7 +78,7 @@ extern "C"
     long long int wrap_h2gis_load(graal_isolatethread_t *thread,
                                   long long int conn);
     long long int wrap_h2gis_fetch(graal_isolatethread_t *thread,
-                                   long long int rs, char *sql);
+                                   long long int conn, char *sql);
     int wrap_h2gis_execute(graal_isolatethread_t *thread, long long int conn,
                            char *sql);
     long long int wrap_h2gis_prepare(graal_isolatethread_t *thread,
@@ -84,6 +110,37 @@ extern "C"
     void *wrap_h2gis_fetch_batch(graal_isolatethread_t *thread,
                                  long long int rs, int batchSize,
                                  void *sizeOut);
+
+    // Asynchronous batch fetch: the fetch is queued on the worker thread and
+    // the call returns immediately. Tasks run in submission order, so a
+    // later call on the same result set always sees the fetch completed.
+    // Every non-null handle must be collected with wrap_h2gis_fetch_batch_wait,
+    // which blocks until the batch is ready and releases the handle.
+    typedef struct h2gis_async_fetch h2gis_async_fetch_t;
+    h2gis_async_fetch_t *
+    wrap_h2gis_fetch_batch_async(graal_isolatethread_t *thread,
+                                 long long int rs, int batchSize);
+    void *wrap_h2gis_fetch_batch_wait(h2gis_async_fetch_t *handle,
+                                      long long int *sizeOut);
+
+    // Compound calls: each runs as a single task on the worker thread instead
+    // of one task per step. Both return a buffer in the h2gis_fetch_one()
+    // layout holding at most the first row (the column headers are present
+    // even when the result is empty), or NULL if the statement failed. The
+    // buffer must be released with wrap_h2gis_free_result_buffer.
+    //
+    // query_first_row prepares sql, binds params[0..paramCount-1] as strings,
+    // executes it and closes the statement and its result set.
+    void *wrap_h2gis_query_first_row(graal_isolatethread_t *thread,
+                                     long long int conn, char *sql,
+                                     char **params, int paramCount,
+                                     void *sizeOut);
+    // execute_prepared_first_row executes an already bound statement and
+    // closes its result set; the statement stays open for reuse.
+    void *wrap_h2gis_execute_prepared_first_row(graal_isolatethread_t *thread,
+                                                long long int stmt,
+                                                void *sizeOut);
+
     void *wrap_h2gis_get_column_types(graal_isolatethread_t *thread,
                                       long long int stmt, void *sizeOut);
     char *wrap_h2gis_get_metadata_json(graal_isolatethread_t *thread,
@@ -92,6 +149,11 @@ extern "C"
                                              long long int rs);
     void wrap_h2gis_free_result_buffer(graal_isolatethread_t *thread,
                                        void *buffer);
+    // Like wrap_h2gis_free_result_buffer, without a task of its own: the
+    // buffer is freed by its worker before the next task it runs, typically
+    // the fetch of the batch replacing it. The buffer must not be used after.
+    void wrap_h2gis_release_result_buffer(graal_isolatethread_t *thread,
+                                          void *buffer);
 
 #ifdef __cplusplus
 }
@@ -117,9 +179,14 @@ extern "C"
 #define h2gis_fetch_all wrap_h2gis_fetch_all
 #define h2gis_fetch_one wrap_h2gis_fetch_one
 #define h2gis_fetch_batch wrap_h2gis_fetch_batch
+#define h2gis_fetch_batch_async wrap_h2gis_fetch_batch_async
+#define h2gis_fetch_batch_wait wrap_h2gis_fetch_batch_wait
+#define h2gis_query_first_row wrap_h2gis_query_first_row
+#define h2gis_execute_prepared_first_row wrap_h2gis_execute_prepared_first_row
 #define h2gis_get_column_types wrap_h2gis_get_column_types
 #define h2gis_get_metadata_json wrap_h2gis_get_metadata_json
 #define h2gis_free_result_set wrap_h2gis_free_result_set
 #define h2gis_free_result_buffer wrap_h2gis_free_result_buffer
+#define h2gis_release_result_buffer wrap_h2gis_release_result_buffer
 
 #endif  // H2GIS_WRAPPER_H_INCLUDED
@@ -7,10 +7,15 @@
 #include "ogrsf_frmts.h"
 // Use wrapper instead of direct h2gis.h to enable lazy loading via dlopen
 #include "h2gis_wrapper.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
 #include <vector>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 
 constexpr const char *H2GIS_DRIVER_NAME = "H2GIS";
 
@@ -189,8 +194,356 @@ inline const char *GetH2GeomZMSuffix(OGRwkbGeometryType eType)
     return "";
 }
 
+// H2GIS serializes geometries as EWKB. When the SRID flag is set in the type,
+// the 4-byte SRID follows the type:
+//   EWKB: [byte order 1][type | 0x20000000 4][SRID 4][geometry data]
+//   WKB:  [byte order 1][type 4][geometry data]
+constexpr uint32_t H2GIS_EWKB_SRID_FLAG = 0x20000000;
+
+inline bool H2GISEWKBHasSRID(const uint8_t *pabyEWKB, int32_t nLen)
+{
+    if (nLen < 9)
+        return false;
+    // The flag lives in the most significant byte of the type
+    const uint8_t nTypeMSB = pabyEWKB[0] == 1 ? pabyEWKB[4] : pabyEWKB[1];
+    return (nTypeMSB & (H2GIS_EWKB_SRID_FLAG >> 24)) != 0;
+}
+
+// Size of the WKB produced from an EWKB blob (SRID stripped when present)
+inline int32_t H2GISEWKBSizeAsWKB(const uint8_t *pabyEWKB, int32_t nLen)
+{
+    return H2GISEWKBHasSRID(pabyEWKB, nLen) ? nLen - 4 : nLen;
+}
+
+// Copy an EWKB blob as ISO/OGC WKB, dropping the SRID and its type flag
+inline void H2GISCopyEWKBAsWKB(const uint8_t *pabyEWKB, int32_t nLen,
+                               int32_t nOutLen, uint8_t *pabyOut)
+{
+    if (nOutLen == nLen)
+    {
+        memcpy(pabyOut, pabyEWKB, nLen);
+        return;
+    }
+    pabyOut[0] = pabyEWKB[0];
+    memcpy(pabyOut + 1, pabyEWKB + 1, 4);
+    pabyOut[pabyEWKB[0] == 1 ? 4 : 1] &= ~(H2GIS_EWKB_SRID_FLAG >> 24);
+    memcpy(pabyOut + 5, pabyEWKB + 9, nLen - 9);
+}
+
+// Turn an EWKB blob into WKB without copying the geometry data: the byte
+// order and the type (flag cleared) are rewritten over the SRID, so the WKB
+// starts 4 bytes further. The blob is modified, which is fine for values
+// read once from a fetched buffer.
+inline const uint8_t *H2GISEWKBToWKBInPlace(uint8_t *pabyEWKB, int32_t nLen,
+                                            int32_t *pnWKBLen)
+{
+    if (!H2GISEWKBHasSRID(pabyEWKB, nLen))
+    {
+        *pnWKBLen = nLen;
+        return pabyEWKB;
+    }
+    memcpy(pabyEWKB + 5, pabyEWKB + 1, 4);
+    pabyEWKB[4] = pabyEWKB[0];
+    pabyEWKB[pabyEWKB[4] == 1 ? 8 : 5] &= ~(H2GIS_EWKB_SRID_FLAG >> 24);
+    *pnWKBLen = nLen - 4;
+    return pabyEWKB + 4;
+}
+
+// Export a geometry as little-endian EWKB carrying nSRID, or as plain WKB
+// when nSRID <= 0, ready to be bound to a GEOMETRY parameter
+inline bool H2GISExportToEWKB(const OGRGeometry *poGeom, int nSRID,
+                              std::vector<uint8_t> &abyEWKB)
+{
+    const size_t nSRIDSize = nSRID > 0 ? 4 : 0;
+    abyEWKB.resize(poGeom->WkbSize() + nSRIDSize);
+    if (poGeom->exportToWkb(wkbNDR, abyEWKB.data() + nSRIDSize) !=
+        OGRERR_NONE)
+        return false;
+    if (nSRIDSize)
+    {
+        // Move the byte order and type in front of the SRID
+        memmove(abyEWKB.data(), abyEWKB.data() + 4, 5);
+        abyEWKB[4] |= H2GIS_EWKB_SRID_FLAG >> 24;
+        for (int i = 0; i < 4; i++)
+            abyEWKB[5 + i] = static_cast<uint8_t>(nSRID >> (8 * i));
+    }
+    return true;
+}
+
+// Export an envelope as the EWKB of its rectangle (see H2GISExportToEWKB)
+inline void H2GISExportEnvelopeToEWKB(const OGREnvelope &oEnv, int nSRID,
+                                      std::vector<uint8_t> &abyEWKB)
+{
+    const double adfCoords[10] = {oEnv.MinX, oEnv.MinY, oEnv.MaxX, oEnv.MinY,
+                                  oEnv.MaxX, oEnv.MaxY, oEnv.MinX, oEnv.MaxY,
+                                  oEnv.MinX, oEnv.MinY};
+    const uint32_t nType =
+        wkbPolygon | (nSRID > 0 ? H2GIS_EWKB_SRID_FLAG : 0U);
+    const uint32_t anCounts[2] = {1, 5};  // Rings, points of the ring
+
+    abyEWKB.clear();
+    abyEWKB.push_back(1);  // wkbNDR
+    auto Append = [&abyEWKB](const void *pData, size_t nSize)
+    {
+        const uint8_t *pabyData = static_cast<const uint8_t *>(pData);
+        abyEWKB.insert(abyEWKB.end(), pabyData, pabyData + nSize);
+    };
+    Append(&nType, 4);
+    if (nSRID > 0)
+    {
+        const uint32_t nSRIDValue = static_cast<uint32_t>(nSRID);
+        Append(&nSRIDValue, 4);
+    }
+    Append(anCounts, sizeof(anCounts));
+    Append(adfCoords, sizeof(adfCoords));
+}
+
+// Build an OGRGeometry from an EWKB value of a fetched buffer (see above)
+inline OGRGeometry *H2GISGeometryFromEWKB(uint8_t *pabyEWKB, int32_t nLen)
+{
+    int32_t nWKBLen = 0;
+    const uint8_t *pabyWKB = H2GISEWKBToWKBInPlace(pabyEWKB, nLen, &nWKBLen);
+    OGRGeometry *poGeom = nullptr;
+    OGRGeometryFactory::createFromWkb(pabyWKB, nullptr, &poGeom, nWKBLen);
+    return poGeom;
+}
+
+// Target of a column of a fetched batch: an OGR field index (>= 0), the
+// FID, geometry field i (H2GIS_COL_GEOM - i) or nothing
+constexpr int H2GIS_COL_FID = -1;
+constexpr int H2GIS_COL_SKIP = -2;
+constexpr int H2GIS_COL_GEOM = -3;
+
+// Decoder of one batch column, chosen from its H2GIS type and its target
+enum H2GISDecodeOp
+{
+    H2GIS_DECODE_NONE,         // Unknown layout: cursor left in place
+    H2GIS_DECODE_SKIP_1,       // Value not wanted, by width
+    H2GIS_DECODE_SKIP_4,
+    H2GIS_DECODE_SKIP_8,
+    H2GIS_DECODE_SKIP_VARLEN,  // [len 4][bytes] value not wanted
+    H2GIS_DECODE_FID_INT,
+    H2GIS_DECODE_FID_LONG,
+    H2GIS_DECODE_GEOM,
+    H2GIS_DECODE_STRING,
+    H2GIS_DECODE_INT,
+    H2GIS_DECODE_LONG,
+    H2GIS_DECODE_FLOAT,
+    H2GIS_DECODE_DOUBLE,
+    H2GIS_DECODE_BOOL,
+    // Target field of the same type: the value is stored in the field as
+    // is, without SetField() conversions nor temporary copies
+    H2GIS_DECODE_STRING_RAW,
+    H2GIS_DECODE_INT_RAW,
+    H2GIS_DECODE_LONG_RAW,
+    H2GIS_DECODE_DOUBLE_RAW
+};
+
+// One entry per batch column, resolved once per query so that decoding a
+// row is a switch over the plan, without name lookups
+struct H2GISDecodeStep
+{
+    H2GISDecodeOp eOp = H2GIS_DECODE_NONE;
+    int iTarget = 0;  // OGR field index, or geometry field index for GEOM
+    const OGRSpatialReference *poSRS = nullptr;  // Assigned to geometries
+};
+
+int H2GISParseBatchBuffer(void *pBuffer, std::vector<uint8_t *> &apCursors,
+                          std::vector<int> &anTypes);
+void H2GISBuildDecodePlan(const OGRFeatureDefn *poDefn,
+                          const std::vector<int> &anTypes,
+                          const std::vector<int> &anTargets,
+                          std::vector<H2GISDecodeStep> &aoPlan);
+OGRFeature *H2GISDecodeRow(OGRFeatureDefn *poDefn,
+                           const std::vector<H2GISDecodeStep> &aoPlan,
+                           std::vector<uint8_t *> &apCursors,
+                           OGRFeature *poReuse = nullptr);
+bool H2GISFetchFirstInt64(graal_isolatethread_t *thread, long long conn,
+                          const std::string &osSQL,
+                          const std::vector<std::string> &aosParams,
+                          GIntBig *pnValue);
+std::string H2GISBuildInsertSQL(const std::string &osTableName,
+                                const std::string &osColumns, size_t nParams,
+                                int nRows);
+
+// Rows fetched per h2gis_fetch_batch() call unless BATCH_SIZE says otherwise
+constexpr int H2GIS_BATCH_SIZE = 1000;
+
+// BATCH_SIZE=AUTO: byte budget aimed at by each batch, and row bounds
+constexpr long long H2GIS_BATCH_TARGET_BYTES = 8 * 1024 * 1024;
+constexpr int H2GIS_BATCH_MIN_ROWS = 100;
+constexpr int H2GIS_BATCH_MAX_ROWS = 100000;
+
+// GetFeature(FID): prepared lookups kept per layer, and FID bursts
+// (ascending lookups at most H2GIS_FID_BURST_MAX_GAP apart) fetched as
+// FID ranges of H2GIS_FID_BURST_MIN_ROWS rows, doubling up to a batch
+constexpr size_t H2GIS_STMT_CACHE_SIZE = 8;
+constexpr int H2GIS_FID_BURST_MIN_ROWS = 32;
+constexpr GIntBig H2GIS_FID_BURST_MAX_GAP = 16;
+
+// SIMPLIFY_TOLERANCE=AUTO: tolerance used under a spatial filter, as a
+// fraction of the larger side of its envelope (about half a pixel of a
+// 2048 pixel wide view)
+constexpr double H2GIS_SIMPLIFY_AUTO_CELLS = 4096.0;
+
+// TILE_CACHE open option: grid of the tiles spatially filtered scans are
+// served from (see OGRH2GISLayer::PrepareTileScan). Tiles are squares of
+// 2^nLevel layer units, the largest power of two not above the larger side
+// of the filter envelope, so that a filter covers at most 3 x 3 tiles.
+struct H2GISTile
+{
+    int nLevel = 0;
+    GIntBig nX = 0;  // Tile covers [nX, nX + 1] x [nY, nY + 1] tile sizes
+    GIntBig nY = 0;
+    std::vector<std::shared_ptr<OGRFeature>> apoFeatures;
+    size_t nBytes = 0;  // Estimated from the rows transferred
+
+    void GetEnvelope(OGREnvelope &oEnv) const
+    {
+        const double dfSize = std::ldexp(1.0, nLevel);
+        oEnv.MinX = static_cast<double>(nX) * dfSize;
+        oEnv.MinY = static_cast<double>(nY) * dfSize;
+        oEnv.MaxX = static_cast<double>(nX + 1) * dfSize;
+        oEnv.MaxY = static_cast<double>(nY + 1) * dfSize;
+    }
+};
+
+// GetFeatureCount(): filtered counts remembered per layer (LRU)
+constexpr size_t H2GIS_COUNT_CACHE_SIZE = 16;
+
+// Buffered inserts (tables with a FID column): rows of one multi-row
+// INSERT, byte budget of a buffer, and rows per implicit transaction
+constexpr int H2GIS_INSERT_BUFFER_ROWS = 500;
+constexpr size_t H2GIS_INSERT_BUFFER_BYTES = 4 * 1024 * 1024;
+constexpr GIntBig H2GIS_IMPLICIT_TXN_ROWS = 100000;
+
+// Buffered deletes: FIDs removed by one DELETE ... WHERE fid IN (...)
+constexpr size_t H2GIS_DELETE_BUFFER_ROWS = 1000;
+
+// PARALLEL_SCAN=N: most partitions of a scan, and fewest _ROWID_ values
+// spanned by each of them (smaller tables are scanned with one query)
+constexpr int H2GIS_PARALLEL_SCAN_MAX = 64;
+constexpr GIntBig H2GIS_PARALLEL_SCAN_MIN_ROWS = 10000;
+
+// METADATA_CACHE: file saved next to the database, and its format version
+constexpr const char *H2GIS_METADATA_CACHE_SUFFIX = ".h2gis_cache.json";
+constexpr int H2GIS_METADATA_CACHE_VERSION = 1;
+
+// Side table holding the layer extents kept across sessions (see
+// OGRH2GISLayer::GetExtent()), hidden from the layer list
+constexpr const char *H2GIS_EXTENT_TABLE = "GDAL_H2GIS_EXTENTS";
+
+// Metadata domain of the performance counters of layers and datasources
+constexpr const char *H2GIS_STATS_DOMAIN = "H2GIS_STATS";
+
+// Driver-side counters of a layer, or of all the layers and SQL results of
+// a datasource, reported by GetMetadata(H2GIS_STATS_DOMAIN)
+struct H2GISStats
+{
+    GIntBig nQueries = 0;      // Read queries executed
+    GIntBig nBatches = 0;      // Batches fetched
+    GIntBig nRows = 0;         // Rows of these batches
+    GIntBig nBytes = 0;        // Bytes of these batches
+    GIntBig nFetchWaitUs = 0;  // Time spent waiting for them
+
+    void AddBatch(int nBatchRows, long long nBatchBytes, GIntBig nWaitUs)
+    {
+        nBatches++;
+        nRows += std::max(0, nBatchRows);
+        nBytes += std::max(0LL, nBatchBytes);
+        nFetchWaitUs += nWaitUs;
+    }
+
+    // Set QUERIES, BATCHES, ROWS, BYTES and FETCH_WAIT_MS in aosList
+    void Report(CPLStringList &aosList) const;
+};
+
+// Microseconds elapsed since oStart
+inline GIntBig H2GISElapsedUs(std::chrono::steady_clock::time_point oStart)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - oStart)
+        .count();
+}
+
+// One _ROWID_ range of a parallel scan, queried on its own connection with
+// its next batch always in flight
+struct H2GISScanPartition
+{
+    long long hStmt;
+    long long hRS;
+    h2gis_async_fetch_t *hFetch;  // Pending batch, nullptr once exhausted
+    int nRequestedRows;           // Rows asked for by hFetch
+};
+
+// Number of rows to request from the next h2gis_fetch_batch() call.
+// A fixed BATCH_SIZE is returned unchanged; in AUTO mode (nFixedRows == 0)
+// the size is rescaled after each batch from its actual byte size, so that
+// narrow tables get large batches and multi-MB geometries small ones.
+class OGRH2GISBatchSizer
+{
+    int m_nFixedRows;  // BATCH_SIZE=N, 0 for AUTO
+    int m_nRows;       // Rows to request next
+
+  public:
+    explicit OGRH2GISBatchSizer(int nFixedRows)
+        : m_nFixedRows(nFixedRows),
+          m_nRows(nFixedRows > 0 ? nFixedRows : H2GIS_BATCH_SIZE)
+    {
+    }
+
+    int GetRows() const
+    {
+        return m_nRows;
+    }
+
+    void Update(int nRows, long long nBytes)
+    {
+        if (m_nFixedRows > 0 || nRows <= 0 || nBytes <= 0)
+            return;
+        const long long nBytesPerRow = std::max(1LL, nBytes / nRows);
+        long long nNext = H2GIS_BATCH_TARGET_BYTES / nBytesPerRow;
+        // Grow progressively: the first rows are not always representative
+        nNext = std::min(nNext, 4LL * m_nRows);
+        m_nRows = static_cast<int>(
+            std::max<long long>(H2GIS_BATCH_MIN_ROWS,
+                                std::min<long long>(nNext,
+                                                    H2GIS_BATCH_MAX_ROWS)));
+    }
+};
+
 class OGRH2GISDataSource;
 
+// Table layer described by OGRH2GISDataSource::Open(), from which the layer
+// is created on first access
+struct H2GISLayerInfo
+{
+    std::string osTableName;
+    std::string osLayerName;  // TABLE or TABLE.GEOM_COL
+    std::string osGeomCol;    // Empty for non-spatial tables
+    std::string osFIDCol;     // Empty => use _ROWID_
+    int nSRID = 0;
+    OGRwkbGeometryType eGeomType = wkbNone;
+    GIntBig nRowCountEstimate = 0;
+    std::vector<H2GISColumnInfo> aoColumns;
+};
+
+// A database file and the credentials it was opened with, shared by the
+// datasets of the process opening it (see OGRH2GISDataSource::Open()): the
+// connections of the closed ones, handed to the next, and the layer list
+// last read. Dropped, and its connections closed, with the last dataset.
+struct H2GISSharedDatabase
+{
+    int nRefs = 0;  // Open datasets
+    std::vector<long long> ahIdleConnections;
+    // m_aoLayerInfos and m_bHasExtentTable of the datasets, valid unless a
+    // dataset changed the schema since (each change bumps nGeneration)
+    std::vector<H2GISLayerInfo> aoLayerInfos;
+    bool bHasExtentTable = false;
+    bool bLayerInfosValid = false;
+    GIntBig nGeneration = 0;
+};
+
 class OGRH2GISLayer final : public OGRLayer
 {
     OGRH2GISDataSource *m_poDS;
@@ -202,7 +555,11 @@ class OGRH2GISLayer final : public OGRLayer
 
     // Iterator state
     long long m_nRS;    // ResultSet Handle
-    long long m_hStmt;  // Prepared Statement Handle
+    long long m_hStmt;  // Prepared Statement Handle, kept for m_osScanSQL
+    std::string m_osScanSQL;
+    // Spatial filter bound to the parameters of the queries (see
+    // BuildSpatialFilterClause), empty without spatial filter
+    std::vector<uint8_t> m_abyFilterEWKB;
 
     // Batch Buffer State
     void *m_pBatchBuffer;
@@ -212,22 +569,140 @@ class OGRH2GISLayer final : public OGRLayer
     std::vector<uint8_t *>
         m_columnValues;              // Cursors to current row's data in buffer
     std::vector<int> m_columnTypes;  // Types of the columns in the buffer
-    std::vector<std::string> m_columnNames;  // Column names in batch
 
     GIntBig m_iNextShapeId;
     GIntBig
         m_nFeatureCount;  // Cached feature count (pre-filled from INFORMATION_SCHEMA)
+    bool m_bFeatureCountExact;  // m_nFeatureCount counted, not estimated
+    // Filtered counts keyed by spatial filter envelope and attribute filter,
+    // most recently used last, dropped by every write
+    std::vector<std::pair<std::string, GIntBig>> m_aoFilteredCounts;
     bool m_bSchemaFetched;  // True if schema was pre-filled in constructor
     bool m_bResetPending;   // Lazy reset - don't prepare query until first read
-    std::unordered_set<std::string> m_ignoredFields;
+    // Target of each column of the generated SELECT list: OGR field index,
+    // or H2GIS_COL_FID / H2GIS_COL_GEOM
+    std::vector<int> m_anColumnFieldIndex;
+    // Decoders of the current query, built from its first batch
+    std::vector<H2GISDecodeStep> m_aoDecodePlan;
     std::string
         m_osAttributeFilter;  // Attribute filter WHERE clause for push-down
 
+    // Batch N+1 being fetched on the worker while batch N is decoded
+    // (PREFETCH=YES open option), nullptr when nothing is in flight
+    h2gis_async_fetch_t *m_hPrefetch;
+    OGRH2GISBatchSizer m_oBatchSizer;  // BATCH_SIZE open option
+    int m_nRequestedRows;  // Rows asked for by the last (pending) fetch
+
+    // Counters reported by GetMetadata(H2GIS_STATS_DOMAIN)
+    H2GISStats m_oStats;
+    CPLStringList m_aosStatsMetadata;
+
+    // Keyset pagination (see PrepareQuery): feature index of the first row
+    // of each batch fetched in FID order -> FID of that row
+    std::map<GIntBig, GIntBig> m_oKeysetIndex;
+    bool m_bKeysetScan;         // Order scans by FID (set by SetNextByIndex)
+    bool m_bQueryOrderedByFID;  // Current query has ORDER BY FID
+    int m_nFIDUnique;           // See IsFIDUnique(), -1 until checked
+
+    // PARALLEL_SCAN open option (see StartParallelScan): the partitions not
+    // exhausted yet, and the one the next batch is taken from
+    std::vector<H2GISScanPartition> m_aoScanPartitions;
+    size_t m_iScanPartition;
+
+    // GetFeature(FID): prepared statements keyed by SQL text, and features
+    // decoded ahead by the last FID range fetch, owned until handed out
+    std::map<std::string, long long> m_oStmtCache;
+    std::map<GIntBig, OGRFeature *> m_oFIDBurstCache;
+    GIntBig m_nLastGetFeatureFID;  // Last FID asked to GetFeature()
+    int m_nFIDBurstRows;           // FID range of the next burst fetch
+
+    // TILE_CACHE open option (see PrepareTileScan): tiles read by spatially
+    // filtered scans, most recently used last, and the select list and
+    // attribute filter they were read with. A scan served from them walks
+    // m_apoTileScan instead of a result set.
+    std::vector<H2GISTile> m_aoTileCache;
+    size_t m_nTileCacheBytes;
+    std::string m_osTileCacheKey;
+    std::vector<std::shared_ptr<OGRFeature>> m_apoTileScan;
+    size_t m_iTileScan;
+    bool m_bTileScan;
+
+    // Write buffer (see QueueInsert): copies of the features queued since
+    // the last flush, without geometry, and their EWKB (empty when null)
+    std::vector<OGRFeature *> m_apoPendingInserts;
+    std::vector<std::vector<uint8_t>> m_aabyPendingEWKB;
+    std::vector<int> m_anPendingFields;  // Fields bound for each queued row
+    std::string m_osPendingColumns;      // INSERT column list of the queue
+    size_t m_nPendingBytes;
+    // FIDs deleted since the last flush, never queued along with inserts
+    std::vector<GIntBig> m_anPendingDeletes;
+    GIntBig m_nNextFID;     // Next FID given by QueueInsert, 0 if unknown
+    bool m_bFIDIdentity;    // FID column is an identity column
+    bool m_bPendingKeys;    // Queued FIDs are left to the identity
+    bool m_bDeferredSpatialIndex;  // SPATIAL_INDEX=DEFERRED, not built yet
+    // CREATE TABLE of a layer made by ICreateLayer(), without its closing
+    // parenthesis: CreateField() appends the columns until the table is
+    // created by CreateDeferredTable(). Empty once the table exists.
+    std::string m_osDeferredTableSQL;
+    bool m_bDeferredTableIndex;  // CREATE SPATIAL INDEX after the table
+
+    // Extent of the geometry column (see GetExtent): widened by writes,
+    // dropped by deletes, and saved in H2GIS_EXTENT_TABLE on flush or close
+    OGREnvelope m_oCachedExtent;
+    bool m_bExtentValid;   // Covers every row of the table
+    bool m_bExtentDirty;   // Not saved in H2GIS_EXTENT_TABLE yet
+    bool m_bExtentStored;  // H2GIS_EXTENT_TABLE may hold a row for the layer
+
+    // Arrow C stream export (GDAL >= 3.6)
+    bool m_bArrowFastPath;     // Build Arrow arrays straight from batches
+    bool m_bArrowIncludeFID;   // INCLUDE_FID stream option
+    int m_nArrowMaxBatchRows;  // MAX_FEATURES_IN_BATCH stream option
+
     void ClearStatement();
+    void CloseScanStatement();
+    std::string BuildSpatialFilterClause();
+    void BindSpatialFilter(long long hStmt);
     void PrepareQuery();
+    bool IsFIDUnique();
+    void CountQuery();
+    void CountBatch(int nRows, long long nBytes, GIntBig nWaitUs);
     bool FetchNextBatch();
+    bool StartParallelScan(const std::string &osSQL, bool bHasWhere);
+    bool FetchNextPartitionBatch();
+    void ClosePartition(H2GISScanPartition &oPartition);
     void FetchSchema();
     void EnsureSchema();
+    std::string BuildSelectColumns(std::vector<int> *panColumnFieldIndex,
+                                   double dfSimplifyTolerance = 0);
+    double GetSimplifyTolerance() const;
+    long long GetCachedStatement(const std::string &osSQL);
+    void ClearStatementCache();
+    void ClearFIDBurstCache();
+    bool PrepareTileScan();
+    bool FillTiles(std::vector<H2GISTile> &aoTiles,
+                   const OGREnvelope &oEnv, const std::string &osColumns,
+                   const std::vector<int> &anColumnFieldIndex);
+    H2GISTile *TouchTile(int nLevel, GIntBig nX, GIntBig nY);
+    void ClearTileCache();
+    void ExportFeatureGeometry(OGRFeature *poFeature,
+                               std::vector<uint8_t> &abyEWKB);
+    bool AllocateFIDs();
+    bool FetchIdentityBase(GIntBig *pnBase);
+    OGRErr QueueInsert(OGRFeature *poFeature);
+    bool ExecutePendingInserts(long long hStmt, int iFirst, int nRows,
+                               int *pnMovedFIDs);
+    void DiscardPendingInserts();
+    OGRErr FlushPendingDeletes();
+    void AdjustFeatureCount(GIntBig nDelta);
+    void ExtendCachedExtent(const OGRGeometry *poGeom);
+    void InvalidateCachedExtent();
+    bool IsArrowFastPathSupported(CSLConstList papszOptions) const;
+
+#if GDAL_VERSION_NUM >= 3060000
+  protected:
+    virtual int GetNextArrowArray(struct ArrowArrayStream *,
+                                  struct ArrowArray *out_array) override;
+#endif
 
   public:
     // New constructor with pre-fetched metadata from INFORMATION_SCHEMA
@@ -270,6 +745,58 @@ class OGRH2GISLayer final : public OGRLayer
         return m_osTableName.c_str();
     }
 
+    // Drop features and statements cached by GetFeature(), after the
+    // table was modified behind the layer (SQL, rollback)
+    void InvalidateCachedData();
+
+    // SPATIAL_INDEX=DEFERRED: create the index in one pass over the loaded
+    // table, at the first read, SyncToDisk() or close
+    void DeferSpatialIndex()
+    {
+        m_bDeferredSpatialIndex = true;
+    }
+    void BuildDeferredSpatialIndex();
+
+    // ICreateLayer(): postpone the CREATE TABLE of osSQL (column list left
+    // open) to the first write, read or sync, so that the fields created
+    // meanwhile are part of it
+    void DeferTableCreation(const std::string &osSQL, bool bSpatialIndex)
+    {
+        m_osDeferredTableSQL = osSQL;
+        m_bDeferredTableIndex = bSpatialIndex;
+    }
+    // DeleteLayer(): the table no longer needs to be created
+    void DiscardDeferredTable()
+    {
+        m_osDeferredTableSQL.clear();
+    }
+    OGRErr CreateDeferredTable();
+
+    GIntBig GetFeatureCountEstimate() const
+    {
+        return m_nFeatureCount;
+    }
+
+    // The table was just created: the feature count (0) is exact
+    void SetFeatureCountExact()
+    {
+        m_bFeatureCountExact = true;
+    }
+
+    // Extent cache: set from H2GIS_EXTENT_TABLE when the dataset is opened,
+    // or to empty for a new layer, and saved back by SaveCachedExtent()
+    void SetCachedExtent(const OGREnvelope &oExtent, bool bStored);
+    void SaveCachedExtent();
+
+    // Write buffer: run the queued deletes or inserts, and transaction
+    // hooks called by the datasource
+    OGRErr FlushPendingInserts();
+    void OnTransactionCommitted();
+    void OnTransactionRolledBack();
+
+    virtual char **GetMetadataDomainList() override;
+    virtual char **GetMetadata(const char *pszDomain = "") override;
+
 #if GDAL_VERSION_NUM >= 3120000
     virtual int TestCapability(const char *) const override;
 #else
@@ -326,9 +853,18 @@ class OGRH2GISLayer final : public OGRLayer
 
     virtual OGRErr SetNextByIndex(GIntBig nIndex) override;
 
+#if GDAL_VERSION_NUM >= 3060000
+    virtual bool GetArrowStream(struct ArrowArrayStream *out_stream,
+                                CSLConstList papszOptions = nullptr) override;
+#endif
+
     virtual OGRErr ICreateFeature(OGRFeature *poFeature) override;
     virtual OGRErr ISetFeature(OGRFeature *poFeature) override;
     virtual OGRErr DeleteFeature(GIntBig nFID) override;
+#if GDAL_VERSION_NUM >= 3060000
+    virtual OGRErr IUpsertFeature(OGRFeature *poFeature) override;
+#endif
+    virtual OGRErr SyncToDisk() override;
 
 #if GDAL_VERSION_NUM >= 3090000
     virtual OGRErr CreateField(const OGRFieldDefn *poField,
@@ -347,13 +883,77 @@ class OGRH2GISDataSource final : public GDALDataset
 
     long long m_hConnection;  // H2GIS Connection ID (long long in C API)
     void *m_hThread;          // GraalVM Isolate Thread
+    bool m_bPrefetch;         // PREFETCH open option
+    int m_nBatchSize;         // BATCH_SIZE open option, 0 for AUTO
+    int m_nParallelScan;      // PARALLEL_SCAN open option
+    // SIMPLIFY_TOLERANCE open option: fixed tolerance, 0 if none, or
+    // derived from the spatial filter (AUTO)
+    double m_dfSimplifyTolerance;
+    bool m_bSimplifyAuto;
+    size_t m_nTileCacheBytes;  // TILE_CACHE open option, 0 if disabled
+    bool m_bSpatialFilterBBox;  // SPATIAL_FILTER=BBOX open option
+    bool m_bUpdate;           // Opened in update mode
+    bool m_bHasExtentTable;   // H2GIS_EXTENT_TABLE exists
+
+    // Layers are created on first access (see GetOrCreateLayer()):
+    // m_papoLayers[i] stays nullptr until then
+    std::vector<H2GISLayerInfo> m_aoLayerInfos;
+    // Rows of H2GIS_EXTENT_TABLE not handed to a layer yet, read with the
+    // first layer created
+    std::map<std::pair<std::string, std::string>, OGREnvelope>
+        m_oStoredExtents;
+    bool m_bStoredExtentsLoaded;
+
+    // METADATA_CACHE open option: m_aoLayerInfos saved on close, keyed by
+    // the modification time and size of the database file
+    bool m_bMetadataCache;
+    bool m_bMetadataChanged;  // Tables created, dropped or altered
+    GIntBig m_nDBFileMTime;   // State of the file before connecting,
+    GIntBig m_nDBFileSize;    // -1 if unknown
+
+    // Read-only connections of parallel scans, opened on first use with
+    // the path and credentials that opened m_hConnection
+    std::vector<long long> m_ahScanConnections;
+    std::string m_osConnectPath;
+    std::string m_osConnectUser;
+    std::string m_osConnectPassword;
+
+    // Key of the H2GISSharedDatabase of the file, empty until connected,
+    // and its generation when m_aoLayerInfos was read
+    std::string m_osSharedKey;
+    GIntBig m_nSharedGeneration;
+
+    // Inserts outside StartTransaction() are grouped in implicit
+    // transactions, committed by SyncToDisk(), DDL, SQL and Close
+    bool m_bInTransaction;                // StartTransaction() active
+    bool m_bImplicitTransaction;          // BEGIN issued by the driver
+    GIntBig m_nImplicitTransactionRows;   // Inserts in the implicit one
+
+    // Counters of all layers and SQL results, reported with those of the
+    // wrapper by GetMetadata(H2GIS_STATS_DOMAIN) and logged on close
+    H2GISStats m_oStats;
+    CPLStringList m_aosStatsMetadata;
+
+    void ReportStats(CPLStringList &aosList) const;
+
+    void LoadStoredExtents();
+    void QueryLayerInfos();
+    std::string GetMetadataCachePath() const;
+    bool LoadMetadataCache();
+    void SaveMetadataCache();
+    bool AttachSharedDatabase(const std::string &osKey);
+    void PublishSharedLayerInfos();
+    void InvalidateSharedLayerInfos();
+    bool ReleaseSharedDatabase(bool *pbSchemaChanged);
+    OGRH2GISLayer *GetOrCreateLayer(int i);
 
   public:
     OGRH2GISDataSource();
     virtual ~OGRH2GISDataSource();
 
     int Open(const char *pszFilename, int bUpdate,
-             const char *pszUser = nullptr, const char *pszPassword = nullptr);
+             const char *pszUser = nullptr, const char *pszPassword = nullptr,
+             CSLConstList papszOpenOptions = nullptr);
 
 #if GDAL_VERSION_NUM >= 3120000
     virtual int GetLayerCount() const override
@@ -412,6 +1012,14 @@ class OGRH2GISDataSource final : public GDALDataset
     virtual int TestCapability(const char *) override;
 #endif
 
+    virtual char **GetMetadataDomainList() override;
+    virtual char **GetMetadata(const char *pszDomain = "") override;
+
+    H2GISStats &GetStats()
+    {
+        return m_oStats;
+    }
+
     long long GetConnection()
     {
         return m_hConnection;
@@ -421,6 +1029,67 @@ class OGRH2GISDataSource final : public GDALDataset
     {
         return m_hThread;
     }
+
+    bool IsPrefetchEnabled() const
+    {
+        return m_bPrefetch;
+    }
+
+    int GetBatchSize() const
+    {
+        return m_nBatchSize;
+    }
+
+    int GetParallelScan();
+
+    double GetSimplifyTolerance() const
+    {
+        return m_dfSimplifyTolerance;
+    }
+
+    bool IsSimplifyAuto() const
+    {
+        return m_bSimplifyAuto;
+    }
+
+    size_t GetTileCacheBytes() const
+    {
+        return m_nTileCacheBytes;
+    }
+
+    bool IsSpatialFilterBBox() const
+    {
+        return m_bSpatialFilterBBox;
+    }
+
+    long long GetScanConnection(int iPartition);
+
+    // Rows of H2GIS_EXTENT_TABLE, keyed by table and geometry column
+    bool HasExtentTable() const
+    {
+        return m_bHasExtentTable;
+    }
+    bool StoreExtent(const std::string &osTable, const std::string &osGeomCol,
+                     const OGREnvelope &oExtent);
+    void DeleteStoredExtent(const std::string &osTable,
+                            const std::string &osGeomCol);
+
+    // The schema changed: do not save the METADATA_CACHE file on close, nor
+    // hand the layer list to the next dataset opening the file
+    void InvalidateMetadataCache()
+    {
+        m_bMetadataChanged = true;
+        InvalidateSharedLayerInfos();
+    }
+
+    bool IsInTransaction() const
+    {
+        return m_bInTransaction;
+    }
+
+    OGRErr FlushPendingInserts();
+    void BeginImplicitTransaction();
+    OGRErr CommitImplicitTransaction();
 };
 
 #endif  // OGR_H2GIS_H_INCLUDED
@@ -7,8 +7,12 @@
 #include <string>
 #include <set>
 #include <map>
+#include <mutex>
 
 #include "cpl_error.h"
+#include "cpl_json.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
 
 // Types and functions come from ogr_h2gis.h which includes h2gis_wrapper.h
 
@@ -19,22 +23,267 @@ static void LogDebugDS(const char *msg)
 
 OGRH2GISDataSource::OGRH2GISDataSource()
     : m_pszName(nullptr), m_papoLayers(nullptr), m_nLayers(0),
-      m_hConnection(-1), m_hThread(nullptr)
+      m_hConnection(-1), m_hThread(nullptr), m_bPrefetch(false),
+      m_nBatchSize(H2GIS_BATCH_SIZE), m_nParallelScan(1),
+      m_dfSimplifyTolerance(0), m_bSimplifyAuto(false), m_nTileCacheBytes(0),
+      m_bSpatialFilterBBox(false), m_bUpdate(false),
+      m_bHasExtentTable(false), m_bStoredExtentsLoaded(false),
+      m_bMetadataCache(false), m_bMetadataChanged(false), m_nDBFileMTime(-1),
+      m_nDBFileSize(-1), m_nSharedGeneration(0),
+      m_bInTransaction(false),
+      m_bImplicitTransaction(false), m_nImplicitTransactionRows(0)
 {
 }
 
 OGRH2GISDataSource::~OGRH2GISDataSource()
 {
+    if (m_hThread && m_hConnection >= 0)
+    {
+        FlushPendingInserts();
+        CommitImplicitTransaction();
+        if (!m_bInTransaction)
+        {
+            for (int i = 0; i < m_nLayers; i++)
+            {
+                if (m_papoLayers[i] == nullptr)
+                    continue;
+                m_papoLayers[i]->BuildDeferredSpatialIndex();
+                m_papoLayers[i]->SaveCachedExtent();
+            }
+        }
+    }
     for (int i = 0; i < m_nLayers; i++)
+    {
+        if (m_papoLayers[i])
+            m_aoLayerInfos[i].nRowCountEstimate =
+                m_papoLayers[i]->GetFeatureCountEstimate();
         delete m_papoLayers[i];
+    }
     CPLFree(m_papoLayers);
     CPLFree(m_pszName);
 
-    if (m_hThread && m_hConnection >= 0)
+    // The connections go to the next dataset opening the file, or are
+    // closed with the last one, which leaves the file in its final state.
+    // A layer list older than a schema change made through another dataset
+    // must not be saved, and the cache left by earlier sessions goes too.
+    bool bSchemaChanged = false;
+    if (m_hThread && m_hConnection >= 0 &&
+        ReleaseSharedDatabase(&bSchemaChanged) && m_bMetadataCache)
+    {
+        if (m_bMetadataChanged || bSchemaChanged)
+            VSIUnlink(GetMetadataCachePath().c_str());
+        else
+            SaveMetadataCache();
+    }
+
+    if (m_oStats.nQueries > 0)
+    {
+        CPLStringList aosStats;
+        ReportStats(aosStats);
+        std::string osStats;
+        for (int i = 0; i < aosStats.size(); i++)
+            osStats += std::string(i ? " " : "") + aosStats[i];
+        CPLDebug("H2GIS", "Stats: %s", osStats.c_str());
+    }
+}
+
+/************************************************************************/
+/*                        Shared databases                              */
+/************************************************************************/
+
+// Databases open in the process, by connection path and credentials
+static std::mutex g_oSharedDatabasesMutex;
+static std::map<std::string, H2GISSharedDatabase> g_oSharedDatabases;
+
+static std::string BuildSharedKey(const std::string &osPath,
+                                  const std::string &osUser,
+                                  const std::string &osPassword)
+{
+    std::string osKey;
+    if (CPLIsFilenameRelative(osPath.c_str()))
+    {
+        char *pszCurDir = CPLGetCurrentDir();
+        osKey = CPLFormFilename(pszCurDir, osPath.c_str(), nullptr);
+        CPLFree(pszCurDir);
+    }
+    else
+    {
+        osKey = osPath;
+    }
+    return osKey + '\n' + osUser + '\n' + osPassword;
+}
+
+/**
+ * Connection released by a closed dataset of the database osKey, which
+ * H2GIS is already loaded on.
+ *
+ * @return the connection, or -1 if there is none.
+ */
+static long long TakeIdleConnection(const std::string &osKey)
+{
+    std::lock_guard<std::mutex> oLock(g_oSharedDatabasesMutex);
+    auto oIter = g_oSharedDatabases.find(osKey);
+    if (oIter == g_oSharedDatabases.end() ||
+        oIter->second.ahIdleConnections.empty())
+        return -1;
+    const long long conn = oIter->second.ahIdleConnections.back();
+    oIter->second.ahIdleConnections.pop_back();
+    return conn;
+}
+
+// Whether datasets have the database osKey open, H2GIS loaded
+static bool IsSharedDatabaseOpen(const std::string &osKey)
+{
+    std::lock_guard<std::mutex> oLock(g_oSharedDatabasesMutex);
+    return g_oSharedDatabases.count(osKey) > 0;
+}
+
+/**
+ * Count the dataset, connected, among the users of the database osKey, and
+ * take the layer list other datasets read from it if the schema has not
+ * changed since.
+ *
+ * @return true if m_aoLayerInfos was filled.
+ */
+bool OGRH2GISDataSource::AttachSharedDatabase(const std::string &osKey)
+{
+    std::lock_guard<std::mutex> oLock(g_oSharedDatabasesMutex);
+    H2GISSharedDatabase &oShared = g_oSharedDatabases[osKey];
+    oShared.nRefs++;
+    m_osSharedKey = osKey;
+    m_nSharedGeneration = oShared.nGeneration;
+    if (!oShared.bLayerInfosValid)
+        return false;
+    m_aoLayerInfos = oShared.aoLayerInfos;
+    m_bHasExtentTable = oShared.bHasExtentTable;
+    return true;
+}
+
+// Hand m_aoLayerInfos to the datasets opened next, unless the schema changed
+// since it was read
+void OGRH2GISDataSource::PublishSharedLayerInfos()
+{
+    std::lock_guard<std::mutex> oLock(g_oSharedDatabasesMutex);
+    auto oIter = g_oSharedDatabases.find(m_osSharedKey);
+    if (m_bMetadataChanged || oIter == g_oSharedDatabases.end() ||
+        oIter->second.nGeneration != m_nSharedGeneration)
+        return;
+    oIter->second.aoLayerInfos = m_aoLayerInfos;
+    oIter->second.bHasExtentTable = m_bHasExtentTable;
+    oIter->second.bLayerInfosValid = true;
+}
+
+void OGRH2GISDataSource::InvalidateSharedLayerInfos()
+{
+    std::lock_guard<std::mutex> oLock(g_oSharedDatabasesMutex);
+    auto oIter = g_oSharedDatabases.find(m_osSharedKey);
+    if (oIter == g_oSharedDatabases.end())
+        return;
+    oIter->second.bLayerInfosValid = false;
+    oIter->second.aoLayerInfos.clear();
+    oIter->second.nGeneration++;
+}
+
+/**
+ * Give the connections of the dataset, main and parallel scan ones, to the
+ * other datasets of the database, or close them all if it was the last.
+ * A transaction left open is rolled back first, as closing would.
+ *
+ * @param pbSchemaChanged Output: whether a dataset changed the schema since
+ *        this one read its layer list, set when the database is closed.
+ * @return true if the database was closed.
+ */
+bool OGRH2GISDataSource::ReleaseSharedDatabase(bool *pbSchemaChanged)
+{
+    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
+    if (m_bInTransaction || m_bImplicitTransaction)
+        h2gis_execute(thread, m_hConnection, (char *)"ROLLBACK");
+    PublishSharedLayerInfos();
+
+    std::vector<long long> ahConnections = m_ahScanConnections;
+    ahConnections.insert(ahConnections.begin(), m_hConnection);
+    m_ahScanConnections.clear();
+    m_hConnection = -1;
+    bool bClosed = true;
+    {
+        std::lock_guard<std::mutex> oLock(g_oSharedDatabasesMutex);
+        auto oIter = g_oSharedDatabases.find(m_osSharedKey);
+        if (oIter != g_oSharedDatabases.end())
+        {
+            H2GISSharedDatabase &oShared = oIter->second;
+            if (--oShared.nRefs > 0)
+            {
+                oShared.ahIdleConnections.insert(
+                    oShared.ahIdleConnections.end(), ahConnections.begin(),
+                    ahConnections.end());
+                ahConnections.clear();
+                bClosed = false;
+            }
+            else
+            {
+                ahConnections.insert(ahConnections.end(),
+                                     oShared.ahIdleConnections.begin(),
+                                     oShared.ahIdleConnections.end());
+                *pbSchemaChanged = oShared.nGeneration != m_nSharedGeneration;
+                g_oSharedDatabases.erase(oIter);
+            }
+        }
+    }
+
+    for (long long conn : ahConnections)
+        h2gis_close_connection(thread, conn);
+    return bClosed;
+}
+
+/**
+ * PARALLEL_SCAN open option, or 1 when the worker pool has a single thread
+ * (H2GIS_WORKER_THREADS): every scan connection would be pinned to it, so
+ * the ranges would only be read one after another.
+ */
+int OGRH2GISDataSource::GetParallelScan()
+{
+    if (m_nParallelScan > 1 && h2gis_wrapper_get_worker_count() < 2)
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "H2GIS: PARALLEL_SCAN=%d ignored, as it needs "
+                 "H2GIS_WORKER_THREADS to be set to 2 or more",
+                 m_nParallelScan);
+        m_nParallelScan = 1;
+    }
+    return m_nParallelScan;
+}
+
+/**
+ * Connection partition iPartition of a parallel scan runs on: the main
+ * connection for the first one, and extra connections to the same database
+ * for the others, opened on first use and kept until the dataset is closed.
+ * Each connection is pinned to its own worker thread when the wrapper runs
+ * several (H2GIS_WORKER_THREADS).
+ *
+ * @return the connection, or -1 if it could not be opened.
+ */
+long long OGRH2GISDataSource::GetScanConnection(int iPartition)
+{
+    if (iPartition == 0)
+        return m_hConnection;
+
+    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
+    while (static_cast<int>(m_ahScanConnections.size()) < iPartition)
     {
-        h2gis_close_connection((graal_isolatethread_t *)m_hThread,
-                               m_hConnection);
+        long long conn = TakeIdleConnection(m_osSharedKey);
+        if (conn < 0)
+            conn = h2gis_connect(thread, (char *)m_osConnectPath.c_str(),
+                                 (char *)m_osConnectUser.c_str(),
+                                 (char *)m_osConnectPassword.c_str());
+        if (conn == 0 || conn == -1)
+        {
+            CPLDebug("H2GIS", "Could not open parallel scan connection %d",
+                     iPartition);
+            return -1;
+        }
+        m_ahScanConnections.push_back(conn);
     }
+    return m_ahScanConnections[iPartition - 1];
 }
 
 // Helpers for buffer parsing (Single Row Context)
@@ -109,39 +358,89 @@ static int ParseColumnAsInt(uint8_t *colPtr, int64_t colOffset)
     return 0;
 }
 
+/**
+ * Result set of an ExecuteSQL() query.
+ *
+ * SELECT and WITH statements are wrapped as a derived table whenever a
+ * spatial or attribute filter is set or fields are ignored, so that H2GIS
+ * filters, counts and projects the rows itself:
+ *   SELECT <columns> FROM (<statement>) AS "H2GIS_RESULT" WHERE <filters>
+ * Statements H2 refuses to wrap (CALL, duplicate column names...) are read
+ * as they are, the filters being evaluated on the decoded features.
+ */
 class OGRH2GISResultLayer final : public OGRLayer
 {
     OGRH2GISDataSource *m_poDS;
     OGRFeatureDefn *m_poFeatureDefn;
     std::string m_osSQL;
+    bool m_bCanWrap;  // m_osSQL can be used as a derived table
+    std::string m_osAttributeFilter;  // Pushed down when wrapped
     long long m_nRS;
     long long m_hStmt;
     void *m_pBatchBuffer;
     int m_nBatchRows;
     int m_iNextRowInBatch;
     GIntBig m_iNextFID;
+    bool m_bResetPending;  // Query to run again before the next read
+    bool m_bClientFilter;  // Current query left the filters to us
+    OGRH2GISBatchSizer m_oBatchSizer;
     std::vector<uint8_t *> m_columnValues;
     std::vector<int> m_columnTypes;
-    std::vector<std::string> m_columnNames;
+    // Name and target of each column of the statement (see BuildFeatureDefn)
+    std::vector<std::string> m_aosColumnNames;
+    std::vector<int> m_anSourceTargets;
+    // Targets of the columns of the current query, and their decoders
+    // built from its first batch
+    std::vector<int> m_anColumnTargets;
+    std::vector<H2GISDecodeStep> m_aoDecodePlan;
+    // Counters reported by GetMetadata(H2GIS_STATS_DOMAIN)
+    H2GISStats m_oStats;
+    CPLStringList m_aosStatsMetadata;
 
   public:
-    OGRH2GISResultLayer(OGRH2GISDataSource *poDS, const char *pszSQL)
+    OGRH2GISResultLayer(OGRH2GISDataSource *poDS, const char *pszSQL,
+                        OGRGeometry *poSpatialFilter)
         : m_poDS(poDS), m_poFeatureDefn(new OGRFeatureDefn("Result")),
-          m_osSQL(pszSQL), m_nRS(0), m_hStmt(0), m_pBatchBuffer(nullptr),
-          m_nBatchRows(0), m_iNextRowInBatch(0), m_iNextFID(0)
+          m_osSQL(pszSQL), m_bCanWrap(false), m_nRS(0), m_hStmt(0),
+          m_pBatchBuffer(nullptr), m_nBatchRows(0), m_iNextRowInBatch(0),
+          m_iNextFID(0), m_bResetPending(false), m_bClientFilter(false),
+          m_oBatchSizer(poDS->GetBatchSize())
     {
         SetDescription(m_poFeatureDefn->GetName());
         m_poFeatureDefn->Reference();
 
-        graal_isolatethread_t *thread =
-            (graal_isolatethread_t *)m_poDS->GetThread();
-        long long conn = m_poDS->GetConnection();
-        m_hStmt = h2gis_prepare(thread, conn, (char *)m_osSQL.c_str());
-        if (m_hStmt)
+        // A trailing separator would end the derived table early
+        while (!m_osSQL.empty() &&
+               (m_osSQL.back() == ';' ||
+                isspace(static_cast<unsigned char>(m_osSQL.back()))))
+            m_osSQL.pop_back();
+        m_bCanWrap = STARTS_WITH_CI(m_osSQL.c_str(), "SELECT") ||
+                     STARTS_WITH_CI(m_osSQL.c_str(), "WITH");
+
+        // With a spatial filter, the columns are taken from an empty query
+        // on the derived table, so that the statement only runs filtered.
+        // Otherwise the result set described is also the one read first.
+        if (poSpatialFilter && m_bCanWrap)
         {
-            m_nRS = h2gis_execute_prepared(thread, m_hStmt);
-            if (m_nRS)
-                BuildFeatureDefn();
+            m_bCanWrap = ExecuteQuery("SELECT * FROM (" + m_osSQL +
+                                      ") AS \"H2GIS_RESULT\" LIMIT 0");
+            m_bResetPending = m_bCanWrap;
+        }
+        if (m_nRS || ExecuteQuery(m_osSQL))
+        {
+            BuildFeatureDefn();
+            m_anColumnTargets = m_anSourceTargets;
+        }
+
+        if (poSpatialFilter)
+        {
+            SetSpatialFilter(poSpatialFilter);
+            if (!m_bCanWrap && m_nRS)
+            {
+                // Nothing read yet: the result set at hand will do
+                m_bResetPending = false;
+                m_bClientFilter = m_poFilterGeom != nullptr;
+            }
         }
     }
 
@@ -166,6 +465,28 @@ class OGRH2GISResultLayer final : public OGRLayer
         m_pBatchBuffer = nullptr;
     }
 
+    // Run osSQL as the current query of the layer
+    bool ExecuteQuery(const std::string &osSQL)
+    {
+        ClearStatement();
+        m_nBatchRows = 0;
+        m_iNextRowInBatch = 0;
+        m_iNextFID = 0;
+        m_aoDecodePlan.clear();
+
+        graal_isolatethread_t *thread =
+            (graal_isolatethread_t *)m_poDS->GetThread();
+        long long conn = m_poDS->GetConnection();
+        m_hStmt = h2gis_prepare(thread, conn, (char *)osSQL.c_str());
+        if (m_hStmt)
+            m_nRS = h2gis_execute_prepared(thread, m_hStmt);
+        if (!m_nRS)
+            return false;
+        m_oStats.nQueries++;
+        m_poDS->GetStats().nQueries++;
+        return true;
+    }
+
     void BuildFeatureDefn()
     {
         graal_isolatethread_t *thread =
@@ -179,8 +500,10 @@ class OGRH2GISResultLayer final : public OGRLayer
             memcpy(&colCount, ptr, 4);
             ptr += 4;
 
-            m_columnNames.clear();
-            m_columnNames.reserve(colCount);
+            m_aosColumnNames.clear();
+            m_aosColumnNames.reserve(colCount);
+            m_anSourceTargets.clear();
+            m_anSourceTargets.reserve(colCount);
 
             for (int i = 0; i < colCount; i++)
             {
@@ -192,15 +515,25 @@ class OGRH2GISResultLayer final : public OGRLayer
                 int32_t type;
                 memcpy(&type, ptr, 4);
                 ptr += 4;
-                m_columnNames.push_back(colName);
+                m_aosColumnNames.push_back(colName);
 
-                if (type == H2GIS_TYPE_GEOM)
+                // _ROWID_ gives the FID (see GetNextFeature)
+                if (type == H2GIS_TYPE_LONG &&
+                    EQUAL(colName.c_str(), "_ROWID_"))
+                {
+                    m_anSourceTargets.push_back(H2GIS_COL_FID);
+                }
+                else if (type == H2GIS_TYPE_GEOM)
                 {
+                    m_anSourceTargets.push_back(
+                        H2GIS_COL_GEOM - m_poFeatureDefn->GetGeomFieldCount());
                     OGRGeomFieldDefn gfd(colName.c_str(), wkbUnknown);
                     m_poFeatureDefn->AddGeomFieldDefn(&gfd);
                 }
                 else
                 {
+                    m_anSourceTargets.push_back(
+                        m_poFeatureDefn->GetFieldCount());
                     OGRFieldType ogrType = OFTString;
                     if (type == H2GIS_TYPE_INT || type == H2GIS_TYPE_BOOL)
                         ogrType = OFTInteger;
@@ -230,83 +563,178 @@ class OGRH2GISResultLayer final : public OGRLayer
 
         if (m_pBatchBuffer)
         {
-            h2gis_free_result_buffer(thread, m_pBatchBuffer);
+            h2gis_release_result_buffer(thread, m_pBatchBuffer);
             m_pBatchBuffer = nullptr;
         }
 
         long long sizeOut = 0;
-        m_pBatchBuffer = h2gis_fetch_batch(thread, m_nRS, 1000, &sizeOut);
-
-        if (!m_pBatchBuffer || sizeOut <= 0)
+        const auto oFetchStart = std::chrono::steady_clock::now();
+        m_pBatchBuffer = h2gis_fetch_batch(thread, m_nRS,
+                                           m_oBatchSizer.GetRows(), &sizeOut);
+        const GIntBig nWaitUs = H2GISElapsedUs(oFetchStart);
+
+        m_nBatchRows = m_pBatchBuffer && sizeOut > 0
+                           ? H2GISParseBatchBuffer(m_pBatchBuffer,
+                                                   m_columnValues,
+                                                   m_columnTypes)
+                           : 0;
+        m_oStats.AddBatch(m_nBatchRows, sizeOut, nWaitUs);
+        m_poDS->GetStats().AddBatch(m_nBatchRows, sizeOut, nWaitUs);
+        if (m_nBatchRows <= 0)
             return false;
+        m_oBatchSizer.Update(m_nBatchRows, sizeOut);
+        if (m_aoDecodePlan.empty())
+            H2GISBuildDecodePlan(m_poFeatureDefn, m_columnTypes,
+                                 m_anColumnTargets, m_aoDecodePlan);
 
-        uint8_t *ptr = (uint8_t *)m_pBatchBuffer;
-        int32_t colCount;
-        memcpy(&colCount, ptr, 4);
-        ptr += 4;
-        memcpy(&m_nBatchRows, ptr, 4);
-        ptr += 4;
+        m_iNextRowInBatch = 0;
+        return true;
+    }
 
-        if (m_nBatchRows <= 0)
-            return false;
+    void ResetReading() override
+    {
+        // Run again on the next read, with the filters set by then
+        m_bResetPending = true;
+    }
 
-        std::vector<int64_t> offsets(colCount);
-        for (int i = 0; i < colCount; i++)
+    // Whether the current filters or ignored fields call for a wrapped query
+    bool NeedsWrapping() const
+    {
+        if (m_poFilterGeom != nullptr || !m_osAttributeFilter.empty())
+            return true;
+        for (int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++)
         {
-            memcpy(&offsets[i], ptr, 8);
-            ptr += 8;
+            if (m_poFeatureDefn->GetFieldDefn(i)->IsIgnored())
+                return true;
+        }
+        for (int i = 0; i < m_poFeatureDefn->GetGeomFieldCount(); i++)
+        {
+            if (m_poFeatureDefn->GetGeomFieldDefn(i)->IsIgnored())
+                return true;
         }
+        return false;
+    }
 
-        m_columnValues.resize(colCount);
-        m_columnTypes.resize(colCount);
+    // Columns of the statement not ignored, and their targets
+    std::string BuildSelectColumns(std::vector<int> &anTargets) const
+    {
+        std::string osColumns;
+        anTargets.clear();
+        for (size_t i = 0; i < m_anSourceTargets.size(); i++)
+        {
+            const int iTarget = m_anSourceTargets[i];
+            if (iTarget >= 0 &&
+                m_poFeatureDefn->GetFieldDefn(iTarget)->IsIgnored())
+                continue;
+            if (iTarget <= H2GIS_COL_GEOM &&
+                m_poFeatureDefn->GetGeomFieldDefn(H2GIS_COL_GEOM - iTarget)
+                    ->IsIgnored())
+                continue;
+            if (!osColumns.empty())
+                osColumns += ", ";
+            osColumns += "\"" + m_aosColumnNames[i] + "\"";
+            anTargets.push_back(iTarget);
+        }
+        return osColumns.empty() ? "1" : osColumns;
+    }
 
-        uint8_t *base = (uint8_t *)m_pBatchBuffer;
+    // SELECT osColumns over the statement wrapped with the current filters
+    std::string BuildQuery(const std::string &osColumns) const
+    {
+        std::string osSQL = "SELECT " + osColumns + " FROM (" + m_osSQL +
+                            ") AS \"H2GIS_RESULT\"";
+        std::string osWhere;
 
-        for (int i = 0; i < colCount; i++)
+        if (m_poFilterGeom != nullptr &&
+            m_iGeomFieldFilter < m_poFeatureDefn->GetGeomFieldCount())
         {
-            uint8_t *colPtr = base + offsets[i];
-
-            int32_t nameLen;
-            memcpy(&nameLen, colPtr, 4);
-            colPtr += 4;
-            std::string colName((char *)colPtr, nameLen);
-            colPtr += nameLen;
+            OGREnvelope env;
+            m_poFilterGeom->getEnvelope(&env);
+            const std::string osGeom =
+                std::string("\"") +
+                m_poFeatureDefn->GetGeomFieldDefn(m_iGeomFieldFilter)
+                    ->GetNameRef() +
+                "\"";
+            // Same predicates as table layers, on the filter envelope:
+            // result geometries may have any SRID, which ST_Intersects()
+            // wants on both sides, so it cannot be bound beforehand.
+            const std::string osEnv =
+                CPLSPrintf("%.15g, %.15g, %.15g, %.15g", env.MinX, env.MinY,
+                           env.MaxX, env.MaxY);
+            osWhere = osGeom + " && ST_MakeEnvelope(" + osEnv + ")";
+            if (!m_poDS->IsSpatialFilterBBox())
+                osWhere += " AND ST_Intersects(" + osGeom +
+                           ", ST_MakeEnvelope(" + osEnv + ", ST_SRID(" +
+                           osGeom + ")))";
+        }
+        if (!m_osAttributeFilter.empty())
+        {
+            if (!osWhere.empty())
+                osWhere += " AND ";
+            osWhere += "(" + m_osAttributeFilter + ")";
+        }
 
-            int32_t type;
-            memcpy(&type, colPtr, 4);
-            colPtr += 4;
+        if (!osWhere.empty())
+            osSQL += " WHERE " + osWhere;
+        return osSQL;
+    }
 
-            int32_t totalDataLen;
-            memcpy(&totalDataLen, colPtr, 4);
-            colPtr += 4;
+    void PrepareQuery()
+    {
+        m_bResetPending = false;
 
-            if (m_columnNames.size() != static_cast<size_t>(colCount))
+        if (m_bCanWrap && NeedsWrapping())
+        {
+            std::vector<int> anTargets;
+            const std::string osSQL = BuildQuery(BuildSelectColumns(anTargets));
+            if (ExecuteQuery(osSQL))
             {
-                if (m_columnNames.size() < static_cast<size_t>(colCount))
-                    m_columnNames.resize(colCount);
-                m_columnNames[i] = colName;
+                m_anColumnTargets = std::move(anTargets);
+                m_bClientFilter = false;
+                return;
             }
-
-            m_columnValues[i] = colPtr;
-            m_columnTypes[i] = type;
+            LogDebugDS("Result layer: filters evaluated on the features");
         }
 
-        m_iNextRowInBatch = 0;
-        return true;
+        ExecuteQuery(m_osSQL);
+        m_anColumnTargets = m_anSourceTargets;
+        m_bClientFilter =
+            m_poFilterGeom != nullptr || m_poAttrQuery != nullptr;
     }
 
-    void ResetReading() override
+    OGRErr SetAttributeFilter(const char *pszQuery) override
     {
-        ClearStatement();
-        graal_isolatethread_t *thread =
-            (graal_isolatethread_t *)m_poDS->GetThread();
-        long long conn = m_poDS->GetConnection();
-        m_hStmt = h2gis_prepare(thread, conn, (char *)m_osSQL.c_str());
-        if (m_hStmt)
-            m_nRS = h2gis_execute_prepared(thread, m_hStmt);
-        m_nBatchRows = 0;
-        m_iNextRowInBatch = 0;
-        m_iNextFID = 0;
+        // Pushed down as is when wrapped, evaluated by OGR otherwise
+        if (pszQuery && pszQuery[0] != '\0')
+            m_osAttributeFilter = pszQuery;
+        else
+            m_osAttributeFilter.clear();
+        OGRErr eErr = OGRLayer::SetAttributeFilter(pszQuery);
+        ResetReading();
+        return eErr;
+    }
+
+#if GDAL_VERSION_NUM >= 3090000
+    OGRErr SetIgnoredFields(const char *const *papszFields) override
+#else
+    OGRErr SetIgnoredFields(const char **papszFields) override
+#endif
+    {
+        OGRErr eErr = OGRLayer::SetIgnoredFields(papszFields);
+        ResetReading();
+        return eErr;
+    }
+
+    GIntBig GetFeatureCount(int bForce) override
+    {
+        GIntBig nCount = 0;
+        if (m_bCanWrap &&
+            H2GISFetchFirstInt64((graal_isolatethread_t *)m_poDS->GetThread(),
+                                 m_poDS->GetConnection(),
+                                 BuildQuery("COUNT(*)"), {}, &nCount))
+            return nCount;
+        // Counted by reading every feature
+        return OGRLayer::GetFeatureCount(bForce);
     }
 
 #if GDAL_VERSION_NUM >= 3120000
@@ -315,9 +743,9 @@ class OGRH2GISResultLayer final : public OGRLayer
         return m_poFeatureDefn;
     }
 
-    int TestCapability(const char *) const override
+    int TestCapability(const char *pszCap) const override
     {
-        return FALSE;
+        return EQUAL(pszCap, OLCIgnoreFields);
     }
 #else
     OGRFeatureDefn *GetLayerDefn() override
@@ -325,147 +753,162 @@ class OGRH2GISResultLayer final : public OGRLayer
         return m_poFeatureDefn;
     }
 
-    int TestCapability(const char *) override
+    int TestCapability(const char *pszCap) override
     {
-        return FALSE;
+        return EQUAL(pszCap, OLCIgnoreFields);
     }
 #endif
 
-    OGRFeature *GetNextFeature() override
+    char **GetMetadataDomainList() override
     {
-        if (!m_nRS)
-            return nullptr;
-        graal_isolatethread_t *thread =
-            (graal_isolatethread_t *)m_poDS->GetThread();
+        return BuildMetadataDomainList(OGRLayer::GetMetadataDomainList(),
+                                       TRUE, H2GIS_STATS_DOMAIN, nullptr);
+    }
 
-        if (m_iNextRowInBatch >= m_nBatchRows)
+    char **GetMetadata(const char *pszDomain = "") override
+    {
+        if (pszDomain && EQUAL(pszDomain, H2GIS_STATS_DOMAIN))
         {
-            if (!FetchNextBatch())
-                return nullptr;
+            m_oStats.Report(m_aosStatsMetadata);
+            return m_aosStatsMetadata.List();
         }
+        return OGRLayer::GetMetadata(pszDomain);
+    }
 
-        OGRFeature *poFeature = new OGRFeature(m_poFeatureDefn);
-
-        int iField = 0;
-        int iGeom = 0;
-        bool fidSet = false;
+    OGRFeature *GetNextFeature() override
+    {
+        if (m_bResetPending)
+            PrepareQuery();
 
-        for (size_t iCol = 0; iCol < m_columnValues.size(); iCol++)
+        // Rows rejected by the filters are decoded into the same feature
+        OGRFeature *poRejected = nullptr;
+        while (m_nRS)
         {
-            int type = m_columnTypes[iCol];
-            uint8_t *&ptr = m_columnValues[iCol];
-
-            const std::string &colName = (iCol < m_columnNames.size())
-                                             ? m_columnNames[iCol]
-                                             : std::string();
-
-            if (!colName.empty() && EQUAL(colName.c_str(), "_ROWID_") &&
-                type == H2GIS_TYPE_LONG)
+            if (m_iNextRowInBatch >= m_nBatchRows)
             {
-                int64_t rowid;
-                memcpy(&rowid, ptr, 8);
-                ptr += 8;
-                poFeature->SetFID(rowid);
-                fidSet = true;
-                continue;
+                if (!FetchNextBatch())
+                    break;
             }
 
-            if (type == H2GIS_TYPE_GEOM)
-            {
-                int32_t len;
-                memcpy(&len, ptr, 4);
-                ptr += 4;
-                if (len > 0)
-                {
-                    OGRGeometry *poGeom = nullptr;
-                    OGRGeometryFactory::createFromWkb(ptr, nullptr, &poGeom,
-                                                      len);
-                    if (poGeom)
-                        poFeature->SetGeomFieldDirectly(iGeom, poGeom);
-                }
-                ptr += len;
-                iGeom++;
-            }
-            else if (type == H2GIS_TYPE_STRING)
-            {
-                int32_t len;
-                memcpy(&len, ptr, 4);
-                ptr += 4;
-                if (len > 0)
-                {
-                    std::string s((char *)ptr, len);
-                    poFeature->SetField(iField, s.c_str());
-                }
-                ptr += len;
-                iField++;
-            }
-            else if (type == H2GIS_TYPE_INT)
-            {
-                int32_t val;
-                memcpy(&val, ptr, 4);
-                ptr += 4;
-                poFeature->SetField(iField, val);
-                iField++;
-            }
-            else if (type == H2GIS_TYPE_LONG)
-            {
-                int64_t val;
-                memcpy(&val, ptr, 8);
-                ptr += 8;
-                poFeature->SetField(iField, (GIntBig)val);
-                iField++;
-            }
-            else if (type == H2GIS_TYPE_DOUBLE)
-            {
-                double val;
-                memcpy(&val, ptr, 8);
-                ptr += 8;
-                poFeature->SetField(iField, val);
-                iField++;
-            }
-            else if (type == H2GIS_TYPE_FLOAT)
-            {
-                float val;
-                memcpy(&val, ptr, 4);
-                ptr += 4;
-                poFeature->SetField(iField, (double)val);
-                iField++;
-            }
-            else if (type == H2GIS_TYPE_BOOL)
-            {
-                int8_t val;
-                memcpy(&val, ptr, 1);
-                ptr += 1;
-                poFeature->SetField(iField, (int)val);
-                iField++;
-            }
-            else
+            OGRFeature *poFeature = H2GISDecodeRow(
+                m_poFeatureDefn, m_aoDecodePlan, m_columnValues, poRejected);
+            poRejected = nullptr;
+
+            if (poFeature->GetFID() == OGRNullFID)
             {
-                int32_t len;
-                memcpy(&len, ptr, 4);
-                ptr += 4;
-                if (len > 0)
-                    ptr += len;
-                iField++;
+                poFeature->SetFID(m_iNextFID);
             }
+            m_iNextFID++;
+            m_iNextRowInBatch++;
+
+            if (!m_bClientFilter ||
+                ((m_poFilterGeom == nullptr ||
+                  FilterGeometry(
+                      poFeature->GetGeomFieldRef(m_iGeomFieldFilter))) &&
+                 (m_poAttrQuery == nullptr ||
+                  m_poAttrQuery->Evaluate(poFeature))))
+                return poFeature;
+            poRejected = poFeature;
         }
-
-        if (!fidSet)
-        {
-            poFeature->SetFID(m_iNextFID);
-        }
-        m_iNextFID++;
-        m_iNextRowInBatch++;
-        return poFeature;
+        delete poRejected;
+        return nullptr;
     }
 };
 
 int OGRH2GISDataSource::Open(const char *pszFilename, int bUpdate,
-                             const char *pszUser, const char *pszPassword)
+                             const char *pszUser, const char *pszPassword,
+                             CSLConstList papszOpenOptions)
 {
     LogDebugDS("Open() Called");
 
-    // Ignore bUpdate for now
+    // Scan tuning: open options win over the matching config options
+    m_bPrefetch = CPLTestBool(CSLFetchNameValueDef(
+        papszOpenOptions, "PREFETCH",
+        CPLGetConfigOption("H2GIS_PREFETCH", "NO")));
+    const char *pszBatchSize =
+        CSLFetchNameValueDef(papszOpenOptions, "BATCH_SIZE",
+                             CPLGetConfigOption("H2GIS_BATCH_SIZE", nullptr));
+    if (pszBatchSize && EQUAL(pszBatchSize, "AUTO"))
+    {
+        m_nBatchSize = 0;
+    }
+    else if (pszBatchSize)
+    {
+        const int nBatchSize = atoi(pszBatchSize);
+        if (nBatchSize > 0 && nBatchSize <= H2GIS_BATCH_MAX_ROWS)
+            m_nBatchSize = nBatchSize;
+        else
+            CPLError(CE_Warning, CPLE_IllegalArg,
+                     "H2GIS: invalid BATCH_SIZE=%s, using %d", pszBatchSize,
+                     m_nBatchSize);
+    }
+    const char *pszParallelScan = CSLFetchNameValueDef(
+        papszOpenOptions, "PARALLEL_SCAN",
+        CPLGetConfigOption("H2GIS_PARALLEL_SCAN", nullptr));
+    if (pszParallelScan)
+    {
+        const int nParallelScan = atoi(pszParallelScan);
+        if (nParallelScan > 0 && nParallelScan <= H2GIS_PARALLEL_SCAN_MAX)
+            m_nParallelScan = nParallelScan;
+        else
+            CPLError(CE_Warning, CPLE_IllegalArg,
+                     "H2GIS: invalid PARALLEL_SCAN=%s, using %d",
+                     pszParallelScan, m_nParallelScan);
+    }
+
+    m_bMetadataCache = CPLTestBool(CSLFetchNameValueDef(
+        papszOpenOptions, "METADATA_CACHE",
+        CPLGetConfigOption("H2GIS_METADATA_CACHE", "NO")));
+
+    m_bUpdate = bUpdate != FALSE;
+
+    // Simplified geometries must not be written back: read-only only
+    const char *pszSimplify = CSLFetchNameValueDef(
+        papszOpenOptions, "SIMPLIFY_TOLERANCE",
+        CPLGetConfigOption("H2GIS_SIMPLIFY_TOLERANCE", nullptr));
+    if (pszSimplify && m_bUpdate)
+    {
+        CPLError(CE_Warning, CPLE_NotSupported,
+                 "H2GIS: SIMPLIFY_TOLERANCE ignored in update mode");
+    }
+    else if (pszSimplify && EQUAL(pszSimplify, "AUTO"))
+    {
+        m_bSimplifyAuto = true;
+    }
+    else if (pszSimplify)
+    {
+        const double dfTolerance = CPLAtof(pszSimplify);
+        if (dfTolerance >= 0)
+            m_dfSimplifyTolerance = dfTolerance;
+        else
+            CPLError(CE_Warning, CPLE_IllegalArg,
+                     "H2GIS: invalid SIMPLIFY_TOLERANCE=%s, ignored",
+                     pszSimplify);
+    }
+
+    // Budget, in MB, of the tiles cached by each layer
+    const char *pszTileCache = CSLFetchNameValueDef(
+        papszOpenOptions, "TILE_CACHE",
+        CPLGetConfigOption("H2GIS_TILE_CACHE", nullptr));
+    if (pszTileCache)
+    {
+        const int nTileCacheMB = atoi(pszTileCache);
+        if (nTileCacheMB >= 0)
+            m_nTileCacheBytes = static_cast<size_t>(nTileCacheMB) * 1024 * 1024;
+        else
+            CPLError(CE_Warning, CPLE_IllegalArg,
+                     "H2GIS: invalid TILE_CACHE=%s, ignored", pszTileCache);
+    }
+
+    const char *pszSpatialFilter = CSLFetchNameValueDef(
+        papszOpenOptions, "SPATIAL_FILTER",
+        CPLGetConfigOption("H2GIS_SPATIAL_FILTER", "EXACT"));
+    if (EQUAL(pszSpatialFilter, "BBOX"))
+        m_bSpatialFilterBBox = true;
+    else if (!EQUAL(pszSpatialFilter, "EXACT"))
+        CPLError(CE_Warning, CPLE_IllegalArg,
+                 "H2GIS: invalid SPATIAL_FILTER=%s, using EXACT",
+                 pszSpatialFilter);
     if (!pszFilename || strlen(pszFilename) == 0)
     {
         return FALSE;
@@ -599,6 +1042,15 @@ int OGRH2GISDataSource::Open(const char *pszFilename, int bUpdate,
 
     LogDebugDS(std::string("Connecting to: " + path).c_str());
 
+    // Key of the metadata cache: H2 rewrites the file whenever it is
+    // opened, so its state is taken before connecting
+    VSIStatBufL sStat;
+    if (m_bMetadataCache && VSIStatL(m_pszName, &sStat) == 0)
+    {
+        m_nDBFileMTime = static_cast<GIntBig>(sStat.st_mtime);
+        m_nDBFileSize = static_cast<GIntBig>(sStat.st_size);
+    }
+
     // Priority for credentials (highest to lowest):
     // 1. GDAL Open Options (pszUser, pszPassword) - from Data Source Manager
     // 2. URI parameters (?user=... or |user=...)
@@ -639,10 +1091,28 @@ int OGRH2GISDataSource::Open(const char *pszFilename, int bUpdate,
     candidates.push_back({"sa", "sa"});
 
     long long conn = -1;
+    std::string osSharedKey;
+    bool bIdleConnection = false;
 
     for (size_t i = 0; i < candidates.size(); i++)
     {
         const auto &cred = candidates[i];
+
+        // Datasets already opened the database with these credentials:
+        // reuse a connection one of them released
+        osSharedKey = BuildSharedKey(path, cred.u, cred.p);
+        conn = TakeIdleConnection(osSharedKey);
+        if (conn >= 0)
+        {
+            LogDebugDS("Reusing the connection of a closed dataset");
+            bIdleConnection = true;
+            m_hConnection = conn;
+            m_osConnectPath = path;
+            m_osConnectUser = cred.u;
+            m_osConnectPassword = cred.p;
+            break;
+        }
+
         LogDebugDS((std::string("Attempting connection (") +
                     std::to_string(i + 1) + "/" +
                     std::to_string(candidates.size()) + ") user='" + cred.u +
@@ -657,6 +1127,9 @@ int OGRH2GISDataSource::Open(const char *pszFilename, int bUpdate,
         {
             LogDebugDS("Connection successful!");
             m_hConnection = conn;
+            m_osConnectPath = path;
+            m_osConnectUser = cred.u;
+            m_osConnectPassword = cred.p;
             break;
         }
         else
@@ -678,9 +1151,72 @@ int OGRH2GISDataSource::Open(const char *pszFilename, int bUpdate,
     }
 
     // Initialize H2GIS functions
-    // This creates the alias and GEOMETRY_COLUMNS if missing.
-    LogDebugDS("Initializing H2GIS...");
-    h2gis_load(thread, m_hConnection);
+    // This creates the alias and GEOMETRY_COLUMNS if missing, in the
+    // database: the datasets that have it open already did it.
+    if (!bIdleConnection && !IsSharedDatabaseOpen(osSharedKey))
+    {
+        LogDebugDS("Initializing H2GIS...");
+        h2gis_load(thread, m_hConnection);
+    }
+    const bool bSharedLayerInfos = AttachSharedDatabase(osSharedKey);
+
+    // Native images may be built without the generalization functions
+    if (m_dfSimplifyTolerance > 0 || m_bSimplifyAuto)
+    {
+        long long sizeOut = 0;
+        void *pBuffer = h2gis_query_first_row(
+            thread, m_hConnection,
+            (char *)"SELECT ST_SimplifyPreserveTopology("
+                    "CAST(NULL AS GEOMETRY), 0)",
+            nullptr, 0, &sizeOut);
+        if (pBuffer)
+        {
+            h2gis_free_result_buffer(thread, pBuffer);
+        }
+        else
+        {
+            CPLError(CE_Warning, CPLE_NotSupported,
+                     "H2GIS: SIMPLIFY_TOLERANCE ignored, "
+                     "ST_SimplifyPreserveTopology() is not available");
+            m_dfSimplifyTolerance = 0;
+            m_bSimplifyAuto = false;
+        }
+    }
+
+    // Layers read by the other datasets of the database, or with
+    // METADATA_CACHE, those described when the unchanged database was last
+    // closed, instead of querying INFORMATION_SCHEMA
+    if (bSharedLayerInfos)
+    {
+        LogDebugDS("Layers shared with the other datasets of the database");
+    }
+    else
+    {
+        if (!m_bMetadataCache || !LoadMetadataCache())
+            QueryLayerInfos();
+        PublishSharedLayerInfos();
+    }
+
+    m_nLayers = static_cast<int>(m_aoLayerInfos.size());
+    m_papoLayers = static_cast<OGRH2GISLayer **>(
+        CPLCalloc(std::max(m_nLayers, 1), sizeof(OGRH2GISLayer *)));
+    LogDebugDS(
+        (std::string("Total layers found: ") + std::to_string(m_nLayers))
+            .c_str());
+
+    // Set description for GDAL (required for proper identification)
+    SetDescription(m_pszName);
+
+    return TRUE;
+}
+
+/**
+ * Describe the layers of the database from INFORMATION_SCHEMA, in a single
+ * query, into m_aoLayerInfos.
+ */
+void OGRH2GISDataSource::QueryLayerInfos()
+{
+    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
 
     // =======================================================================
     // SINGLE QUERY: Get ALL metadata from INFORMATION_SCHEMA.COLUMNS
@@ -709,7 +1245,7 @@ int OGRH2GISDataSource::Open(const char *pszFilename, int bUpdate,
     if (!stmt)
     {
         LogDebugDS("INFORMATION_SCHEMA query failed. Opening as empty DB.");
-        return TRUE;
+        return;
     }
     LogDebugDS("Metadata query prepared OK");
 
@@ -718,7 +1254,7 @@ int OGRH2GISDataSource::Open(const char *pszFilename, int bUpdate,
     {
         h2gis_close_query(thread, stmt);
         LogDebugDS("Metadata query execute failed");
-        return TRUE;
+        return;
     }
     LogDebugDS("Metadata query executed OK");
 
@@ -945,14 +1481,21 @@ int OGRH2GISDataSource::Open(const char *pszFilename, int bUpdate,
             .c_str());
 
     // =======================================================================
-    // Create layers: one layer per geometry column (or one for non-spatial)
-    // Naming: TABLE if one geom, TABLE.GEOM_COL if multiple geoms
+    // Describe layers: one layer per geometry column (or one for non-spatial)
+    // Naming: TABLE if one geom, TABLE.GEOM_COL if multiple geoms. The
+    // layers themselves are only created on first access (GetLayer())
     // =======================================================================
     for (const auto &kv : tables)
     {
         const std::string &tableName = kv.first;
         const TableInfo &ti = kv.second;
 
+        if (tableName == H2GIS_EXTENT_TABLE)
+        {
+            m_bHasExtentTable = true;  // Driver metadata, not a layer
+            continue;
+        }
+
         std::string fidColName;
         for (const auto &col : ti.columns)
         {
@@ -965,79 +1508,169 @@ int OGRH2GISDataSource::Open(const char *pszFilename, int bUpdate,
 
         if (ti.geomColumns.empty())
         {
-            // Non-spatial table: create single layer with table name
+            // Non-spatial table: single layer with table name
             LogDebugDS((std::string("Adding non-spatial table: ") + tableName)
                            .c_str());
 
-            m_papoLayers = (OGRH2GISLayer **)CPLRealloc(
-                m_papoLayers, sizeof(OGRH2GISLayer *) * (m_nLayers + 1));
-            m_papoLayers[m_nLayers++] = new OGRH2GISLayer(
-                this,
-                tableName.c_str(),   // Table name for SQL
-                tableName.c_str(),   // Layer name (same as table)
-                "",                  // No geometry column
-                fidColName.c_str(),  // FID column
-                0,                   // No SRID
-                wkbNone,             // No geometry type
-                ti.rowCountEstimate, ti.columns);
+            H2GISLayerInfo oInfo;
+            oInfo.osTableName = tableName;
+            oInfo.osLayerName = tableName;
+            oInfo.osFIDCol = fidColName;
+            oInfo.nRowCountEstimate = ti.rowCountEstimate;
+            oInfo.aoColumns = ti.columns;
+            m_aoLayerInfos.push_back(std::move(oInfo));
+            continue;
         }
-        else if (ti.geomColumns.size() == 1)
+
+        for (const std::string &geomCol : ti.geomColumns)
         {
-            // Single geometry column: layer name = table name
-            const std::string &geomCol = ti.geomColumns[0];
-            OGRwkbGeometryType geomType = ti.geomTypes.at(geomCol);
-            int srid = ti.geomSrids.at(geomCol);
-
-            LogDebugDS((std::string("Adding spatial table: ") + tableName +
-                        " (geom=" + geomCol + ", srid=" + std::to_string(srid) +
-                        ")")
+            H2GISLayerInfo oInfo;
+            oInfo.osTableName = tableName;
+            oInfo.osLayerName = ti.geomColumns.size() == 1
+                                    ? tableName
+                                    : tableName + "." + geomCol;
+            oInfo.osGeomCol = geomCol;
+            oInfo.osFIDCol = fidColName;
+            oInfo.nSRID = ti.geomSrids.at(geomCol);
+            oInfo.eGeomType = ti.geomTypes.at(geomCol);
+            oInfo.nRowCountEstimate = ti.rowCountEstimate;
+            oInfo.aoColumns = ti.columns;
+
+            LogDebugDS((std::string("Adding spatial layer: ") +
+                        oInfo.osLayerName + " (geom=" + geomCol +
+                        ", srid=" + std::to_string(oInfo.nSRID) + ")")
                            .c_str());
-
-            m_papoLayers = (OGRH2GISLayer **)CPLRealloc(
-                m_papoLayers, sizeof(OGRH2GISLayer *) * (m_nLayers + 1));
-            m_papoLayers[m_nLayers++] = new OGRH2GISLayer(
-                this,
-                tableName.c_str(),   // Table name for SQL
-                tableName.c_str(),   // Layer name (same as table)
-                geomCol.c_str(),     // Geometry column
-                fidColName.c_str(),  // FID column
-                srid, geomType, ti.rowCountEstimate, ti.columns);
+            m_aoLayerInfos.push_back(std::move(oInfo));
         }
-        else
-        {
-            // Multiple geometry columns: create one layer per geometry column
-            // Layer name = TABLE.GEOM_COL
-            for (const std::string &geomCol : ti.geomColumns)
-            {
-                OGRwkbGeometryType geomType = ti.geomTypes.at(geomCol);
-                int srid = ti.geomSrids.at(geomCol);
-                std::string layerName = tableName + "." + geomCol;
+    }
+}
 
-                LogDebugDS((std::string("Adding multi-geom layer: ") +
-                            layerName + " (srid=" + std::to_string(srid) + ")")
-                               .c_str());
+/**
+ * METADATA_CACHE file of the database: the connection path (database file
+ * without its .mv.db extension) followed by H2GIS_METADATA_CACHE_SUFFIX.
+ */
+std::string OGRH2GISDataSource::GetMetadataCachePath() const
+{
+    return m_osConnectPath + H2GIS_METADATA_CACHE_SUFFIX;
+}
 
-                m_papoLayers = (OGRH2GISLayer **)CPLRealloc(
-                    m_papoLayers, sizeof(OGRH2GISLayer *) * (m_nLayers + 1));
-                m_papoLayers[m_nLayers++] = new OGRH2GISLayer(
-                    this,
-                    tableName.c_str(),   // Table name for SQL
-                    layerName.c_str(),   // Layer name = TABLE.GEOM_COL
-                    geomCol.c_str(),     // Geometry column for this layer
-                    fidColName.c_str(),  // FID column
-                    srid, geomType, ti.rowCountEstimate, ti.columns);
-            }
-        }
+/**
+ * Fill m_aoLayerInfos from the METADATA_CACHE file, if it was saved when
+ * the database file was last left in its current state.
+ *
+ * @return false if there is no such file, in which case the caller queries
+ *         INFORMATION_SCHEMA.
+ */
+bool OGRH2GISDataSource::LoadMetadataCache()
+{
+    const std::string osPath = GetMetadataCachePath();
+    VSIStatBufL sStat;
+    if (m_nDBFileSize < 0 || VSIStatL(osPath.c_str(), &sStat) != 0)
+        return false;
+
+    CPLJSONDocument oDoc;
+    if (!oDoc.Load(osPath))
+        return false;
+    const CPLJSONObject oRoot = oDoc.GetRoot();
+    if (oRoot.GetInteger("version") != H2GIS_METADATA_CACHE_VERSION ||
+        oRoot.GetLong("mtime", -1) != m_nDBFileMTime ||
+        oRoot.GetLong("size", -1) != m_nDBFileSize)
+    {
+        LogDebugDS("Metadata cache is out of date");
+        return false;
     }
 
-    LogDebugDS(
-        (std::string("Total layers created: ") + std::to_string(m_nLayers))
-            .c_str());
+    m_bHasExtentTable = oRoot.GetBool("extent_table");
+    const CPLJSONArray oLayers = oRoot.GetArray("layers");
+    for (int i = 0; i < oLayers.Size(); i++)
+    {
+        const CPLJSONObject oLayer = oLayers[i];
+        H2GISLayerInfo oInfo;
+        oInfo.osTableName = oLayer.GetString("table");
+        oInfo.osLayerName = oLayer.GetString("name");
+        oInfo.osGeomCol = oLayer.GetString("geometry_column");
+        oInfo.osFIDCol = oLayer.GetString("fid_column");
+        oInfo.nSRID = oLayer.GetInteger("srid");
+        oInfo.eGeomType =
+            static_cast<OGRwkbGeometryType>(oLayer.GetInteger("geometry_type"));
+        oInfo.nRowCountEstimate = oLayer.GetLong("row_count");
+
+        const CPLJSONArray oColumns = oLayer.GetArray("columns");
+        for (int j = 0; j < oColumns.Size(); j++)
+        {
+            const CPLJSONObject oColumn = oColumns[j];
+            H2GISColumnInfo oCol;
+            oCol.name = oColumn.GetString("name");
+            oCol.dataType = oColumn.GetString("data_type");
+            oCol.ordinalPosition = oColumn.GetInteger("position");
+            oCol.geometryType = oColumn.GetString("geometry_type");
+            oCol.geometrySrid = oColumn.GetInteger("srid");
+            oInfo.aoColumns.push_back(std::move(oCol));
+        }
+        if (oInfo.osTableName.empty() || oInfo.osLayerName.empty())
+        {
+            m_aoLayerInfos.clear();
+            return false;
+        }
+        m_aoLayerInfos.push_back(std::move(oInfo));
+    }
 
-    // Set description for GDAL (required for proper identification)
-    SetDescription(m_pszName);
+    LogDebugDS("Layers read from the metadata cache");
+    return true;
+}
 
-    return TRUE;
+/**
+ * Save m_aoLayerInfos in the METADATA_CACHE file, keyed by the state of the
+ * database file once it is closed. Called by the destructor unless the
+ * schema was changed through the dataset.
+ */
+void OGRH2GISDataSource::SaveMetadataCache()
+{
+    VSIStatBufL sStat;
+    if (VSIStatL(m_pszName, &sStat) != 0)
+        return;
+
+    CPLJSONObject oRoot;
+    oRoot.Add("version", H2GIS_METADATA_CACHE_VERSION);
+    oRoot.Add("mtime", static_cast<GInt64>(sStat.st_mtime));
+    oRoot.Add("size", static_cast<GInt64>(sStat.st_size));
+    oRoot.Add("extent_table", m_bHasExtentTable);
+
+    CPLJSONArray oLayers;
+    for (const H2GISLayerInfo &oInfo : m_aoLayerInfos)
+    {
+        CPLJSONObject oLayer;
+        oLayer.Add("table", oInfo.osTableName);
+        oLayer.Add("name", oInfo.osLayerName);
+        oLayer.Add("geometry_column", oInfo.osGeomCol);
+        oLayer.Add("fid_column", oInfo.osFIDCol);
+        oLayer.Add("srid", oInfo.nSRID);
+        oLayer.Add("geometry_type", static_cast<int>(oInfo.eGeomType));
+        oLayer.Add("row_count", static_cast<GInt64>(oInfo.nRowCountEstimate));
+
+        CPLJSONArray oColumns;
+        for (const H2GISColumnInfo &oCol : oInfo.aoColumns)
+        {
+            CPLJSONObject oColumn;
+            oColumn.Add("name", oCol.name);
+            oColumn.Add("data_type", oCol.dataType);
+            oColumn.Add("position", oCol.ordinalPosition);
+            oColumn.Add("geometry_type", oCol.geometryType);
+            oColumn.Add("srid", oCol.geometrySrid);
+            oColumns.Add(oColumn);
+        }
+        oLayer.Add("columns", oColumns);
+        oLayers.Add(oLayer);
+    }
+    oRoot.Add("layers", oLayers);
+
+    // The cache is optional: a read-only directory is not an error
+    CPLJSONDocument oDoc;
+    oDoc.SetRoot(oRoot);
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    if (!oDoc.Save(GetMetadataCachePath()))
+        LogDebugDS("Could not save the metadata cache");
+    CPLPopErrorHandler();
 }
 
 #if GDAL_VERSION_NUM >= 3120000
@@ -1045,7 +1678,8 @@ OGRLayer *OGRH2GISDataSource::GetLayer(int i) const
 {
     if (i < 0 || i >= m_nLayers)
         return nullptr;
-    return m_papoLayers[i];
+    // Creating the layer on first access does not change the dataset
+    return const_cast<OGRH2GISDataSource *>(this)->GetOrCreateLayer(i);
 }
 
 int OGRH2GISDataSource::TestCapability(const char *pszCap) const
@@ -1063,7 +1697,7 @@ OGRLayer *OGRH2GISDataSource::GetLayer(int i)
 {
     if (i < 0 || i >= m_nLayers)
         return nullptr;
-    return m_papoLayers[i];
+    return GetOrCreateLayer(i);
 }
 
 int OGRH2GISDataSource::TestCapability(const char *pszCap)
@@ -1078,6 +1712,50 @@ int OGRH2GISDataSource::TestCapability(const char *pszCap)
 }
 #endif
 
+/**
+ * Counters of the read queries of all layers and SQL results of the
+ * dataset, and WRAPPER_* counters of the calls made by the process to the
+ * native library, all datasets included (see h2gis_wrapper_get_stats()).
+ */
+void OGRH2GISDataSource::ReportStats(CPLStringList &aosList) const
+{
+    m_oStats.Report(aosList);
+
+    h2gis_wrapper_stats_t sStats;
+    h2gis_wrapper_get_stats(&sStats);
+    const std::pair<const char *, long long> aoCounters[] = {
+        {"WRAPPER_TASKS", sStats.tasks},
+        {"WRAPPER_PREPARES", sStats.prepares},
+        {"WRAPPER_EXECUTES", sStats.executes},
+        {"WRAPPER_CLOSES", sStats.closes},
+        {"WRAPPER_FETCH_BATCHES", sStats.fetch_batches},
+        {"WRAPPER_FETCH_ROWS", sStats.fetch_rows},
+        {"WRAPPER_FETCH_BYTES", sStats.fetch_bytes}};
+    for (const auto &oCounter : aoCounters)
+        aosList.SetNameValue(oCounter.first,
+                             CPLSPrintf("%lld", oCounter.second));
+    aosList.SetNameValue("WRAPPER_QUEUE_WAIT_MS",
+                         CPLSPrintf("%.3f", sStats.queue_wait_us / 1000.0));
+    aosList.SetNameValue("WRAPPER_WORKER_MS",
+                         CPLSPrintf("%.3f", sStats.worker_us / 1000.0));
+}
+
+char **OGRH2GISDataSource::GetMetadataDomainList()
+{
+    return BuildMetadataDomainList(GDALDataset::GetMetadataDomainList(), TRUE,
+                                   H2GIS_STATS_DOMAIN, nullptr);
+}
+
+char **OGRH2GISDataSource::GetMetadata(const char *pszDomain)
+{
+    if (pszDomain && EQUAL(pszDomain, H2GIS_STATS_DOMAIN))
+    {
+        ReportStats(m_aosStatsMetadata);
+        return m_aosStatsMetadata.List();
+    }
+    return GDALDataset::GetMetadata(pszDomain);
+}
+
 #if GDAL_VERSION_NUM >= 3100000
 OGRLayer *
 OGRH2GISDataSource::ICreateLayer(const char *pszName,
@@ -1089,10 +1767,18 @@ OGRH2GISDataSource::ICreateLayer(const char *pszName,
     OGRwkbGeometryType eGType =
         poGeomFieldDefn ? poGeomFieldDefn->GetType() : wkbUnknown;
 
-    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
-
     // Validate Name
     std::string tableName(pszName);  // Escape?
+    // The CREATE TABLE is deferred: report a clash with an existing table now
+    for (const H2GISLayerInfo &oInfo : m_aoLayerInfos)
+    {
+        if (oInfo.osTableName == tableName)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "H2GIS: Table %s already exists", tableName.c_str());
+            return nullptr;
+        }
+    }
 
     // Layer creation options
     const char *pszGeomName = CSLFetchNameValue(papszOptions, "GEOMETRY_NAME");
@@ -1109,6 +1795,11 @@ OGRH2GISDataSource::ICreateLayer(const char *pszName,
     {
         bCreateSpatialIndex = false;
     }
+    // DEFERRED: built by the layer once loaded (see BuildDeferredSpatialIndex)
+    const bool bDeferSpatialIndex =
+        pszSpatialIndex && EQUAL(pszSpatialIndex, "DEFERRED");
+    if (bDeferSpatialIndex)
+        bCreateSpatialIndex = false;
 
     // Construct SQL
     // Default to FID (Serial)
@@ -1139,36 +1830,10 @@ OGRH2GISDataSource::ICreateLayer(const char *pszName,
         sql += ")";
     }
 
-    sql += ")";
-
-    long long stmt = h2gis_prepare(thread, m_hConnection, (char *)sql.c_str());
-    if (!stmt)
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "Failed to prepare CREATE TABLE statement.");
-        return nullptr;
-    }
-
-    long long rs = h2gis_execute_prepared(thread, stmt);
-    h2gis_close_query(thread, stmt);
-    // RS is usually update count or null for DDL
-    if (rs)
-        h2gis_close_query(thread, rs);
-
-    // Create Spatial Index if requested
-    if (bCreateSpatialIndex && eGType != wkbNone)
-    {
-        std::string idxSql = "CREATE SPATIAL INDEX ON \"" + tableName +
-                             "\"(\"" + geomCol + "\")";
-        stmt = h2gis_prepare(thread, m_hConnection, (char *)idxSql.c_str());
-        if (stmt)
-        {
-            rs = h2gis_execute_prepared(thread, stmt);
-            h2gis_close_query(thread, stmt);
-            if (rs)
-                h2gis_close_query(thread, rs);
-        }
-    }
+    // The column list is left open: the table is created by the layer, with
+    // the fields of the CreateField() calls that follow (see
+    // CreateDeferredTable)
+    LogDebugDS(("Deferring layer creation: " + sql).c_str());
 
     // Refresh layer list
     // Ideally we should just add the new layer to our list instead of re-opening
@@ -1186,12 +1851,24 @@ OGRH2GISDataSource::ICreateLayer(const char *pszName,
                           (eGType != wkbNone ? geomCol.c_str() : ""),
                           fidCol.c_str(), srid, eGType, 0, cols,
                           true /* bSchemaFetched */);
+    poLayer->DeferTableCreation(sql, bCreateSpatialIndex && eGType != wkbNone);
+    if (bDeferSpatialIndex && eGType != wkbNone)
+        poLayer->DeferSpatialIndex();
+    poLayer->SetFeatureCountExact();
+    poLayer->SetCachedExtent(OGREnvelope(), m_bHasExtentTable);  // Empty
 
     // Add to list
     m_nLayers++;
     m_papoLayers = (OGRH2GISLayer **)CPLRealloc(
         m_papoLayers, sizeof(OGRH2GISLayer *) * m_nLayers);
     m_papoLayers[m_nLayers - 1] = poLayer;
+    // Only the names are used once the layer exists
+    H2GISLayerInfo oInfo;
+    oInfo.osTableName = tableName;
+    oInfo.osLayerName = tableName;
+    oInfo.osGeomCol = poLayer->GetGeomColumnName();
+    m_aoLayerInfos.push_back(std::move(oInfo));
+    InvalidateMetadataCache();
 
     return poLayer;
 }
@@ -1212,10 +1889,18 @@ OGRLayer *OGRH2GISDataSource::ICreateLayer(const char *pszName,
                                            char **papszOptions)
 #endif
 {
-    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
-
     // Validate Name
     std::string tableName(pszName);  // Escape?
+    // The CREATE TABLE is deferred: report a clash with an existing table now
+    for (const H2GISLayerInfo &oInfo : m_aoLayerInfos)
+    {
+        if (oInfo.osTableName == tableName)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "H2GIS: Table %s already exists", tableName.c_str());
+            return nullptr;
+        }
+    }
 
     // Layer creation options
     const char *pszGeomName = CSLFetchNameValue(papszOptions, "GEOMETRY_NAME");
@@ -1232,6 +1917,11 @@ OGRLayer *OGRH2GISDataSource::ICreateLayer(const char *pszName,
     {
         bCreateSpatialIndex = false;
     }
+    // DEFERRED: built by the layer once loaded (see BuildDeferredSpatialIndex)
+    const bool bDeferSpatialIndex =
+        pszSpatialIndex && EQUAL(pszSpatialIndex, "DEFERRED");
+    if (bDeferSpatialIndex)
+        bCreateSpatialIndex = false;
 
     // Construct SQL
     // Default to FID (Serial)
@@ -1262,23 +1952,10 @@ OGRLayer *OGRH2GISDataSource::ICreateLayer(const char *pszName,
         sql += ")";
     }
 
-    sql += ")";
-
-    LogDebugDS(("Creating Layer: " + sql).c_str());
-
-    if (h2gis_execute(thread, m_hConnection, (char *)sql.c_str()) < 0)
-    {
-        CPLError(CE_Failure, CPLE_AppDefined, "Failed to create table");
-        return nullptr;
-    }
-
-    // Force Spatial Index
-    if (eGType != wkbNone && bCreateSpatialIndex)
-    {
-        std::string idxSql = "CREATE SPATIAL INDEX ON \"" + tableName +
-                             "\"(\"" + geomCol + "\")";
-        h2gis_execute(thread, m_hConnection, (char *)idxSql.c_str());
-    }
+    // The column list is left open: the table is created by the layer, with
+    // the fields of the CreateField() calls that follow (see
+    // CreateDeferredTable)
+    LogDebugDS(("Deferring layer creation: " + sql).c_str());
 
     // Register Layer
     m_papoLayers = (OGRH2GISLayer **)CPLRealloc(
@@ -1300,7 +1977,19 @@ OGRLayer *OGRH2GISDataSource::ICreateLayer(const char *pszName,
                           0,       // Row count (empty table)
                           cols,
                           true /* bSchemaFetched */);
+    layer->DeferTableCreation(sql, bCreateSpatialIndex && eGType != wkbNone);
+    if (bDeferSpatialIndex && eGType != wkbNone)
+        layer->DeferSpatialIndex();
+    layer->SetFeatureCountExact();
+    layer->SetCachedExtent(OGREnvelope(), m_bHasExtentTable);  // Empty
     m_papoLayers[m_nLayers++] = layer;
+    // Only the names are used once the layer exists
+    H2GISLayerInfo oInfo;
+    oInfo.osTableName = tableName;
+    oInfo.osLayerName = tableName;
+    oInfo.osGeomCol = layer->GetGeomColumnName();
+    m_aoLayerInfos.push_back(std::move(oInfo));
+    InvalidateMetadataCache();
 
     return layer;
 }
@@ -1312,7 +2001,19 @@ OGRErr OGRH2GISDataSource::DeleteLayer(int iLayer)
         return OGRERR_FAILURE;
 
     OGRH2GISLayer *poLayer = m_papoLayers[iLayer];
-    std::string tableName = poLayer->GetLayerDefn()->GetName();
+    const H2GISLayerInfo &oInfo = m_aoLayerInfos[iLayer];
+    std::string tableName = oInfo.osLayerName;
+
+    if (poLayer)
+    {
+        poLayer->DiscardDeferredTable();
+        poLayer->OnTransactionRolledBack();  // Drop queued inserts, extent
+    }
+    else
+        DeleteStoredExtent(oInfo.osTableName, oInfo.osGeomCol);
+    m_oStoredExtents.erase(std::make_pair(oInfo.osTableName, oInfo.osGeomCol));
+    CommitImplicitTransaction();
+    InvalidateMetadataCache();
 
     std::string sql = "DROP TABLE IF EXISTS \"" + tableName + "\" CASCADE";
 
@@ -1327,27 +2028,200 @@ OGRErr OGRH2GISDataSource::DeleteLayer(int iLayer)
     // Shift remaining
     for (int i = iLayer; i < m_nLayers - 1; i++)
         m_papoLayers[i] = m_papoLayers[i + 1];
+    m_aoLayerInfos.erase(m_aoLayerInfos.begin() + iLayer);
 
     m_nLayers--;
     return OGRERR_NONE;
 }
 
+/**
+ * Read the rows of H2GIS_EXTENT_TABLE in one query into m_oStoredExtents,
+ * from which GetOrCreateLayer() sets the extent cache of the layers.
+ */
+void OGRH2GISDataSource::LoadStoredExtents()
+{
+    m_bStoredExtentsLoaded = true;
+    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
+    const std::string sql =
+        std::string("SELECT \"TABLE_NAME\", \"GEOMETRY_COLUMN\", \"MINX\", "
+                    "\"MINY\", \"MAXX\", \"MAXY\" FROM \"") +
+        H2GIS_EXTENT_TABLE + "\"";
+
+    long long stmt = h2gis_prepare(thread, m_hConnection, (char *)sql.c_str());
+    if (!stmt)
+        return;
+    long long qHandle = h2gis_execute_prepared(thread, stmt);
+    if (!qHandle)
+    {
+        h2gis_close_query(thread, stmt);
+        return;
+    }
+
+    long long sizeOut = 0;
+    void *buffer = nullptr;
+    while ((buffer = h2gis_fetch_batch(thread, qHandle, 10000, &sizeOut)) !=
+               nullptr &&
+           sizeOut > 0)
+    {
+        uint8_t *ptr = (uint8_t *)buffer;
+        int32_t colCount, rowCount;
+        std::memcpy(&colCount, ptr, 4);
+        ptr += 4;
+        std::memcpy(&rowCount, ptr, 4);
+        ptr += 4;
+        if (rowCount <= 0 || colCount != 6)
+        {
+            h2gis_free_result_buffer(thread, buffer);
+            break;
+        }
+
+        // Column cursors: [nameLen 4][name][type 4][totalDataLen 4][values]
+        uint8_t *colPtrs[6];
+        int32_t colTypes[6];
+        for (int c = 0; c < 6; c++)
+        {
+            int64_t offset;
+            std::memcpy(&offset, ptr + 8 * c, 8);
+            uint8_t *colPtr = (uint8_t *)buffer + offset;
+            int32_t nameLen;
+            std::memcpy(&nameLen, colPtr, 4);
+            colPtr += 4 + nameLen;
+            std::memcpy(&colTypes[c], colPtr, 4);
+            colPtrs[c] = colPtr + 8;
+        }
+        if (colTypes[0] != H2GIS_TYPE_STRING ||
+            colTypes[1] != H2GIS_TYPE_STRING)
+        {
+            h2gis_free_result_buffer(thread, buffer);
+            break;
+        }
+
+        for (int row = 0; row < rowCount; row++)
+        {
+            std::string aosKey[2];
+            for (int c = 0; c < 2; c++)
+            {
+                int32_t strLen;
+                std::memcpy(&strLen, colPtrs[c], 4);
+                colPtrs[c] += 4;
+                if (strLen > 0)
+                    aosKey[c].assign((char *)colPtrs[c], strLen);
+                colPtrs[c] += std::max(strLen, 0);
+            }
+            double adfBounds[4] = {0, 0, 0, 0};
+            for (int c = 2; c < 6; c++)
+            {
+                if (colTypes[c] == H2GIS_TYPE_DOUBLE)
+                    std::memcpy(&adfBounds[c - 2], colPtrs[c], 8);
+                colPtrs[c] += 8;
+            }
+
+            OGREnvelope oExtent;
+            oExtent.MinX = adfBounds[0];
+            oExtent.MinY = adfBounds[1];
+            oExtent.MaxX = adfBounds[2];
+            oExtent.MaxY = adfBounds[3];
+            m_oStoredExtents[std::make_pair(aosKey[0], aosKey[1])] = oExtent;
+        }
+        h2gis_free_result_buffer(thread, buffer);
+    }
+
+    h2gis_close_query(thread, qHandle);
+    h2gis_close_query(thread, stmt);
+}
+
+/**
+ * Save the extent of the geometry column osGeomCol of osTable, creating
+ * H2GIS_EXTENT_TABLE on first use. Only done in update mode and outside
+ * StartTransaction(), as CREATE TABLE would commit the transaction.
+ *
+ * @return false if the extent was not saved.
+ */
+bool OGRH2GISDataSource::StoreExtent(const std::string &osTable,
+                                     const std::string &osGeomCol,
+                                     const OGREnvelope &oExtent)
+{
+    if (!m_bUpdate || m_bInTransaction || !m_hThread || m_hConnection < 0)
+        return false;
+
+    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
+    if (!m_bHasExtentTable)
+    {
+        CommitImplicitTransaction();
+        const std::string sql =
+            std::string("CREATE TABLE IF NOT EXISTS \"") + H2GIS_EXTENT_TABLE +
+            "\" (\"TABLE_NAME\" VARCHAR NOT NULL, \"GEOMETRY_COLUMN\" "
+            "VARCHAR NOT NULL, \"MINX\" DOUBLE, \"MINY\" DOUBLE, \"MAXX\" "
+            "DOUBLE, \"MAXY\" DOUBLE, PRIMARY KEY (\"TABLE_NAME\", "
+            "\"GEOMETRY_COLUMN\"))";
+        if (h2gis_execute(thread, m_hConnection, (char *)sql.c_str()) < 0)
+            return false;
+        m_bHasExtentTable = true;
+        InvalidateSharedLayerInfos();  // Their m_bHasExtentTable is stale
+    }
+
+    const std::string sql =
+        std::string("MERGE INTO \"") + H2GIS_EXTENT_TABLE +
+        "\" KEY (\"TABLE_NAME\", \"GEOMETRY_COLUMN\") "
+        "VALUES (?, ?, ?, ?, ?, ?)";
+    long long hStmt =
+        h2gis_prepare(thread, m_hConnection, (char *)sql.c_str());
+    if (!hStmt)
+        return false;
+    h2gis_bind_string(thread, hStmt, 1, (char *)osTable.c_str());
+    h2gis_bind_string(thread, hStmt, 2, (char *)osGeomCol.c_str());
+    h2gis_bind_double(thread, hStmt, 3, oExtent.MinX);
+    h2gis_bind_double(thread, hStmt, 4, oExtent.MinY);
+    h2gis_bind_double(thread, hStmt, 5, oExtent.MaxX);
+    h2gis_bind_double(thread, hStmt, 6, oExtent.MaxY);
+    const bool bOK = h2gis_execute_prepared_update(thread, hStmt) >= 0;
+    h2gis_close_query(thread, hStmt);
+    return bOK;
+}
+
+/**
+ * Delete the saved extent of the geometry column osGeomCol of osTable, in
+ * the current transaction, when the layer is modified.
+ */
+void OGRH2GISDataSource::DeleteStoredExtent(const std::string &osTable,
+                                            const std::string &osGeomCol)
+{
+    if (!m_bHasExtentTable || !m_hThread || m_hConnection < 0)
+        return;
+
+    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
+    const std::string sql =
+        std::string("DELETE FROM \"") + H2GIS_EXTENT_TABLE +
+        "\" WHERE \"TABLE_NAME\" = ? AND \"GEOMETRY_COLUMN\" = ?";
+    long long hStmt =
+        h2gis_prepare(thread, m_hConnection, (char *)sql.c_str());
+    if (!hStmt)
+        return;
+    h2gis_bind_string(thread, hStmt, 1, (char *)osTable.c_str());
+    h2gis_bind_string(thread, hStmt, 2, (char *)osGeomCol.c_str());
+    h2gis_execute_prepared_update(thread, hStmt);
+    h2gis_close_query(thread, hStmt);
+}
+
 OGRLayer *OGRH2GISDataSource::ExecuteSQL(const char *pszSQL,
                                          OGRGeometry *poSpatialFilter,
                                          const char *pszDialect)
 {
+    // Queries must see the buffered inserts
+    FlushPendingInserts();
+
     // Handle SELECT/CALL/WITH queries returning a result set
     if (STARTS_WITH_CI(pszSQL, "SELECT") || STARTS_WITH_CI(pszSQL, "CALL") ||
         STARTS_WITH_CI(pszSQL, "WITH"))
     {
-        OGRH2GISResultLayer *poLayer = new OGRH2GISResultLayer(this, pszSQL);
-        if (poSpatialFilter != nullptr)
-            poLayer->SetSpatialFilter(poSpatialFilter);
-        return poLayer;
+        return new OGRH2GISResultLayer(this, pszSQL, poSpatialFilter);
     }
 
     graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
 
+    // The statement may be DDL, which would end the implicit transaction
+    CommitImplicitTransaction();
+
     // Handle INSERT/UPDATE/DELETE/DDL
     int ret = h2gis_execute(thread, m_hConnection, (char *)pszSQL);
     if (ret < 0)
@@ -1355,6 +2229,23 @@ OGRLayer *OGRH2GISDataSource::ExecuteSQL(const char *pszSQL,
         CPLError(CE_Failure, CPLE_AppDefined, "H2GIS: ExecuteSQL failed.");
     }
 
+    // The statement may have modified or altered any table, including the
+    // ones whose layer is not created yet
+    InvalidateMetadataCache();
+    if (m_bHasExtentTable)
+    {
+        const std::string osSQL =
+            std::string("DELETE FROM \"") + H2GIS_EXTENT_TABLE + "\"";
+        h2gis_execute(thread, m_hConnection, (char *)osSQL.c_str());
+        m_oStoredExtents.clear();
+        m_bStoredExtentsLoaded = true;
+    }
+    for (int i = 0; i < m_nLayers; i++)
+    {
+        if (m_papoLayers[i])
+            m_papoLayers[i]->InvalidateCachedData();
+    }
+
     return nullptr;
 }
 
@@ -1369,17 +2260,112 @@ OGRLayer *OGRH2GISDataSource::GetLayerByName(const char *pszName)
         return nullptr;
     for (int i = 0; i < m_nLayers; i++)
     {
-        if (EQUAL(m_papoLayers[i]->GetName(), pszName))
-            return m_papoLayers[i];
+        if (EQUAL(m_aoLayerInfos[i].osLayerName.c_str(), pszName))
+            return GetOrCreateLayer(i);
     }
     return nullptr;
 }
 
+/**
+ * Return layer i, creating it and its feature definition from
+ * m_aoLayerInfos on first access, so that opening a database with many
+ * tables only costs the layers actually used.
+ */
+OGRH2GISLayer *OGRH2GISDataSource::GetOrCreateLayer(int i)
+{
+    if (m_papoLayers[i] != nullptr)
+        return m_papoLayers[i];
+
+    const H2GISLayerInfo &oInfo = m_aoLayerInfos[i];
+    OGRH2GISLayer *poLayer = new OGRH2GISLayer(
+        this, oInfo.osTableName.c_str(), oInfo.osLayerName.c_str(),
+        oInfo.osGeomCol.c_str(), oInfo.osFIDCol.c_str(), oInfo.nSRID,
+        oInfo.eGeomType, oInfo.nRowCountEstimate, oInfo.aoColumns);
+
+    if (m_bHasExtentTable && !oInfo.osGeomCol.empty())
+    {
+        if (!m_bStoredExtentsLoaded)
+            LoadStoredExtents();
+        auto oIter = m_oStoredExtents.find(
+            std::make_pair(oInfo.osTableName, oInfo.osGeomCol));
+        if (oIter != m_oStoredExtents.end())
+        {
+            poLayer->SetCachedExtent(oIter->second, true);
+            m_oStoredExtents.erase(oIter);
+        }
+    }
+
+    m_papoLayers[i] = poLayer;
+    return poLayer;
+}
+
+OGRErr OGRH2GISDataSource::FlushPendingInserts()
+{
+    OGRErr eErr = OGRERR_NONE;
+    for (int i = 0; i < m_nLayers; i++)
+    {
+        if (m_papoLayers[i] &&
+            m_papoLayers[i]->FlushPendingInserts() != OGRERR_NONE)
+            eErr = OGRERR_FAILURE;
+    }
+    return eErr;
+}
+
+/**
+ * Open an implicit transaction for an insert made outside
+ * StartTransaction(), so that consecutive inserts are committed together.
+ * A transaction grown past H2GIS_IMPLICIT_TXN_ROWS is committed first.
+ */
+void OGRH2GISDataSource::BeginImplicitTransaction()
+{
+    if (m_bInTransaction)
+        return;
+    if (m_bImplicitTransaction &&
+        ++m_nImplicitTransactionRows < H2GIS_IMPLICIT_TXN_ROWS)
+        return;
+
+    CommitImplicitTransaction();
+    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
+    if (h2gis_execute(thread, m_hConnection, (char *)"BEGIN") >= 0)
+    {
+        m_bImplicitTransaction = true;
+        m_nImplicitTransactionRows = 0;
+    }
+}
+
+OGRErr OGRH2GISDataSource::CommitImplicitTransaction()
+{
+    if (!m_bImplicitTransaction)
+        return OGRERR_NONE;
+
+    OGRErr eErr = FlushPendingInserts();
+    m_bImplicitTransaction = false;
+    graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
+    if (h2gis_execute(thread, m_hConnection, (char *)"COMMIT") < 0)
+        return OGRERR_FAILURE;
+    for (int i = 0; i < m_nLayers; i++)
+    {
+        if (m_papoLayers[i])
+            m_papoLayers[i]->OnTransactionCommitted();
+    }
+    return eErr;
+}
+
 OGRErr OGRH2GISDataSource::StartTransaction(int bForce)
 {
+    if (m_bInTransaction)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "H2GIS: A transaction is already active");
+        return OGRERR_FAILURE;
+    }
+    if (CommitImplicitTransaction() != OGRERR_NONE)
+        return OGRERR_FAILURE;
+
     graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
     if (h2gis_execute(thread, m_hConnection, (char *)"BEGIN") >= 0)
     {
+        m_bInTransaction = true;
         return OGRERR_NONE;
     }
     return OGRERR_FAILURE;
@@ -1387,9 +2373,22 @@ OGRErr OGRH2GISDataSource::StartTransaction(int bForce)
 
 OGRErr OGRH2GISDataSource::CommitTransaction()
 {
+    // Buffered inserts belong to the transaction
+    if (FlushPendingInserts() != OGRERR_NONE)
+    {
+        RollbackTransaction();
+        return OGRERR_FAILURE;
+    }
+
     graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
+    m_bInTransaction = false;
     if (h2gis_execute(thread, m_hConnection, (char *)"COMMIT") >= 0)
     {
+        for (int i = 0; i < m_nLayers; i++)
+        {
+            if (m_papoLayers[i])
+                m_papoLayers[i]->OnTransactionCommitted();
+        }
         return OGRERR_NONE;
     }
     return OGRERR_FAILURE;
@@ -1397,7 +2396,15 @@ OGRErr OGRH2GISDataSource::CommitTransaction()
 
 OGRErr OGRH2GISDataSource::RollbackTransaction()
 {
+    for (int i = 0; i < m_nLayers; i++)
+    {
+        if (m_papoLayers[i])
+            m_papoLayers[i]->OnTransactionRolledBack();
+    }
+
     graal_isolatethread_t *thread = (graal_isolatethread_t *)m_hThread;
+    m_bInTransaction = false;
+    m_bImplicitTransaction = false;
     if (h2gis_execute(thread, m_hConnection, (char *)"ROLLBACK") >= 0)
     {
         return OGRERR_NONE;
@@ -142,7 +142,8 @@ static GDALDataset *OGRH2GISDriverOpen(GDALOpenInfo *poOpenInfo)
 
     if (!poDS->Open(filename.c_str(), poOpenInfo->eAccess == GA_Update,
                     finalUser.empty() ? nullptr : finalUser.c_str(),
-                    finalPass.empty() ? nullptr : finalPass.c_str()))
+                    finalPass.empty() ? nullptr : finalPass.c_str(),
+                    poOpenInfo->papszOpenOptions))
     {
         delete poDS;
         return nullptr;
@@ -214,8 +215,13 @@ void RegisterOGRH2GIS()
         "geometry column' default='GEOM'/>"
         "  <Option name='FID' type='string' description='Name of the FID "
         "column' default='ID'/>"
-        "  <Option name='SPATIAL_INDEX' type='boolean' description='Create "
-        "spatial index' default='YES'/>"
+        "  <Option name='SPATIAL_INDEX' type='string-select' "
+        "description='Create spatial index, or DEFERRED to build it once "
+        "the layer is loaded' default='YES'>"
+        "    <Value>YES</Value>"
+        "    <Value>NO</Value>"
+        "    <Value>DEFERRED</Value>"
+        "  </Option>"
         "</LayerCreationOptionList>");
 
     // These constants were added in GDAL 3.6+
@@ -245,13 +251,40 @@ void RegisterOGRH2GIS()
     poDriver->SetMetadataItem(GDAL_DCAP_VIRTUALIO, "YES");
     poDriver->SetMetadataItem(GDAL_DMD_CONNECTION_PREFIX, "H2GIS:");
 
-    // Open options for authentication
+    // Open options for authentication and scan tuning
     poDriver->SetMetadataItem(
         GDAL_DMD_OPENOPTIONLIST,
         "<OpenOptionList>"
         "  <Option name='USER' type='string' description='Database username'/>"
         "  <Option name='PASSWORD' type='string' description='Database "
         "password'/>"
+        "  <Option name='PREFETCH' type='boolean' description='Fetch the "
+        "next batch on the worker thread while the current one is decoded' "
+        "default='NO'/>"
+        "  <Option name='BATCH_SIZE' type='string' description='Number of "
+        "rows fetched per batch, or AUTO to size batches by bytes' "
+        "default='1000'/>"
+        "  <Option name='PARALLEL_SCAN' type='int' description='Number of "
+        "_ROWID_ ranges unordered scans are split into, each read on its own "
+        "connection. Needs H2GIS_WORKER_THREADS of 2 or more' default='1' "
+        "min='1' max='64'/>"
+        "  <Option name='METADATA_CACHE' type='boolean' description='Save the "
+        "layer list next to the database and reuse it while the database is "
+        "unchanged' default='NO'/>"
+        "  <Option name='SIMPLIFY_TOLERANCE' type='string' description='"
+        "Tolerance, in layer units, of the simplification of the geometries "
+        "read by scans, or AUTO to derive it from the spatial filter. "
+        "Read-only datasets only'/>"
+        "  <Option name='TILE_CACHE' type='int' description='Memory, in MB, "
+        "of the features each layer caches by spatial tile to serve "
+        "overlapping spatial filters' default='0' min='0'/>"
+        "  <Option name='SPATIAL_FILTER' type='string-select' description='"
+        "Whether spatial filters select the geometries intersecting the "
+        "filter, or those whose bounding box intersects its envelope' "
+        "default='EXACT'>"
+        "    <Value>EXACT</Value>"
+        "    <Value>BBOX</Value>"
+        "  </Option>"
         "</OpenOptionList>");
 
     poDriver->pfnIdentify = OGRH2GISDriverIdentify;
@@ -261,6 +294,11 @@ void RegisterOGRH2GIS()
 
     GetGDALDriverManager()->RegisterDriver(poDriver);
 
+    // H2GIS_EAGER_INIT=YES: create the GraalVM isolate in the background
+    // now, instead of in front of the first Open()
+    if (CPLTestBool(CPLGetConfigOption("H2GIS_EAGER_INIT", "NO")))
+        h2gis_wrapper_init_async();
+
     CPLDebug("H2GIS", "RegisterOGRH2GIS: Driver registered successfully");
 }
 
@@ -2,12 +2,14 @@
 // SPDX-FileCopyrightText: 2024-2026 H2GIS Team
 
 #include "ogr_h2gis.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
 #include <cstring>
 #include <limits>
 #include "cpl_error.h"
-
-// Constants
-static constexpr int H2GIS_BATCH_SIZE = 1000;
+#include "cpl_string.h"
 
 // Standard GDAL logging helper
 static void LogLayer(const char *func, const char *tableName)
@@ -60,10 +62,21 @@ OGRH2GISLayer::OGRH2GISLayer(OGRH2GISDataSource *poDS, const char *pszTableName,
       m_osFIDCol(pszFIDCol ? pszFIDCol : ""), m_nSRID(nSrid), m_nRS(0),
       m_hStmt(0), m_pBatchBuffer(nullptr), m_nBatchBufferSize(0),
       m_nBatchRows(0), m_iNextRowInBatch(0), m_iNextShapeId(0),
-      m_nFeatureCount(nRowCountEstimate),
+      m_nFeatureCount(nRowCountEstimate), m_bFeatureCountExact(false),
       m_bSchemaFetched(
           bSchemaFetched || !columns.empty()),  // Schema is pre-fetched if columns provided or explicitly set
-      m_bResetPending(true)
+      m_bResetPending(true), m_hPrefetch(nullptr),
+      m_oBatchSizer(poDS->GetBatchSize()), m_nRequestedRows(0),
+      m_bKeysetScan(false), m_bQueryOrderedByFID(false), m_nFIDUnique(-1),
+      m_iScanPartition(0),
+      m_nLastGetFeatureFID(OGRNullFID),
+      m_nFIDBurstRows(H2GIS_FID_BURST_MIN_ROWS), m_nTileCacheBytes(0),
+      m_iTileScan(0), m_bTileScan(false), m_nPendingBytes(0),
+      m_nNextFID(0), m_bFIDIdentity(false), m_bPendingKeys(false),
+      m_bDeferredSpatialIndex(false), m_bDeferredTableIndex(false),
+      m_bExtentValid(false),
+      m_bExtentDirty(false), m_bExtentStored(false), m_bArrowFastPath(false),
+      m_bArrowIncludeFID(true), m_nArrowMaxBatchRows(65536)
 {
     SetDescription(m_poFeatureDefn->GetName());
     m_poFeatureDefn->Reference();
@@ -129,7 +142,11 @@ OGRH2GISLayer::OGRH2GISLayer(OGRH2GISDataSource *poDS, const char *pszTableName,
 
 OGRH2GISLayer::~OGRH2GISLayer()
 {
+    FlushPendingInserts();
     ClearStatement();
+    CloseScanStatement();
+    ClearStatementCache();
+    ClearFIDBurstCache();
     if (m_pBatchBuffer)
     {
         graal_isolatethread_t *thread =
@@ -140,20 +157,162 @@ OGRH2GISLayer::~OGRH2GISLayer()
     m_poFeatureDefn->Release();
 }
 
+void OGRH2GISLayer::ClearStatementCache()
+{
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    for (auto &oIter : m_oStmtCache)
+        h2gis_close_query(thread, oIter.second);
+    m_oStmtCache.clear();
+}
+
+void OGRH2GISLayer::ClearFIDBurstCache()
+{
+    for (auto &oIter : m_oFIDBurstCache)
+        delete oIter.second;
+    m_oFIDBurstCache.clear();
+}
+
+void OGRH2GISLayer::InvalidateCachedData()
+{
+    ClearFIDBurstCache();
+    ClearStatementCache();
+    m_oKeysetIndex.clear();
+    m_nNextFID = 0;  // Rows may have been inserted behind the layer
+    m_bFeatureCountExact = false;
+    m_aoFilteredCounts.clear();
+    ClearTileCache();
+    InvalidateCachedExtent();
+}
+
+/**
+ * Account for nDelta rows inserted (or deleted if negative) by the layer, so
+ * that an exact unfiltered count stays exact. Any write also drops the
+ * cached filtered counts and tiles.
+ */
+void OGRH2GISLayer::AdjustFeatureCount(GIntBig nDelta)
+{
+    m_nFeatureCount = std::max<GIntBig>(0, m_nFeatureCount + nDelta);
+    m_aoFilteredCounts.clear();
+    ClearTileCache();
+}
+
+/**
+ * Return a prepared statement for osSQL, preparing it on first use.
+ *
+ * Statements stay open until the layer is destroyed, so that repeated
+ * GetFeature() and ICreateFeature() calls only bind and execute. The cache
+ * holds at most H2GIS_STMT_CACHE_SIZE query shapes (select list x lookup
+ * kind, INSERT column lists).
+ */
+long long OGRH2GISLayer::GetCachedStatement(const std::string &osSQL)
+{
+    auto oIter = m_oStmtCache.find(osSQL);
+    if (oIter != m_oStmtCache.end())
+        return oIter->second;
+
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    if (m_oStmtCache.size() >= H2GIS_STMT_CACHE_SIZE)
+        ClearStatementCache();
+
+    long long stmt =
+        h2gis_prepare(thread, m_poDS->GetConnection(), (char *)osSQL.c_str());
+    if (stmt)
+        m_oStmtCache[osSQL] = stmt;
+    return stmt;
+}
+
 void OGRH2GISLayer::ClearStatement()
 {
     graal_isolatethread_t *thread =
         (graal_isolatethread_t *)m_poDS->GetThread();
+    if (m_hPrefetch)
+    {
+        // Collect the in-flight batch before its result set is closed
+        void *pBuffer = h2gis_fetch_batch_wait(m_hPrefetch, nullptr);
+        m_hPrefetch = nullptr;
+        if (pBuffer)
+            h2gis_free_result_buffer(thread, pBuffer);
+    }
     if (m_nRS)
     {
         h2gis_close_query(thread, m_nRS);
         m_nRS = 0;
     }
+    for (H2GISScanPartition &oPartition : m_aoScanPartitions)
+        ClosePartition(oPartition);
+    m_aoScanPartitions.clear();
+    m_iScanPartition = 0;
+}
+
+/**
+ * Close the prepared statement of the scans. PrepareQuery() keeps it while
+ * the scans run the same SQL, i.e. under the same filters and projection
+ * whatever the position of the spatial filter.
+ */
+void OGRH2GISLayer::CloseScanStatement()
+{
     if (m_hStmt)
     {
+        graal_isolatethread_t *thread =
+            (graal_isolatethread_t *)m_poDS->GetThread();
         h2gis_close_query(thread, m_hStmt);
         m_hStmt = 0;
     }
+    m_osScanSQL.clear();
+}
+
+/**
+ * Build the WHERE predicate of the spatial filter, and its geometry in
+ * m_abyFilterEWKB, to be bound by BindSpatialFilter().
+ *
+ * The geometry is a parameter so that the SQL text, and the plan H2 caches
+ * for it, does not change as the filter moves. The && operator selects the
+ * rows through the spatial index, then ST_Intersects() tests them against
+ * the filter geometry itself. With SPATIAL_FILTER=BBOX only the && test is
+ * made, against the filter envelope, which OGR allows: every feature whose
+ * envelope intersects the filter envelope is returned.
+ *
+ * @return the predicate, or an empty string without spatial filter.
+ */
+std::string OGRH2GISLayer::BuildSpatialFilterClause()
+{
+    m_abyFilterEWKB.clear();
+    if (m_poFilterGeom == nullptr || m_osGeomCol.empty())
+        return std::string();
+
+    const bool bBBox = m_poDS->IsSpatialFilterBBox();
+    const int nSRID = m_nSRID > 0 ? m_nSRID : 0;
+    if (bBBox || !H2GISExportToEWKB(m_poFilterGeom, nSRID, m_abyFilterEWKB))
+    {
+        OGREnvelope env;
+        m_poFilterGeom->getEnvelope(&env);
+        H2GISExportEnvelopeToEWKB(env, nSRID, m_abyFilterEWKB);
+    }
+
+    const std::string osGeomCol = "\"" + m_osGeomCol + "\"";
+    std::string osClause = osGeomCol + " && CAST(? AS GEOMETRY)";
+    if (!bBBox)
+        osClause +=
+            " AND ST_Intersects(" + osGeomCol + ", CAST(? AS GEOMETRY))";
+    return osClause;
+}
+
+/**
+ * Bind the spatial filter geometry to the parameters of the predicate of
+ * BuildSpatialFilterClause(), which come first in the queries.
+ */
+void OGRH2GISLayer::BindSpatialFilter(long long hStmt)
+{
+    if (m_abyFilterEWKB.empty())
+        return;
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    const int nParams = m_poDS->IsSpatialFilterBBox() ? 1 : 2;
+    for (int nParam = 1; nParam <= nParams; nParam++)
+        h2gis_bind_blob(thread, hStmt, nParam, (char *)m_abyFilterEWKB.data(),
+                        static_cast<int>(m_abyFilterEWKB.size()));
 }
 
 void OGRH2GISLayer::FetchSchema()
@@ -172,19 +331,9 @@ void OGRH2GISLayer::FetchSchema()
 
     // Use table name for SQL queries (not layer name which may be TABLE.GEOM_COL)
     std::string sql = "SELECT * FROM \"" + m_osTableName + "\" LIMIT 0";
-    long long stmt = h2gis_prepare(thread, conn, (char *)sql.c_str());
-    if (!stmt)
-        return;
-
-    long long rs = h2gis_execute_prepared(thread, stmt);
-    if (!rs)
-    {
-        h2gis_close_query(thread, stmt);
-        return;
-    }
-
     long long sizeOut = 0;
-    void *buf = h2gis_fetch_one(thread, rs, &sizeOut);
+    void *buf = h2gis_query_first_row(thread, conn, (char *)sql.c_str(),
+                                      nullptr, 0, &sizeOut);
 
     if (buf && sizeOut > 0)
     {
@@ -260,12 +409,9 @@ void OGRH2GISLayer::FetchSchema()
                 m_poFeatureDefn->AddFieldDefn(&oField);
             }
         }
-        h2gis_free_result_buffer(thread, buf);
     }
-
-    // Close FetchSchema handles immediately
-    h2gis_close_query(thread, rs);
-    h2gis_close_query(thread, stmt);
+    if (buf)
+        h2gis_free_result_buffer(thread, buf);
 
     // Apply cached SRID
     if (m_poFeatureDefn->GetGeomFieldCount() > 0 && m_nSRID > 0)
@@ -291,54 +437,130 @@ void OGRH2GISLayer::ResetReading()
 {
     // Lazy reset - don't prepare query until first GetNextFeature
     // This avoids expensive SQL queries when QGIS just lists layers
+    FlushPendingInserts();
     ClearStatement();
     m_iNextShapeId = 0;
     m_nBatchRows = 0;
     m_iNextRowInBatch = 0;
+    m_bTileScan = false;
+    m_apoTileScan.clear();
     m_bResetPending = true;  // Mark that we need to prepare on first read
 }
 
+/**
+ * Build the explicit SELECT column list for this layer.
+ *
+ * The list is the FID column (or _ROWID_), then every attribute field not
+ * flagged as ignored, in layer definition order, then the layer geometry
+ * column unless the geometry is ignored. Ignored columns are therefore never
+ * serialized by H2GIS nor copied over the isolate boundary, and a layer built
+ * on one geometry column of a multi-geometry table only receives that one.
+ *
+ * @param panColumnFieldIndex Output (optional): target of each selected
+ *        column, an OGR field index or H2GIS_COL_FID / H2GIS_COL_GEOM.
+ * @param dfSimplifyTolerance If positive, the geometry is selected through
+ *        ST_SimplifyPreserveTopology() with this tolerance.
+ */
+std::string
+OGRH2GISLayer::BuildSelectColumns(std::vector<int> *panColumnFieldIndex,
+                                  double dfSimplifyTolerance)
+{
+    std::string osColumns =
+        m_osFIDCol.empty() ? "_ROWID_" : ("\"" + m_osFIDCol + "\"");
+    if (panColumnFieldIndex)
+    {
+        panColumnFieldIndex->clear();
+        panColumnFieldIndex->push_back(H2GIS_COL_FID);
+    }
+
+    for (int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++)
+    {
+        OGRFieldDefn *poFieldDefn = m_poFeatureDefn->GetFieldDefn(i);
+        if (poFieldDefn->IsIgnored())
+            continue;
+        osColumns += ", \"";
+        osColumns += poFieldDefn->GetNameRef();
+        osColumns += "\"";
+        if (panColumnFieldIndex)
+            panColumnFieldIndex->push_back(i);
+    }
+
+    if (m_poFeatureDefn->GetGeomFieldCount() > 0 &&
+        !m_poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored())
+    {
+        const std::string osGeom =
+            std::string("\"") +
+            m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef() + "\"";
+        if (dfSimplifyTolerance > 0)
+            osColumns += CPLSPrintf(", ST_SimplifyPreserveTopology(%s, %.15g)",
+                                    osGeom.c_str(), dfSimplifyTolerance);
+        else
+            osColumns += ", " + osGeom;
+        if (panColumnFieldIndex)
+            panColumnFieldIndex->push_back(H2GIS_COL_GEOM);
+    }
+    return osColumns;
+}
+
+/**
+ * Tolerance of the simplification of the geometries read by scans
+ * (SIMPLIFY_TOLERANCE open option): the fixed one, or with AUTO a fraction
+ * of the spatial filter envelope, so that a view of the whole layer gets
+ * coarse geometries and a zoomed in one nearly exact ones.
+ *
+ * @return the tolerance, 0 to read the geometries as they are.
+ */
+double OGRH2GISLayer::GetSimplifyTolerance() const
+{
+    // Nothing to simplify in points
+    const OGRwkbGeometryType eFlatType =
+        wkbFlatten(m_poFeatureDefn->GetGeomType());
+    if (m_osGeomCol.empty() || eFlatType == wkbPoint ||
+        eFlatType == wkbMultiPoint)
+        return 0;
+
+    if (!m_poDS->IsSimplifyAuto())
+        return m_poDS->GetSimplifyTolerance();
+    if (m_poFilterGeom == nullptr)
+        return 0;
+    OGREnvelope env;
+    m_poFilterGeom->getEnvelope(&env);
+    return std::max(env.MaxX - env.MinX, env.MaxY - env.MinY) /
+           H2GIS_SIMPLIFY_AUTO_CELLS;
+}
+
 void OGRH2GISLayer::PrepareQuery()
 {
     if (!m_bResetPending)
         return;
     m_bResetPending = false;
+    FlushPendingInserts();
+    BuildDeferredSpatialIndex();
 
     // Ensure schema is loaded before building query (needed for geometry column name)
     EnsureSchema();
 
     LogLayer("PrepareQuery", m_poFeatureDefn->GetName());
 
+    if (PrepareTileScan())
+        return;
+
     // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
-    std::string sql;
-    if (!m_osFIDCol.empty())
-    {
-        sql = "SELECT * FROM \"" + m_osTableName + "\"";
-    }
-    else
-    {
-        sql = "SELECT _ROWID_, * FROM \"" + m_osTableName + "\"";
-    }
+    // Only the FID, non-ignored fields and the layer geometry are selected
+    m_aoDecodePlan.clear();  // Rebuilt from the first batch of the query
+    std::string sql = "SELECT " +
+                      BuildSelectColumns(&m_anColumnFieldIndex,
+                                         GetSimplifyTolerance()) +
+                      " FROM \"" + m_osTableName + "\"";
 
     // Build WHERE clause combining spatial and attribute filters
     bool bHasWhere = false;
 
-    // Spatial filter (critical for large tables!)
-    // Use m_osGeomCol directly - it's set from GEOMETRY_COLUMNS in constructor
-    if (m_poFilterGeom != nullptr && !m_osGeomCol.empty())
+    // Spatial filter (critical for large tables!), bound as a parameter
+    const std::string osSpatialFilter = BuildSpatialFilterClause();
+    if (!osSpatialFilter.empty())
     {
-        OGREnvelope env;
-        m_poFilterGeom->getEnvelope(&env);
-
-        // Use && operator (spatial index) AND ST_Intersects (exact check)
-        // H2GIS docs state ST_Intersects doesn't always use the index, but && does.
-        // Use CPLSPrintf for locale-independent decimal formatting (dot, not comma)
-        std::string sEnv = CPLSPrintf("ST_MakeEnvelope(%.15g, %.15g, %.15g, %.15g, %d)",
-                                      env.MinX, env.MinY, env.MaxX, env.MaxY,
-                                      m_nSRID > 0 ? m_nSRID : 0);
-
-        sql += " WHERE \"" + m_osGeomCol + "\" && " + sEnv +
-               " AND ST_Intersects(\"" + m_osGeomCol + "\", " + sEnv + ")";
+        sql += " WHERE " + osSpatialFilter;
         bHasWhere = true;
 
         LogLayer("PrepareQuery with spatial index (&&) + filter",
@@ -354,7 +576,8 @@ void OGRH2GISLayer::PrepareQuery()
         }
         else
         {
-            sql += " WHERE " + m_osAttributeFilter;
+            // Parenthesized, as range predicates may be ANDed to it
+            sql += " WHERE (" + m_osAttributeFilter + ")";
             bHasWhere = true;
         }
         LogLayer("PrepareQuery with attribute filter",
@@ -371,356 +594,842 @@ void OGRH2GISLayer::PrepareQuery()
         LogLayer("PrepareQuery without filters", m_poFeatureDefn->GetName());
     }
 
+    // Keyset pagination: once SetNextByIndex() has been used, unfiltered
+    // (spatially) scans are ordered by FID, so that the FID of the first row
+    // of each batch can be recorded and later seeks start from the nearest
+    // recorded boundary instead of making H2 skip m_iNextShapeId rows.
+    m_bQueryOrderedByFID = m_bKeysetScan && m_poFilterGeom == nullptr;
+
+    // PARALLEL_SCAN=N: scans that need no particular order nor any skipped
+    // rows are split in _ROWID_ ranges read concurrently. Other connections
+    // cannot see uncommitted rows, hence not within a transaction.
+    if (m_poDS->GetParallelScan() > 1 && !m_bQueryOrderedByFID &&
+        m_iNextShapeId == 0 && !m_poDS->IsInTransaction() &&
+        StartParallelScan(sql, bHasWhere))
+    {
+        return;
+    }
+
+    GIntBig nOffset = m_iNextShapeId;
+    if (m_bQueryOrderedByFID)
+    {
+        const std::string osFIDCol =
+            m_osFIDCol.empty() ? "_ROWID_" : ("\"" + m_osFIDCol + "\"");
+        auto oIter = m_oKeysetIndex.upper_bound(m_iNextShapeId);
+        if (m_iNextShapeId > 0 && oIter != m_oKeysetIndex.begin())
+        {
+            --oIter;
+            sql += (bHasWhere ? " AND " : " WHERE ") + osFIDCol +
+                   " >= " + std::to_string(oIter->second);
+            nOffset = m_iNextShapeId - oIter->first;
+            LogLayer("PrepareQuery with keyset seek",
+                     std::to_string(oIter->second).c_str());
+        }
+        sql += " ORDER BY " + osFIDCol;
+    }
+
     // Add OFFSET for SetNextByIndex support
-    if (m_iNextShapeId > 0)
+    if (nOffset > 0)
     {
-        sql += " OFFSET " + std::to_string(m_iNextShapeId);
-        LogLayer("PrepareQuery with OFFSET", std::to_string(m_iNextShapeId).c_str());
+        sql += " OFFSET " + std::to_string(nOffset);
+        LogLayer("PrepareQuery with OFFSET", std::to_string(nOffset).c_str());
     }
 
     graal_isolatethread_t *thread =
         (graal_isolatethread_t *)m_poDS->GetThread();
     long long conn = m_poDS->GetConnection();
 
-    m_hStmt = h2gis_prepare(thread, conn, (char *)sql.c_str());
+    // The statement of the previous scan is reused for the same SQL
+    if (sql != m_osScanSQL)
+    {
+        CloseScanStatement();
+        m_hStmt = h2gis_prepare(thread, conn, (char *)sql.c_str());
+        if (m_hStmt)
+            m_osScanSQL = sql;
+    }
     if (m_hStmt)
     {
+        BindSpatialFilter(m_hStmt);
         m_nRS = h2gis_execute_prepared(thread, m_hStmt);
         if (!m_nRS)
         {
             // Execute failed - close the prepared statement to avoid leak
-            h2gis_close_query(thread, m_hStmt);
-            m_hStmt = 0;
+            CloseScanStatement();
         }
+        else
+            CountQuery();
     }
 }
 
-bool OGRH2GISLayer::FetchNextBatch()
+/**
+ * TILE_CACHE open option: serve a spatially filtered scan from the tiles of
+ * the layer cache, reading the missing ones first.
+ *
+ * The filter envelope is covered by at most 3 x 3 tiles of a power of two
+ * grid (see H2GISTile). Each tile holds the features whose bounding box
+ * intersects it, as selected by the && operator, so that the features of
+ * the scan are those of its tiles that pass the test of the SQL query (see
+ * BuildSpatialFilterClause). Missing tiles are read by one query over their
+ * union.
+ *
+ * Tiles are kept for the current select list and attribute filter only, up
+ * to the memory budget of the option, and are dropped by any write to the
+ * layer. They are not used for simplified geometries, nor after
+ * SetNextByIndex().
+ *
+ * @return true if the scan is served from m_apoTileScan.
+ */
+bool OGRH2GISLayer::PrepareTileScan()
 {
-    if (!m_nRS)
+    m_bTileScan = false;
+    m_apoTileScan.clear();
+    m_iTileScan = 0;
+
+    const size_t nBudget = m_poDS->GetTileCacheBytes();
+    if (nBudget == 0 || m_poFilterGeom == nullptr || m_osGeomCol.empty() ||
+        m_poFeatureDefn->GetGeomFieldCount() == 0 ||
+        m_poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored() ||
+        m_iNextShapeId > 0 || GetSimplifyTolerance() > 0)
         return false;
 
-    graal_isolatethread_t *thread =
-        (graal_isolatethread_t *)m_poDS->GetThread();
+    OGREnvelope oFilterEnv;
+    m_poFilterGeom->getEnvelope(&oFilterEnv);
+    const double dfWidth = std::max(oFilterEnv.MaxX - oFilterEnv.MinX,
+                                    oFilterEnv.MaxY - oFilterEnv.MinY);
+    if (!(dfWidth > 0) || !std::isfinite(dfWidth))
+        return false;
+    int nExponent = 0;
+    std::frexp(dfWidth, &nExponent);
+    const int nLevel = nExponent - 1;  // 2^nLevel <= dfWidth < 2^(nLevel+1)
+    const double dfTileSize = std::ldexp(1.0, nLevel);
+
+    // Tile indexes must stay exact in a double
+    const double dfLimit = 1e15;
+    const double dfMinX = std::floor(oFilterEnv.MinX / dfTileSize);
+    const double dfMinY = std::floor(oFilterEnv.MinY / dfTileSize);
+    const double dfMaxX = std::floor(oFilterEnv.MaxX / dfTileSize);
+    const double dfMaxY = std::floor(oFilterEnv.MaxY / dfTileSize);
+    if (!(std::fabs(dfMinX) < dfLimit && std::fabs(dfMinY) < dfLimit &&
+          std::fabs(dfMaxX) < dfLimit && std::fabs(dfMaxY) < dfLimit))
+        return false;
+    const GIntBig nMinX = static_cast<GIntBig>(dfMinX);
+    const GIntBig nMinY = static_cast<GIntBig>(dfMinY);
+    const GIntBig nMaxX = static_cast<GIntBig>(dfMaxX);
+    const GIntBig nMaxY = static_cast<GIntBig>(dfMaxY);
 
-    if (m_pBatchBuffer)
+    // Tiles read with another select list or attribute filter are stale
+    std::vector<int> anColumnFieldIndex;
+    const std::string osColumns = BuildSelectColumns(&anColumnFieldIndex);
+    const std::string osKey = osColumns + '\n' + m_osAttributeFilter;
+    if (osKey != m_osTileCacheKey)
     {
-        h2gis_free_result_buffer(thread, m_pBatchBuffer);
-        m_pBatchBuffer = nullptr;
+        ClearTileCache();
+        m_osTileCacheKey = osKey;
     }
 
-    long long sizeOut = 0;
-    m_pBatchBuffer = h2gis_fetch_batch(thread, m_nRS, 1000, &sizeOut);
+    std::vector<H2GISTile> aoMissing;
+    OGREnvelope oMissingEnv;
+    for (GIntBig nY = nMinY; nY <= nMaxY; nY++)
+    {
+        for (GIntBig nX = nMinX; nX <= nMaxX; nX++)
+        {
+            if (TouchTile(nLevel, nX, nY))
+                continue;
+            H2GISTile oTile;
+            oTile.nLevel = nLevel;
+            oTile.nX = nX;
+            oTile.nY = nY;
+            OGREnvelope oTileEnv;
+            oTile.GetEnvelope(oTileEnv);
+            oMissingEnv.Merge(oTileEnv);
+            aoMissing.push_back(std::move(oTile));
+        }
+    }
+    if (!aoMissing.empty())
+    {
+        if (!FillTiles(aoMissing, oMissingEnv, osColumns, anColumnFieldIndex))
+            return false;
+        for (H2GISTile &oTile : aoMissing)
+        {
+            m_nTileCacheBytes += oTile.nBytes;
+            m_aoTileCache.push_back(std::move(oTile));
+        }
+    }
+
+    // Features of the tiles intersecting the filter, once each, in FID
+    // order, selected like BuildSpatialFilterClause() does
+    const bool bBBox = m_poDS->IsSpatialFilterBBox();
+    std::map<GIntBig, std::shared_ptr<OGRFeature>> oScan;
+    for (GIntBig nY = nMinY; nY <= nMaxY; nY++)
+    {
+        for (GIntBig nX = nMinX; nX <= nMaxX; nX++)
+        {
+            const H2GISTile *poTile = TouchTile(nLevel, nX, nY);
+            if (!poTile)
+                continue;
+            for (const auto &poFeature : poTile->apoFeatures)
+            {
+                if (oScan.count(poFeature->GetFID()))
+                    continue;
+                const OGRGeometry *poGeom = poFeature->GetGeometryRef();
+                OGREnvelope oEnv;
+                poGeom->getEnvelope(&oEnv);
+                if (oEnv.Intersects(oFilterEnv) &&
+                    (bBBox || poGeom->Intersects(m_poFilterGeom)))
+                    oScan.emplace(poFeature->GetFID(), poFeature);
+            }
+        }
+    }
+    m_apoTileScan.reserve(oScan.size());
+    for (auto &oIter : oScan)
+        m_apoTileScan.push_back(std::move(oIter.second));
 
-    if (!m_pBatchBuffer || sizeOut <= 0)
+    // The scan holds its own references: evict down to the budget now
+    while (m_nTileCacheBytes > nBudget && !m_aoTileCache.empty())
     {
+        m_nTileCacheBytes -= m_aoTileCache.front().nBytes;
+        m_aoTileCache.erase(m_aoTileCache.begin());
+    }
+
+    LogLayer(aoMissing.empty() ? "PrepareQuery from cached tiles"
+                               : "PrepareQuery from read tiles",
+             std::to_string(m_apoTileScan.size()).c_str());
+    m_bTileScan = true;
+    return true;
+}
+
+/**
+ * Read the features of the tiles aoTiles, whose union is oEnv, with one
+ * query selecting osColumns.
+ *
+ * @return false if the query failed or its rows exceed the budget of the
+ *         tile cache, in which case the scan falls back to the SQL query.
+ */
+bool OGRH2GISLayer::FillTiles(std::vector<H2GISTile> &aoTiles,
+                              const OGREnvelope &oEnv,
+                              const std::string &osColumns,
+                              const std::vector<int> &anColumnFieldIndex)
+{
+    // The union is bound exactly, as features touching a tile border
+    // belong to it
+    std::string osSQL = "SELECT " + osColumns + " FROM \"" + m_osTableName +
+                        "\" WHERE \"" + m_osGeomCol +
+                        "\" && CAST(? AS GEOMETRY)";
+    if (!m_osAttributeFilter.empty())
+        osSQL += " AND (" + m_osAttributeFilter + ")";
+    std::vector<uint8_t> abyEWKB;
+    H2GISExportEnvelopeToEWKB(oEnv, m_nSRID > 0 ? m_nSRID : 0, abyEWKB);
+
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    const long long hStmt = GetCachedStatement(osSQL);
+    if (!hStmt)
+        return false;
+    h2gis_bind_blob(thread, hStmt, 1, (char *)abyEWKB.data(),
+                    static_cast<int>(abyEWKB.size()));
+    long long hRS = h2gis_execute_prepared(thread, hStmt);
+    if (!hRS)
+        return false;
+    CountQuery();
+
+    std::vector<OGREnvelope> aoTileEnvs(aoTiles.size());
+    for (size_t i = 0; i < aoTiles.size(); i++)
+        aoTiles[i].GetEnvelope(aoTileEnvs[i]);
+
+    const size_t nBudget = m_poDS->GetTileCacheBytes();
+    size_t nTotalBytes = 0;
+    std::vector<uint8_t *> apCursors;
+    std::vector<int> anTypes;
+    std::vector<H2GISDecodeStep> aoPlan;
+    bool bOK = true;
+    while (true)
+    {
+        const int nRequestedRows = m_oBatchSizer.GetRows();
+        long long nSize = 0;
+        const auto oFetchStart = std::chrono::steady_clock::now();
+        void *pBuffer = h2gis_fetch_batch(thread, hRS, nRequestedRows, &nSize);
+        const GIntBig nWaitUs = H2GISElapsedUs(oFetchStart);
+        const int nRows =
+            pBuffer && nSize > 0
+                ? H2GISParseBatchBuffer(pBuffer, apCursors, anTypes)
+                : 0;
+        CountBatch(nRows, nSize, nWaitUs);
+        nTotalBytes += static_cast<size_t>(std::max(0LL, nSize));
+        if (nRows > 0 && nTotalBytes <= nBudget)
+        {
+            if (aoPlan.empty())
+                H2GISBuildDecodePlan(m_poFeatureDefn, anTypes,
+                                     anColumnFieldIndex, aoPlan);
+            const size_t nRowBytes =
+                static_cast<size_t>(nSize / nRows) + sizeof(OGRFeature);
+            for (int iRow = 0; iRow < nRows; iRow++)
+            {
+                std::shared_ptr<OGRFeature> poFeature(
+                    H2GISDecodeRow(m_poFeatureDefn, aoPlan, apCursors));
+                const OGRGeometry *poGeom = poFeature->GetGeometryRef();
+                if (poGeom == nullptr || poGeom->IsEmpty() ||
+                    poFeature->GetFID() == OGRNullFID)
+                    continue;
+                OGREnvelope oFeatureEnv;
+                poGeom->getEnvelope(&oFeatureEnv);
+                for (size_t i = 0; i < aoTiles.size(); i++)
+                {
+                    if (!aoTileEnvs[i].Intersects(oFeatureEnv))
+                        continue;
+                    aoTiles[i].apoFeatures.push_back(poFeature);
+                    aoTiles[i].nBytes += nRowBytes;
+                }
+            }
+            m_oBatchSizer.Update(nRows, nSize);
+        }
+        if (pBuffer)
+            h2gis_release_result_buffer(thread, pBuffer);
+
+        if (nTotalBytes > nBudget)
+        {
+            CPLDebug("H2GIS",
+                     "Tiles of %s exceed TILE_CACHE, reading them directly",
+                     m_poFeatureDefn->GetName());
+            bOK = false;
+            break;
+        }
+        if (nRows < nRequestedRows)
+            break;
+    }
+    h2gis_close_query(thread, hRS);
+    if (!bOK)
         return false;
+
+    for (H2GISTile &oTile : aoTiles)
+        oTile.nBytes += sizeof(H2GISTile);
+    return true;
+}
+
+/**
+ * Look up a tile of the cache, and make it the most recently used one.
+ *
+ * @return the tile, valid until the cache is modified, or nullptr.
+ */
+H2GISTile *OGRH2GISLayer::TouchTile(int nLevel, GIntBig nX, GIntBig nY)
+{
+    for (auto oIter = m_aoTileCache.begin(); oIter != m_aoTileCache.end();
+         ++oIter)
+    {
+        if (oIter->nLevel == nLevel && oIter->nX == nX && oIter->nY == nY)
+        {
+            std::rotate(oIter, oIter + 1, m_aoTileCache.end());
+            return &m_aoTileCache.back();
+        }
     }
+    return nullptr;
+}
+
+void OGRH2GISLayer::ClearTileCache()
+{
+    // A scan in progress keeps its own references to the features
+    m_aoTileCache.clear();
+    m_nTileCacheBytes = 0;
+}
+
+/**
+ * Count a read query, or a fetched batch and the time spent waiting for it,
+ * in the statistics of the layer and of its datasource.
+ */
+void OGRH2GISLayer::CountQuery()
+{
+    m_oStats.nQueries++;
+    m_poDS->GetStats().nQueries++;
+}
+
+void OGRH2GISLayer::CountBatch(int nRows, long long nBytes, GIntBig nWaitUs)
+{
+    m_oStats.AddBatch(nRows, nBytes, nWaitUs);
+    m_poDS->GetStats().AddBatch(nRows, nBytes, nWaitUs);
+}
 
-    uint8_t *ptr = (uint8_t *)m_pBatchBuffer;
+/**
+ * Set up one cursor per column over a buffer returned by h2gis_fetch_batch().
+ *
+ * Layout: [colCount 4][rowCount 4][offset 8 x colCount], then per column
+ * [nameLen 4][name][type 4][totalDataLen 4] followed by the values of all
+ * rows. Each cursor points to the first value of its column.
+ *
+ * @return the number of rows of the batch (0 if empty or invalid).
+ */
+int H2GISParseBatchBuffer(void *pBuffer, std::vector<uint8_t *> &apCursors,
+                          std::vector<int> &anTypes)
+{
+    uint8_t *ptr = (uint8_t *)pBuffer;
     int32_t colCount;
     memcpy(&colCount, ptr, 4);
     ptr += 4;
-    memcpy(&m_nBatchRows, ptr, 4);
+    int32_t rowCount;
+    memcpy(&rowCount, ptr, 4);
     ptr += 4;
 
-    if (m_nBatchRows <= 0)
-        return false;
-
-    std::vector<int64_t> offsets(colCount);
-    for (int i = 0; i < colCount; i++)
-    {
-        memcpy(&offsets[i], ptr, 8);
-        ptr += 8;
-    }
+    if (rowCount <= 0 || colCount <= 0)
+        return 0;
 
-    m_columnValues.resize(colCount);
-    m_columnTypes.resize(colCount);
-    m_columnNames.resize(colCount);
+    apCursors.resize(colCount);
+    anTypes.resize(colCount);
 
-    uint8_t *base = (uint8_t *)m_pBatchBuffer;
+    uint8_t *base = (uint8_t *)pBuffer;
 
     for (int i = 0; i < colCount; i++)
     {
-        uint8_t *colPtr = base + offsets[i];
+        int64_t offset;
+        memcpy(&offset, ptr, 8);
+        ptr += 8;
+        uint8_t *colPtr = base + offset;
 
+        // Columns are told apart by position (see H2GISBuildDecodePlan)
         int32_t nameLen;
         memcpy(&nameLen, colPtr, 4);
-        colPtr += 4;
-        std::string colName((char *)colPtr, nameLen);
-        colPtr += nameLen;
+        colPtr += 4 + nameLen;
 
         int32_t type;
         memcpy(&type, colPtr, 4);
         colPtr += 4;
 
-        int32_t totalDataLen;
-        memcpy(&totalDataLen, colPtr, 4);
+        // Skip totalDataLen
         colPtr += 4;
 
-        m_columnValues[i] = colPtr;
-        m_columnTypes[i] = type;
-        m_columnNames[i] = colName;
+        apCursors[i] = colPtr;
+        anTypes[i] = type;
     }
-
-    m_iNextRowInBatch = 0;
-    return true;
+    return rowCount;
 }
 
-OGRFeature *OGRH2GISLayer::GetNextFeature()
+bool OGRH2GISLayer::FetchNextBatch()
 {
-    // EnsureSchema(); // Already done
+    if (!m_aoScanPartitions.empty())
+        return FetchNextPartitionBatch();
+    if (!m_nRS)
+        return false;
 
-    // Lazy preparation
-    if (m_bResetPending)
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+
+    // Freed by the worker ahead of the fetch below, or of the next prefetch,
+    // instead of in a task of its own
+    if (m_pBatchBuffer)
     {
-        EnsureSchema();
-        PrepareQuery();
+        h2gis_release_result_buffer(thread, m_pBatchBuffer);
+        m_pBatchBuffer = nullptr;
     }
 
-    if (!m_nRS)
-        ResetReading();
-
-    if (m_iNextRowInBatch >= m_nBatchRows)
+    long long sizeOut = 0;
+    void *pBuffer = nullptr;
+    const auto oFetchStart = std::chrono::steady_clock::now();
+    if (m_hPrefetch)
     {
-        if (!FetchNextBatch())
-            return nullptr;
+        // Requested while the caller was decoding the previous batch
+        pBuffer = h2gis_fetch_batch_wait(m_hPrefetch, &sizeOut);
+        m_hPrefetch = nullptr;
+    }
+    else
+    {
+        m_nRequestedRows = m_oBatchSizer.GetRows();
+        pBuffer = h2gis_fetch_batch(thread, m_nRS, m_nRequestedRows, &sizeOut);
     }
+    const GIntBig nWaitUs = H2GISElapsedUs(oFetchStart);
+    m_pBatchBuffer = pBuffer;
 
-    OGRFeature *poFeature = new OGRFeature(m_poFeatureDefn);
+    m_nBatchRows = m_pBatchBuffer && sizeOut > 0
+                       ? H2GISParseBatchBuffer(m_pBatchBuffer, m_columnValues,
+                                               m_columnTypes)
+                       : 0;
+    CountBatch(m_nBatchRows, sizeOut, nWaitUs);
+    if (m_nBatchRows <= 0)
+        return false;
+    if (m_aoDecodePlan.empty())
+        H2GISBuildDecodePlan(m_poFeatureDefn, m_columnTypes,
+                             m_anColumnFieldIndex, m_aoDecodePlan);
 
-    int iField = 0;
-    int iGeom = 0;
-    bool fidSet = false;
+    const bool bExhausted = m_nBatchRows < m_nRequestedRows;
+    m_oBatchSizer.Update(m_nBatchRows, sizeOut);
 
-    for (size_t iCol = 0; iCol < m_columnValues.size(); iCol++)
+    // PREFETCH=YES: queue batch N+1 now, so that the worker serializes it
+    // while this batch is decoded. A short batch means the result set is
+    // exhausted, so there is nothing left to ask for.
+    if (m_poDS->IsPrefetchEnabled() && !bExhausted)
     {
-        int type = m_columnTypes[iCol];
-        uint8_t *&ptr = m_columnValues[iCol];
-        const std::string &colName = m_columnNames[iCol];
+        m_nRequestedRows = m_oBatchSizer.GetRows();
+        m_hPrefetch =
+            h2gis_fetch_batch_async(thread, m_nRS, m_nRequestedRows);
+    }
 
-        // Use configured FID column when available; otherwise use _ROWID_
-        if (!m_osFIDCol.empty() && EQUAL(colName.c_str(), m_osFIDCol.c_str()))
+    // Remember where this batch starts, for keyset seeks (see PrepareQuery)
+    if (m_bQueryOrderedByFID && !m_columnValues.empty() &&
+        !m_anColumnFieldIndex.empty() &&
+        m_anColumnFieldIndex[0] == H2GIS_COL_FID)
+    {
+        if (m_columnTypes[0] == H2GIS_TYPE_LONG)
         {
-            if (type == H2GIS_TYPE_LONG)
-            {
-                int64_t rowid;
-                memcpy(&rowid, ptr, 8);
-                ptr += 8;
-                poFeature->SetFID(rowid);
-                fidSet = true;
-                continue;
-            }
-            else if (type == H2GIS_TYPE_INT)
-            {
-                int32_t rowid;
-                memcpy(&rowid, ptr, 4);
-                ptr += 4;
-                poFeature->SetFID(rowid);
-                fidSet = true;
-                continue;
-            }
+            int64_t nFID;
+            memcpy(&nFID, m_columnValues[0], 8);
+            m_oKeysetIndex[m_iNextShapeId] = nFID;
         }
-
-        if (m_osFIDCol.empty() && iCol == 0 && type == H2GIS_TYPE_LONG)
+        else if (m_columnTypes[0] == H2GIS_TYPE_INT)
         {
-            int64_t rowid;
-            memcpy(&rowid, ptr, 8);
-            ptr += 8;
-            poFeature->SetFID(rowid);
-            fidSet = true;
-            continue;
+            int32_t nFID;
+            memcpy(&nFID, m_columnValues[0], 4);
+            m_oKeysetIndex[m_iNextShapeId] = nFID;
         }
+    }
 
-        if (type == H2GIS_TYPE_GEOM)
-        {
-            int32_t len;
-            memcpy(&len, ptr, 4);
-            ptr += 4;
-
-            if (len > 0)
-            {
-                OGRGeometry *poGeom = nullptr;
-
-                // H2GIS sends EWKB (Extended WKB) with SRID embedded.
-                // Format: [byte order 1][type 4 with SRID flag][SRID 4][geometry data]
-                // We need to convert EWKB to WKB by removing SRID and clearing the flag.
+    m_iNextRowInBatch = 0;
+    return true;
+}
 
-                // Check if SRID flag is set in type (offset 1-4 after byte order)
-                uint8_t byteOrder = ptr[0];
-                uint32_t wkbType;
-                if (byteOrder == 1)
-                {
-                    // Little endian
-                    memcpy(&wkbType, ptr + 1, 4);
-                }
-                else
-                {
-                    // Big endian - swap bytes
-                    wkbType = ((uint32_t)ptr[1] << 24) |
-                              ((uint32_t)ptr[2] << 16) |
-                              ((uint32_t)ptr[3] << 8) | (uint32_t)ptr[4];
-                }
-
-                const uint32_t SRID_FLAG = 0x20000000;
-
-                if (wkbType & SRID_FLAG)
-                {
-                    // EWKB with SRID - convert to standard WKB
-                    // New buffer: [byte order 1][type 4 without SRID flag][geometry data]
-                    // Skip original SRID bytes (4 bytes after type)
-                    int newLen = len - 4;  // 4 bytes less (remove SRID)
-                    std::vector<uint8_t> wkbBuf(newLen);
-
-                    // Copy byte order
-                    wkbBuf[0] = ptr[0];
-
-                    // Copy type without SRID flag
-                    uint32_t newType = wkbType & ~SRID_FLAG;
-                    if (byteOrder == 1)
-                    {
-                        memcpy(&wkbBuf[1], &newType, 4);
-                    }
-                    else
-                    {
-                        wkbBuf[1] = (newType >> 24) & 0xFF;
-                        wkbBuf[2] = (newType >> 16) & 0xFF;
-                        wkbBuf[3] = (newType >> 8) & 0xFF;
-                        wkbBuf[4] = newType & 0xFF;
-                    }
+// Decoder skipping a value of H2GIS type nType, by width
+static H2GISDecodeOp GetSkipOp(int nType)
+{
+    switch (nType)
+    {
+        case H2GIS_TYPE_BOOL:
+            return H2GIS_DECODE_SKIP_1;
+        case H2GIS_TYPE_INT:
+        case H2GIS_TYPE_FLOAT:
+            return H2GIS_DECODE_SKIP_4;
+        case H2GIS_TYPE_LONG:
+        case H2GIS_TYPE_DOUBLE:
+            return H2GIS_DECODE_SKIP_8;
+        case H2GIS_TYPE_STRING:
+        case H2GIS_TYPE_DATE:
+        case H2GIS_TYPE_GEOM:
+        case H2GIS_TYPE_OTHER:
+            return H2GIS_DECODE_SKIP_VARLEN;
+        default:
+            return H2GIS_DECODE_NONE;
+    }
+}
 
-                    // Copy geometry data (skip 4 bytes of SRID after original type)
-                    // Original: [1 byte order][4 type][4 SRID][rest]
-                    // New:      [1 byte order][4 type][rest]
-                    memcpy(&wkbBuf[5], ptr + 9, len - 9);
+/**
+ * Resolve the decoder of every column of a fetched batch, once per query.
+ *
+ * @param poDefn Definition the decoded features belong to.
+ * @param anTypes H2GIS type of each column (see H2GISParseBatchBuffer()).
+ * @param anTargets Target of each column: OGR field index, H2GIS_COL_FID,
+ *        H2GIS_COL_GEOM - geometry field index, or H2GIS_COL_SKIP. Missing
+ *        entries are skipped.
+ * @param aoPlan Output: one step per column.
+ */
+void H2GISBuildDecodePlan(const OGRFeatureDefn *poDefn,
+                          const std::vector<int> &anTypes,
+                          const std::vector<int> &anTargets,
+                          std::vector<H2GISDecodeStep> &aoPlan)
+{
+    aoPlan.assign(anTypes.size(), H2GISDecodeStep());
+    for (size_t iCol = 0; iCol < anTypes.size(); iCol++)
+    {
+        const int nType = anTypes[iCol];
+        const int iTarget =
+            iCol < anTargets.size() ? anTargets[iCol] : H2GIS_COL_SKIP;
+        H2GISDecodeStep &oStep = aoPlan[iCol];
 
-                    OGRGeometryFactory::createFromWkb(wkbBuf.data(), nullptr,
-                                                      &poGeom, newLen);
-                }
-                else
-                {
-                    // Standard WKB
-                    OGRGeometryFactory::createFromWkb(ptr, nullptr, &poGeom,
-                                                      len);
-                }
+        // Width of a value, used when the column is not decoded
+        oStep.eOp = GetSkipOp(nType);
 
-                if (poGeom)
-                    poFeature->SetGeomFieldDirectly(iGeom, poGeom);
-            }
-            ptr += len;
-            iGeom++;
+        if (iTarget == H2GIS_COL_FID)
+        {
+            if (nType == H2GIS_TYPE_INT)
+                oStep.eOp = H2GIS_DECODE_FID_INT;
+            else if (nType == H2GIS_TYPE_LONG)
+                oStep.eOp = H2GIS_DECODE_FID_LONG;
         }
-        else if (type == H2GIS_TYPE_STRING)
+        else if (iTarget <= H2GIS_COL_GEOM)
         {
-            int32_t len;
-            memcpy(&len, ptr, 4);
-            ptr += 4;
-            if (len > 0)
+            const int iGeomField = H2GIS_COL_GEOM - iTarget;
+            if (nType == H2GIS_TYPE_GEOM &&
+                iGeomField < poDefn->GetGeomFieldCount())
             {
-                std::string s((char *)ptr, len);
-                if (iField < m_poFeatureDefn->GetFieldCount())
-                {
-                    const char *pszFieldName =
-                        m_poFeatureDefn->GetFieldDefn(iField)->GetNameRef();
-                    if (!pszFieldName || m_ignoredFields.find(pszFieldName) ==
-                                             m_ignoredFields.end())
-                    {
-                        poFeature->SetField(iField, s.c_str());
-                    }
-                }
+                oStep.eOp = H2GIS_DECODE_GEOM;
+                oStep.iTarget = iGeomField;
+                oStep.poSRS =
+                    poDefn->GetGeomFieldDefn(iGeomField)->GetSpatialRef();
             }
-            ptr += len;
-            iField++;
         }
-        else if (type == H2GIS_TYPE_INT)
+        else if (iTarget >= 0 && iTarget < poDefn->GetFieldCount())
         {
-            int32_t val;
-            memcpy(&val, ptr, 4);
-            ptr += 4;
-            if (iField < m_poFeatureDefn->GetFieldCount())
+            oStep.iTarget = iTarget;
+            switch (nType)
             {
-                const char *pszFieldName =
-                    m_poFeatureDefn->GetFieldDefn(iField)->GetNameRef();
-                if (!pszFieldName ||
-                    m_ignoredFields.find(pszFieldName) == m_ignoredFields.end())
-                {
-                    poFeature->SetField(iField, val);
-                }
+                case H2GIS_TYPE_STRING:
+                    oStep.eOp = H2GIS_DECODE_STRING;
+                    break;
+                case H2GIS_TYPE_INT:
+                    oStep.eOp = H2GIS_DECODE_INT;
+                    break;
+                case H2GIS_TYPE_LONG:
+                    oStep.eOp = H2GIS_DECODE_LONG;
+                    break;
+                case H2GIS_TYPE_FLOAT:
+                    oStep.eOp = H2GIS_DECODE_FLOAT;
+                    break;
+                case H2GIS_TYPE_DOUBLE:
+                    oStep.eOp = H2GIS_DECODE_DOUBLE;
+                    break;
+                case H2GIS_TYPE_BOOL:
+                    oStep.eOp = H2GIS_DECODE_BOOL;
+                    break;
+                default:
+                    break;
             }
-            iField++;
+#if GDAL_VERSION_NUM >= 3080000
+            // Same type: stored with OGRFeature::SetFieldSameTypeUnsafe(),
+            // available from GDAL 3.8
+            const OGRFieldType eType =
+                poDefn->GetFieldDefn(iTarget)->GetType();
+            if (oStep.eOp == H2GIS_DECODE_STRING && eType == OFTString)
+                oStep.eOp = H2GIS_DECODE_STRING_RAW;
+            else if (oStep.eOp == H2GIS_DECODE_INT && eType == OFTInteger)
+                oStep.eOp = H2GIS_DECODE_INT_RAW;
+            else if (oStep.eOp == H2GIS_DECODE_LONG && eType == OFTInteger64)
+                oStep.eOp = H2GIS_DECODE_LONG_RAW;
+            else if (oStep.eOp == H2GIS_DECODE_DOUBLE && eType == OFTReal)
+                oStep.eOp = H2GIS_DECODE_DOUBLE_RAW;
+#endif
         }
-        else if (type == H2GIS_TYPE_LONG)
+    }
+}
+
+/**
+ * Build a feature from the current row of a fetched batch and advance the
+ * column cursors to the next row.
+ *
+ * @param poDefn Definition of the new feature.
+ * @param aoPlan Decoder of each column (see H2GISBuildDecodePlan()).
+ * @param apCursors Column cursors (see H2GISParseBatchBuffer()).
+ * @param poReuse Feature of poDefn decoded earlier and no longer needed,
+ *        cleared and filled again instead of allocating one (optional).
+ * @return a new feature (or poReuse), whose FID is unset if no FID column
+ *         was selected.
+ */
+OGRFeature *H2GISDecodeRow(OGRFeatureDefn *poDefn,
+                           const std::vector<H2GISDecodeStep> &aoPlan,
+                           std::vector<uint8_t *> &apCursors,
+                           OGRFeature *poReuse)
+{
+    OGRFeature *poFeature = poReuse;
+    if (poFeature)
+    {
+        // The _RAW decoders expect unset fields
+        for (int i = 0; i < poFeature->GetFieldCount(); i++)
+            poFeature->UnsetField(i);
+        for (int i = 0; i < poFeature->GetGeomFieldCount(); i++)
+            poFeature->SetGeomFieldDirectly(i, nullptr);
+        poFeature->SetFID(OGRNullFID);
+    }
+    else
+    {
+        poFeature = new OGRFeature(poDefn);
+    }
+    const size_t nCols = std::min(aoPlan.size(), apCursors.size());
+
+    for (size_t iCol = 0; iCol < nCols; iCol++)
+    {
+        const H2GISDecodeStep &oStep = aoPlan[iCol];
+        uint8_t *&ptr = apCursors[iCol];
+
+        switch (oStep.eOp)
         {
-            int64_t val;
-            memcpy(&val, ptr, 8);
-            ptr += 8;
-            if (iField < m_poFeatureDefn->GetFieldCount())
+            case H2GIS_DECODE_NONE:
+                break;
+            case H2GIS_DECODE_SKIP_1:
+                ptr += 1;
+                break;
+            case H2GIS_DECODE_SKIP_4:
+                ptr += 4;
+                break;
+            case H2GIS_DECODE_SKIP_8:
+                ptr += 8;
+                break;
+            case H2GIS_DECODE_SKIP_VARLEN:
             {
-                const char *pszFieldName =
-                    m_poFeatureDefn->GetFieldDefn(iField)->GetNameRef();
-                if (!pszFieldName ||
-                    m_ignoredFields.find(pszFieldName) == m_ignoredFields.end())
-                {
-                    poFeature->SetField(iField, (GIntBig)val);
-                }
+                int32_t len;
+                memcpy(&len, ptr, 4);
+                ptr += 4;
+                if (len > 0)
+                    ptr += len;
+                break;
             }
-            iField++;
-        }
-        else if (type == H2GIS_TYPE_DOUBLE)
-        {
-            double val;
-            memcpy(&val, ptr, 8);
-            ptr += 8;
-            if (iField < m_poFeatureDefn->GetFieldCount())
+            case H2GIS_DECODE_FID_INT:
+            {
+                int32_t val;
+                memcpy(&val, ptr, 4);
+                ptr += 4;
+                poFeature->SetFID(val);
+                break;
+            }
+            case H2GIS_DECODE_FID_LONG:
+            {
+                int64_t val;
+                memcpy(&val, ptr, 8);
+                ptr += 8;
+                poFeature->SetFID(val);
+                break;
+            }
+            case H2GIS_DECODE_GEOM:
             {
-                const char *pszFieldName =
-                    m_poFeatureDefn->GetFieldDefn(iField)->GetNameRef();
-                if (!pszFieldName ||
-                    m_ignoredFields.find(pszFieldName) == m_ignoredFields.end())
+                int32_t len;
+                memcpy(&len, ptr, 4);
+                ptr += 4;
+                if (len > 0)
                 {
-                    poFeature->SetField(iField, val);
+                    // H2GIS sends EWKB: decoded straight from the buffer
+                    OGRGeometry *poGeom = H2GISGeometryFromEWKB(ptr, len);
+                    if (poGeom)
+                    {
+                        poGeom->assignSpatialReference(oStep.poSRS);
+                        poFeature->SetGeomFieldDirectly(oStep.iTarget,
+                                                        poGeom);
+                    }
+                    ptr += len;
                 }
+                break;
             }
-            iField++;
-        }
-        else if (type == H2GIS_TYPE_FLOAT)
-        {
-            float val;
-            memcpy(&val, ptr, 4);
-            ptr += 4;
-            if (iField < m_poFeatureDefn->GetFieldCount())
+            case H2GIS_DECODE_STRING:
             {
-                const char *pszFieldName =
-                    m_poFeatureDefn->GetFieldDefn(iField)->GetNameRef();
-                if (!pszFieldName ||
-                    m_ignoredFields.find(pszFieldName) == m_ignoredFields.end())
+                int32_t len;
+                memcpy(&len, ptr, 4);
+                ptr += 4;
+                if (len > 0)
                 {
-                    poFeature->SetField(iField, (double)val);
+                    std::string s((char *)ptr, len);
+                    poFeature->SetField(oStep.iTarget, s.c_str());
+                    ptr += len;
                 }
+                break;
             }
-            iField++;
-        }
-        else if (type == H2GIS_TYPE_BOOL)
-        {
-            int8_t val;
-            memcpy(&val, ptr, 1);
-            ptr += 1;
-            if (iField < m_poFeatureDefn->GetFieldCount())
+            case H2GIS_DECODE_INT:
+            {
+                int32_t val;
+                memcpy(&val, ptr, 4);
+                ptr += 4;
+                poFeature->SetField(oStep.iTarget, val);
+                break;
+            }
+            case H2GIS_DECODE_LONG:
+            {
+                int64_t val;
+                memcpy(&val, ptr, 8);
+                ptr += 8;
+                poFeature->SetField(oStep.iTarget, (GIntBig)val);
+                break;
+            }
+            case H2GIS_DECODE_FLOAT:
+            {
+                float val;
+                memcpy(&val, ptr, 4);
+                ptr += 4;
+                poFeature->SetField(oStep.iTarget, (double)val);
+                break;
+            }
+            case H2GIS_DECODE_DOUBLE:
             {
-                const char *pszFieldName =
-                    m_poFeatureDefn->GetFieldDefn(iField)->GetNameRef();
-                if (!pszFieldName ||
-                    m_ignoredFields.find(pszFieldName) == m_ignoredFields.end())
+                double val;
+                memcpy(&val, ptr, 8);
+                ptr += 8;
+                poFeature->SetField(oStep.iTarget, val);
+                break;
+            }
+            case H2GIS_DECODE_BOOL:
+            {
+                int8_t val;
+                memcpy(&val, ptr, 1);
+                ptr += 1;
+                poFeature->SetField(oStep.iTarget, (int)val);
+                break;
+            }
+#if GDAL_VERSION_NUM >= 3080000
+            case H2GIS_DECODE_STRING_RAW:
+            {
+                int32_t len;
+                memcpy(&len, ptr, 4);
+                ptr += 4;
+                if (len > 0)
                 {
-                    poFeature->SetField(iField, (int)val);
+                    // Copied once, straight into the field storage
+                    char *pszValue = static_cast<char *>(CPLMalloc(len + 1));
+                    memcpy(pszValue, ptr, len);
+                    pszValue[len] = '\0';
+                    poFeature->SetFieldSameTypeUnsafe(oStep.iTarget,
+                                                      pszValue);
+                    ptr += len;
                 }
+                break;
+            }
+            case H2GIS_DECODE_INT_RAW:
+            {
+                int32_t val;
+                memcpy(&val, ptr, 4);
+                ptr += 4;
+                poFeature->SetFieldSameTypeUnsafe(oStep.iTarget, (int)val);
+                break;
+            }
+            case H2GIS_DECODE_LONG_RAW:
+            {
+                int64_t val;
+                memcpy(&val, ptr, 8);
+                ptr += 8;
+                poFeature->SetFieldSameTypeUnsafe(oStep.iTarget,
+                                                  (GIntBig)val);
+                break;
             }
-            iField++;
+            case H2GIS_DECODE_DOUBLE_RAW:
+            {
+                double val;
+                memcpy(&val, ptr, 8);
+                ptr += 8;
+                poFeature->SetFieldSameTypeUnsafe(oStep.iTarget, val);
+                break;
+            }
+#else
+            default:
+                // No _RAW decoder is planned before GDAL 3.8
+                break;
+#endif
         }
     }
 
+    return poFeature;
+}
+
+OGRFeature *OGRH2GISLayer::GetNextFeature()
+{
+    // EnsureSchema(); // Already done
+
+    // Lazy preparation
+    if (m_bResetPending)
+    {
+        EnsureSchema();
+        PrepareQuery();
+    }
+
+    // TILE_CACHE: scan served from the cached tiles (see PrepareTileScan)
+    if (m_bTileScan)
+    {
+        if (m_iTileScan >= m_apoTileScan.size())
+            return nullptr;
+        m_iNextShapeId++;
+        return m_apoTileScan[m_iTileScan++]->Clone();
+    }
+
+    if (!m_nRS && m_aoScanPartitions.empty())
+        ResetReading();
+
+    if (m_iNextRowInBatch >= m_nBatchRows)
+    {
+        if (!FetchNextBatch())
+            return nullptr;
+    }
+
+    OGRFeature *poFeature =
+        H2GISDecodeRow(m_poFeatureDefn, m_aoDecodePlan, m_columnValues);
+
     // Fallback FID if not set from _ROWID_
-    if (!fidSet)
+    if (poFeature->GetFID() == OGRNullFID)
     {
         poFeature->SetFID(m_iNextShapeId);
     }
@@ -733,247 +1442,172 @@ OGRFeature *OGRH2GISLayer::GetNextFeature()
 OGRFeature *OGRH2GISLayer::GetFeature(GIntBig nFID)
 {
     EnsureSchema();
+    FlushPendingInserts();
+
+    // Feature decoded ahead by a previous FID range fetch
+    auto oCached = m_oFIDBurstCache.find(nFID);
+    if (oCached != m_oFIDBurstCache.end())
+    {
+        OGRFeature *poFeature = oCached->second;
+        m_oFIDBurstCache.erase(oCached);
+        m_nLastGetFeatureFID = nFID;
+        return poFeature;
+    }
+
+    // Ascending lookups close to each other (e.g. a FID list walked by an
+    // application) are served from one range fetch instead of one query
+    // per feature. The range doubles as long as the burst goes on.
+    const bool bBurst = m_nLastGetFeatureFID != OGRNullFID &&
+                        nFID > m_nLastGetFeatureFID &&
+                        nFID - m_nLastGetFeatureFID <= H2GIS_FID_BURST_MAX_GAP;
+    if (!bBurst)
+        m_nFIDBurstRows = H2GIS_FID_BURST_MIN_ROWS;
+    m_nLastGetFeatureFID = nFID;
+    ClearFIDBurstCache();
 
     std::string fidCol =
         m_osFIDCol.empty() ? "_ROWID_" : ("\"" + m_osFIDCol + "\"");
-    std::string sql = "SELECT * FROM \"" + m_osTableName + "\" WHERE " +
-                      fidCol + " = " + std::to_string(nFID);
+    std::vector<int> anColumnFieldIndex;
+    std::string sql = "SELECT " + BuildSelectColumns(&anColumnFieldIndex) +
+                      " FROM \"" + m_osTableName + "\" WHERE " + fidCol;
+    if (bBurst)
+        sql += " >= ? AND " + fidCol + " < ? ORDER BY " + fidCol;
+    else
+        sql += " = ?";
 
     graal_isolatethread_t *thread =
         (graal_isolatethread_t *)m_poDS->GetThread();
-    long long conn = m_poDS->GetConnection();
 
-    long long stmt = h2gis_prepare(thread, conn, (char *)sql.c_str());
+    long long stmt = GetCachedStatement(sql);
     if (!stmt)
         return nullptr;
 
+    // Parameter indexes are 1-based (JDBC)
+    const int nRows = bBurst ? m_nFIDBurstRows : 1;
+    h2gis_bind_long(thread, stmt, 1, nFID);
+    if (bBurst)
+        h2gis_bind_long(thread, stmt, 2, nFID + nRows);
+
+    const auto oFetchStart = std::chrono::steady_clock::now();
     long long rs = h2gis_execute_prepared(thread, stmt);
     if (!rs)
-    {
-        h2gis_close_query(thread, stmt);
         return nullptr;
-    }
+    CountQuery();
 
     long long sizeOut = 0;
-    void *buffer = h2gis_fetch_one(thread, rs, &sizeOut);
+    void *buffer = h2gis_fetch_batch(thread, rs, nRows, &sizeOut);
+    const GIntBig nWaitUs = H2GISElapsedUs(oFetchStart);
+    h2gis_close_query(thread, rs);
 
     if (!buffer || sizeOut <= 0)
     {
         if (buffer)
-            h2gis_free_result_buffer(thread, buffer);
-        h2gis_close_query(thread, rs);
-        h2gis_close_query(thread, stmt);
+            h2gis_release_result_buffer(thread, buffer);
         return nullptr;
     }
 
-    uint8_t *ptr = (uint8_t *)buffer;
-
-    int32_t colCount;
-    memcpy(&colCount, ptr, 4);
-    ptr += 4;
-
-    int32_t rowCount;
-    memcpy(&rowCount, ptr, 4);
-    ptr += 4;
+    // Same layout and decoding as the scan batches (see FetchNextBatch)
+    std::vector<uint8_t *> apCursors;
+    std::vector<int> anTypes;
+    const int nRowCount =
+        H2GISParseBatchBuffer(buffer, apCursors, anTypes);
+    CountBatch(nRowCount, sizeOut, nWaitUs);
+    std::vector<H2GISDecodeStep> aoPlan;
+    H2GISBuildDecodePlan(m_poFeatureDefn, anTypes, anColumnFieldIndex,
+                         aoPlan);
 
-    // If no rows returned, the feature doesn't exist
-    if (rowCount == 0)
+    OGRFeature *poRequested = nullptr;
+    for (int iRow = 0; iRow < nRowCount; iRow++)
     {
-        h2gis_free_result_buffer(thread, buffer);
-        h2gis_close_query(thread, rs);
-        h2gis_close_query(thread, stmt);
-        return nullptr;
+        OGRFeature *poFeature =
+            H2GISDecodeRow(m_poFeatureDefn, aoPlan, apCursors);
+        if (poFeature->GetFID() == OGRNullFID)
+            poFeature->SetFID(nFID + iRow);
+        if (poFeature->GetFID() == nFID)
+            poRequested = poFeature;
+        else if (!m_oFIDBurstCache.emplace(poFeature->GetFID(), poFeature)
+                      .second)
+            delete poFeature;
     }
 
-    OGRFeature *poFeature = new OGRFeature(m_poFeatureDefn);
-    poFeature->SetFID(nFID);
-
-    // Read offsets
-    std::vector<int64_t> offsets(colCount);
-    for (int i = 0; i < colCount; i++)
-    {
-        memcpy(&offsets[i], ptr, 8);
-        ptr += 8;
-    }
+    h2gis_release_result_buffer(thread, buffer);
 
-    uint8_t *base = (uint8_t *)buffer;
+    if (bBurst && m_nFIDBurstRows < H2GIS_BATCH_SIZE)
+        m_nFIDBurstRows = std::min(2 * m_nFIDBurstRows, H2GIS_BATCH_SIZE);
 
-    // Iterate all columns, start from 0
-    for (int i = 0; i < colCount; i++)
-    {
-        uint8_t *colPtr = base + offsets[i];
+    return poRequested;
+}
 
-        // Read column name
-        int32_t nameLen;
-        memcpy(&nameLen, colPtr, 4);
-        colPtr += 4;
-        std::string colName((char *)colPtr, nameLen);
-        colPtr += nameLen;
+void H2GISStats::Report(CPLStringList &aosList) const
+{
+    aosList.SetNameValue("QUERIES", CPLSPrintf(CPL_FRMT_GIB, nQueries));
+    aosList.SetNameValue("BATCHES", CPLSPrintf(CPL_FRMT_GIB, nBatches));
+    aosList.SetNameValue("ROWS", CPLSPrintf(CPL_FRMT_GIB, nRows));
+    aosList.SetNameValue("BYTES", CPLSPrintf(CPL_FRMT_GIB, nBytes));
+    aosList.SetNameValue("FETCH_WAIT_MS",
+                         CPLSPrintf("%.3f", nFetchWaitUs / 1000.0));
+}
 
-        int32_t type;
-        memcpy(&type, colPtr, 4);
-        colPtr += 4;
+char **OGRH2GISLayer::GetMetadataDomainList()
+{
+    return BuildMetadataDomainList(OGRLayer::GetMetadataDomainList(), TRUE,
+                                   H2GIS_STATS_DOMAIN, nullptr);
+}
 
-        int32_t dataLen;
-        memcpy(&dataLen, colPtr, 4);
-        colPtr += 4;
+/**
+ * H2GIS_STATS_DOMAIN: counters of the read queries of the layer (see
+ * H2GISStats), rebuilt at each call.
+ */
+char **OGRH2GISLayer::GetMetadata(const char *pszDomain)
+{
+    if (pszDomain && EQUAL(pszDomain, H2GIS_STATS_DOMAIN))
+    {
+        m_oStats.Report(m_aosStatsMetadata);
+        return m_aosStatsMetadata.List();
+    }
+    return OGRLayer::GetMetadata(pszDomain);
+}
 
-        // Skip FID column (already used for FID)
-        if (!m_osFIDCol.empty() && EQUAL(colName.c_str(), m_osFIDCol.c_str()))
-        {
-            continue;
-        }
-
-        if (type == H2GIS_TYPE_GEOM)
-        {
-            if (dataLen > 0)
-            {
-                int32_t blobLen;
-                memcpy(&blobLen, colPtr, 4);
-                colPtr += 4;
-                if (blobLen > 0)
-                {
-                    OGRGeometry *poGeom = nullptr;
-
-                    // Handle EWKB (Extended WKB) with SRID embedded
-                    // Same logic as GetNextFeature batch path
-                    uint8_t byteOrder = colPtr[0];
-                    uint32_t wkbType;
-                    if (byteOrder == 1)
-                        memcpy(&wkbType, colPtr + 1, 4);
-                    else
-                        wkbType = ((uint32_t)colPtr[1] << 24) |
-                                  ((uint32_t)colPtr[2] << 16) |
-                                  ((uint32_t)colPtr[3] << 8) |
-                                  (uint32_t)colPtr[4];
-
-                    const uint32_t SRID_FLAG = 0x20000000;
-                    if (wkbType & SRID_FLAG)
-                    {
-                        // EWKB with SRID - strip the 4-byte SRID
-                        int newLen = blobLen - 4;
-                        std::vector<uint8_t> wkbBuf(newLen);
-                        wkbBuf[0] = colPtr[0];
-                        uint32_t newType = wkbType & ~SRID_FLAG;
-                        if (byteOrder == 1)
-                            memcpy(&wkbBuf[1], &newType, 4);
-                        else
-                        {
-                            wkbBuf[1] = (newType >> 24) & 0xFF;
-                            wkbBuf[2] = (newType >> 16) & 0xFF;
-                            wkbBuf[3] = (newType >> 8) & 0xFF;
-                            wkbBuf[4] = newType & 0xFF;
-                        }
-                        memcpy(&wkbBuf[5], colPtr + 9, blobLen - 9);
-                        OGRGeometryFactory::createFromWkb(
-                            wkbBuf.data(), nullptr, &poGeom, newLen);
-                    }
-                    else
-                    {
-                        OGRGeometryFactory::createFromWkb(
-                            colPtr, nullptr, &poGeom, blobLen);
-                    }
-
-                    if (poGeom)
-                    {
-                        if (m_nSRID > 0)
-                            poGeom->assignSpatialReference(
-                                m_poFeatureDefn->GetGeomFieldDefn(0)
-                                    ->GetSpatialRef());
-                        poFeature->SetGeometryDirectly(poGeom);
-                    }
-                }
-            }
-        }
-        else
-        {
-            // Find field by name, simpler logic than sequence matching
-            int fieldIdx = m_poFeatureDefn->GetFieldIndex(colName.c_str());
-
-            if (fieldIdx < 0)
-                continue;
-            if (m_ignoredFields.find(colName) != m_ignoredFields.end())
-                continue;
-
-            if (type == H2GIS_TYPE_INT)
-            {
-                int32_t val;
-                memcpy(&val, colPtr, 4);
-                poFeature->SetField(fieldIdx, val);
-            }
-            else if (type == H2GIS_TYPE_LONG)
-            {
-                int64_t val;
-                memcpy(&val, colPtr, 8);
-                poFeature->SetField(fieldIdx, (GIntBig)val);
-            }
-            else if (type == H2GIS_TYPE_DOUBLE)
-            {
-                double val;
-                memcpy(&val, colPtr, 8);
-                poFeature->SetField(fieldIdx, val);
-            }
-            else if (type == H2GIS_TYPE_STRING)
-            {
-                if (dataLen > 0)
-                {
-                    int32_t strLen;
-                    memcpy(&strLen, colPtr, 4);
-                    colPtr += 4;
-                    if (strLen >= 0)
-                    {
-                        std::string s((char *)colPtr, strLen);
-                        poFeature->SetField(fieldIdx, s.c_str());
-                    }
-                }
-            }
-            else if (type == H2GIS_TYPE_BOOL)
-            {
-                int8_t val;
-                memcpy(&val, colPtr, 1);
-                poFeature->SetField(fieldIdx, (int)val);
-            }
-        }
-    }
-
-    h2gis_free_result_buffer(thread, buffer);
-    h2gis_close_query(thread, rs);
-    h2gis_close_query(thread, stmt);
-
-    return poFeature;
-}
-
-#if GDAL_VERSION_NUM >= 3120000
-int OGRH2GISLayer::TestCapability(const char *pszCap) const
-#else
-int OGRH2GISLayer::TestCapability(const char *pszCap)
-#endif
-{
-    if (EQUAL(pszCap, OLCCreateField))
-        return TRUE;
-    if (EQUAL(pszCap, OLCSequentialWrite))
-        return TRUE;
-    if (EQUAL(pszCap, OLCRandomWrite))
-        return TRUE;
-    if (EQUAL(pszCap, OLCDeleteFeature))
-        return TRUE;
-    if (EQUAL(pszCap, OLCStringsAsUTF8))
-        return TRUE;
-    if (EQUAL(pszCap, OLCFastFeatureCount))
-        return TRUE;
-    // OLCFastGetExtent: FALSE - we don't cache extent, GetExtent requires bForce=TRUE
-    if (EQUAL(pszCap, OLCFastSpatialFilter))
-        return TRUE;  // Spatial index supported
-    if (EQUAL(pszCap, OLCRandomRead))
-        return TRUE;  // GetFeature(FID) implemented
-    if (EQUAL(pszCap, OLCTransactions))
-        return TRUE;  // Transactions supported
-    if (EQUAL(pszCap, OLCIgnoreFields))
-        return TRUE;
-    if (EQUAL(pszCap, OLCFastSetNextByIndex))
-        return TRUE;  // SetNextByIndex with OFFSET supported
-    return FALSE;
-}
+#if GDAL_VERSION_NUM >= 3120000
+int OGRH2GISLayer::TestCapability(const char *pszCap) const
+#else
+int OGRH2GISLayer::TestCapability(const char *pszCap)
+#endif
+{
+    if (EQUAL(pszCap, OLCCreateField))
+        return TRUE;
+    if (EQUAL(pszCap, OLCSequentialWrite))
+        return TRUE;
+    if (EQUAL(pszCap, OLCRandomWrite))
+        return TRUE;
+    if (EQUAL(pszCap, OLCDeleteFeature))
+        return TRUE;
+#if GDAL_VERSION_NUM >= 3060000
+    if (EQUAL(pszCap, OLCUpsertFeature))
+        return TRUE;  // MERGE INTO (see IUpsertFeature)
+#endif
+    if (EQUAL(pszCap, OLCStringsAsUTF8))
+        return TRUE;
+    if (EQUAL(pszCap, OLCFastFeatureCount))
+        return TRUE;
+    if (EQUAL(pszCap, OLCFastGetExtent))
+        return m_bExtentValid && !m_osGeomCol.empty();  // See GetExtent()
+    if (EQUAL(pszCap, OLCFastSpatialFilter))
+        return TRUE;  // Spatial index supported
+    if (EQUAL(pszCap, OLCRandomRead))
+        return TRUE;  // GetFeature(FID) implemented
+    if (EQUAL(pszCap, OLCTransactions))
+        return TRUE;  // Transactions supported
+    if (EQUAL(pszCap, OLCIgnoreFields))
+        return TRUE;
+    if (EQUAL(pszCap, OLCFastSetNextByIndex))
+        return TRUE;  // Keyset seek from recorded batch boundaries
+#if GDAL_VERSION_NUM >= 3060000
+    if (EQUAL(pszCap, OLCFastGetArrowStream))
+        return IsArrowFastPathSupported(nullptr);
+#endif
+    return FALSE;
+}
 
 // GDAL 3.12+ changed SetSpatialFilter to non-virtual, override ISetSpatialFilter instead
 #if GDAL_VERSION_NUM >= 3120000
@@ -1010,13 +1644,57 @@ OGRErr OGRH2GISLayer::SetNextByIndex(GIntBig nIndex)
     // Clear any existing statement
     ClearStatement();
 
-    // Set the starting index - PrepareQuery will add OFFSET
+    // Set the starting index - PrepareQuery seeks to it (keyset or OFFSET)
     m_iNextShapeId = nIndex;
+    m_nBatchRows = 0;
+    m_iNextRowInBatch = 0;
+    if (m_poFilterGeom == nullptr && IsFIDUnique())
+        m_bKeysetScan = true;
     m_bResetPending = true;
 
     return OGRERR_NONE;
 }
 
+/**
+ * Whether no two rows share a FID, which keyset seeks need (see
+ * PrepareQuery()): always true of _ROWID_, and of a FID column that is the
+ * primary key or has a UNIQUE constraint of its own. Other tables only get
+ * a FID column because it is named ID, so they keep seeking with OFFSET.
+ */
+bool OGRH2GISLayer::IsFIDUnique()
+{
+    if (m_nFIDUnique >= 0)
+        return m_nFIDUnique > 0;
+    // The tables of layers created by the driver have their FID as primary
+    // key, even while their CREATE TABLE is deferred
+    if (m_osFIDCol.empty() || !m_osDeferredTableSQL.empty())
+    {
+        m_nFIDUnique = 1;
+        return true;
+    }
+
+    GIntBig nKeys = 0;
+    const bool bOK = H2GISFetchFirstInt64(
+        (graal_isolatethread_t *)m_poDS->GetThread(), m_poDS->GetConnection(),
+        "SELECT COUNT(*) FROM INFORMATION_SCHEMA.TABLE_CONSTRAINTS tc "
+        "JOIN INFORMATION_SCHEMA.KEY_COLUMN_USAGE k "
+        "ON k.CONSTRAINT_SCHEMA = tc.CONSTRAINT_SCHEMA "
+        "AND k.CONSTRAINT_NAME = tc.CONSTRAINT_NAME "
+        "WHERE tc.TABLE_NAME = ? "
+        "AND tc.CONSTRAINT_TYPE IN ('PRIMARY KEY', 'UNIQUE') "
+        "AND k.COLUMN_NAME = ? AND NOT EXISTS (SELECT 1 FROM "
+        "INFORMATION_SCHEMA.KEY_COLUMN_USAGE k2 "
+        "WHERE k2.CONSTRAINT_SCHEMA = k.CONSTRAINT_SCHEMA "
+        "AND k2.CONSTRAINT_NAME = k.CONSTRAINT_NAME "
+        "AND k2.COLUMN_NAME <> k.COLUMN_NAME)",
+        {m_osTableName, m_osFIDCol}, &nKeys);
+    m_nFIDUnique = bOK && nKeys > 0 ? 1 : 0;
+    if (!m_nFIDUnique)
+        LogLayer("SetNextByIndex with OFFSET, FID column not unique",
+                 m_osFIDCol.c_str());
+    return m_nFIDUnique > 0;
+}
+
 OGRErr OGRH2GISLayer::SetAttributeFilter(const char *pszQuery)
 {
     // Store the attribute filter for push-down to H2GIS
@@ -1031,6 +1709,7 @@ OGRErr OGRH2GISLayer::SetAttributeFilter(const char *pszQuery)
 
     // Call base class to set m_poAttrQuery (used for fallback filtering)
     OGRErr err = OGRLayer::SetAttributeFilter(pszQuery);
+    m_oKeysetIndex.clear();
     ResetReading();
     return err;
 }
@@ -1041,15 +1720,8 @@ OGRErr OGRH2GISLayer::SetIgnoredFields(const char *const *papszFields)
 OGRErr OGRH2GISLayer::SetIgnoredFields(const char **papszFields)
 #endif
 {
-    m_ignoredFields.clear();
-    if (papszFields)
-    {
-        for (int i = 0; papszFields[i] != nullptr; i++)
-        {
-            m_ignoredFields.insert(papszFields[i]);
-        }
-    }
     OGRLayer::SetIgnoredFields(papszFields);
+    ClearFIDBurstCache();  // Decoded with the previous projection
     ResetReading();
     return OGRERR_NONE;
 }
@@ -1057,33 +1729,50 @@ OGRErr OGRH2GISLayer::SetIgnoredFields(const char **papszFields)
 GIntBig OGRH2GISLayer::GetFeatureCount(int bForce)
 {
     LogLayer("GetFeatureCount", m_poFeatureDefn->GetName());
+    FlushPendingInserts();
+    BuildDeferredSpatialIndex();
 
     // If there's a spatial filter or attribute filter, we need to query with the filter
     bool bHasFilter =
         (m_poFilterGeom != nullptr) || !m_osAttributeFilter.empty();
 
-    if (!bHasFilter)
+    // Filtered counts are remembered by filter, as applications such as
+    // QGIS ask for the same one repeatedly; the spatial filter enters the
+    // query as the geometry bound to it
+    const std::string osSpatialFilter = BuildSpatialFilterClause();
+    std::string osFilterKey;
+    if (bHasFilter)
     {
-        // No filters - return pre-cached row count from INFORMATION_SCHEMA
-        // m_nFeatureCount was pre-filled in constructor from ROW_COUNT_ESTIMATE
-        if (!bForce)
+        osFilterKey.assign(m_abyFilterEWKB.begin(), m_abyFilterEWKB.end());
+        osFilterKey += ';';
+        osFilterKey += m_osAttributeFilter;
+
+        for (auto oIter = m_aoFilteredCounts.begin();
+             oIter != m_aoFilteredCounts.end(); ++oIter)
         {
-            return m_nFeatureCount;
+            if (oIter->first == osFilterKey)
+            {
+                const GIntBig nCount = oIter->second;
+                std::rotate(oIter, oIter + 1, m_aoFilteredCounts.end());
+                return nCount;
+            }
         }
-    }
-    else
-    {
-        // Has filters - need to actually count with WHERE clause
         if (!bForce)
             return -1;  // Indicate we need force to compute
     }
+    else if (!bForce || m_bFeatureCountExact)
+    {
+        // No filters: row count counted earlier and maintained by the
+        // writes of the layer, or else ROW_COUNT_ESTIMATE pre-filled in
+        // the constructor from INFORMATION_SCHEMA
+        return m_nFeatureCount;
+    }
 
     LogLayer("GetFeatureCount FORCED", m_poFeatureDefn->GetName());
 
     // Force mode: use SELECT COUNT(*) for exact count, with filters applied
     graal_isolatethread_t *thread =
         (graal_isolatethread_t *)m_poDS->GetThread();
-    long long conn = m_poDS->GetConnection();
 
     // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
     std::string sql = "SELECT COUNT(*) FROM \"" + m_osTableName + "\"";
@@ -1092,18 +1781,9 @@ GIntBig OGRH2GISLayer::GetFeatureCount(int bForce)
     bool bHasWhere = false;
 
     // Spatial filter
-    if (m_poFilterGeom != nullptr && !m_osGeomCol.empty())
+    if (!osSpatialFilter.empty())
     {
-        OGREnvelope env;
-        m_poFilterGeom->getEnvelope(&env);
-
-        // Use CPLSPrintf for locale-independent decimal formatting
-        std::string sEnv = CPLSPrintf("ST_MakeEnvelope(%.15g, %.15g, %.15g, %.15g, %d)",
-                                      env.MinX, env.MinY, env.MaxX, env.MaxY,
-                                      m_nSRID > 0 ? m_nSRID : 0);
-
-        sql += " WHERE \"" + m_osGeomCol + "\" && " + sEnv +
-               " AND ST_Intersects(\"" + m_osGeomCol + "\", " + sEnv + ")";
+        sql += " WHERE " + osSpatialFilter;
         bHasWhere = true;
     }
 
@@ -1120,21 +1800,19 @@ GIntBig OGRH2GISLayer::GetFeatureCount(int bForce)
         }
     }
 
-    long long stmt = h2gis_prepare(thread, conn, (char *)sql.c_str());
-    if (!stmt)
-        return m_nFeatureCount;  // Fallback to cached estimate
-
-    long long rs = h2gis_execute_prepared(thread, stmt);
-    if (!rs)
-    {
-        h2gis_close_query(thread, stmt);
-        return m_nFeatureCount;
-    }
-
+    // Prepared once per filter shape, the spatial filter being bound
+    const long long hStmt = GetCachedStatement(sql);
+    if (!hStmt)
+        return bHasFilter ? -1 : m_nFeatureCount;  // Fallback to estimate
+    BindSpatialFilter(hStmt);
     long long sizeOut = 0;
-    void *buffer = h2gis_fetch_one(thread, rs, &sizeOut);
+    void *buffer = h2gis_execute_prepared_first_row(thread, hStmt, &sizeOut);
+    if (!buffer)
+        return bHasFilter ? -1 : m_nFeatureCount;  // Fallback to estimate
 
-    if (buffer && sizeOut > 0)
+    GIntBig nCount = -1;
+
+    if (sizeOut > 0)
     {
         uint8_t *ptr = (uint8_t *)buffer;
 
@@ -1167,17 +1845,24 @@ GIntBig OGRH2GISLayer::GetFeatureCount(int bForce)
             {
                 int64_t val;
                 memcpy(&val, ptr, 8);
-                m_nFeatureCount = val;  // Update cache with exact count
+                nCount = val;
             }
         }
-
-        h2gis_free_result_buffer(thread, buffer);
     }
+    h2gis_release_result_buffer(thread, buffer);
 
-    h2gis_close_query(thread, rs);
-    h2gis_close_query(thread, stmt);
-
-    return m_nFeatureCount;
+    if (nCount < 0)
+        return bHasFilter ? -1 : m_nFeatureCount;
+    if (!bHasFilter)
+    {
+        m_nFeatureCount = nCount;  // Exact from now on
+        m_bFeatureCountExact = true;
+        return nCount;
+    }
+    if (m_aoFilteredCounts.size() >= H2GIS_COUNT_CACHE_SIZE)
+        m_aoFilteredCounts.erase(m_aoFilteredCounts.begin());
+    m_aoFilteredCounts.emplace_back(osFilterKey, nCount);
+    return nCount;
 }
 
 // GDAL 3.12+ changed GetExtent to non-virtual, override IGetExtent instead
@@ -1195,17 +1880,26 @@ OGRErr OGRH2GISLayer::GetExtent(int iGeomField, OGREnvelope *psExtent,
 #endif
 {
     LogLayer("GetExtent", m_poFeatureDefn->GetName());
+    FlushPendingInserts();
 
-    // If bForce is FALSE and we don't have a cached extent, return FAILURE
-    // This is the correct behavior per GDAL API - caller should not expect extent
-    // without explicitly forcing computation
-    if (!bForce)
+    // The cached extent answers non-forced calls: writes through the layer
+    // only ever widen it (see ExtendCachedExtent()), but other applications
+    // may have changed the table since it was saved, so forced calls
+    // compute it again and refresh it
+    const bool bCacheable = iGeomField == 0 && !m_osGeomCol.empty();
+    if (bCacheable && m_bExtentValid && !bForce)
     {
-        // We don't maintain a cached extent, so return failure
-        // This tells GDAL/QGIS that extent is unknown without a full scan
-        return OGRERR_FAILURE;
+        if (!m_oCachedExtent.IsInit())
+            return OGRERR_FAILURE;  // No geometry in the table
+        *psExtent = m_oCachedExtent;
+        return OGRERR_NONE;
     }
 
+    // Otherwise computing the extent scans the whole geometry column: per
+    // the GDAL API, only do it when the caller asks for it
+    if (!bForce)
+        return OGRERR_FAILURE;
+
     LogLayer("GetExtent FORCED", m_poFeatureDefn->GetName());
 
     // Use cached geometry column name - don't need to load full schema
@@ -1230,88 +1924,149 @@ OGRErr OGRH2GISLayer::GetExtent(int iGeomField, OGREnvelope *psExtent,
         (graal_isolatethread_t *)m_poDS->GetThread();
     long long conn = m_poDS->GetConnection();
 
-    // Use ST_Extent aggregate for efficient server-side computation (single row result)
-    // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
-    std::string sql = "SELECT ST_XMin(ext), ST_YMin(ext), ST_XMax(ext), ST_YMax(ext) "
-                      "FROM (SELECT ST_Extent(\"" + std::string(pszGeomCol) +
-                      "\") AS ext FROM \"" + m_osTableName + "\") T";
-
-    long long stmt = h2gis_prepare(thread, conn, (char *)sql.c_str());
-    if (!stmt)
-    {
-        return OGRERR_FAILURE;
-    }
+    // Use ST_Extent aggregate for efficient server-side computation (single
+    // row result). The geometry count tells an empty table apart, as its
+    // NULL extent reads back as zeros. Use table name for SQL (not layer
+    // name which may be TABLE.GEOM_COL)
+    const std::string osGeomCol = std::string("\"") + pszGeomCol + "\"";
+    std::string sql =
+        "SELECT ST_XMin(ext), ST_YMin(ext), ST_XMax(ext), ST_YMax(ext), n "
+        "FROM (SELECT ST_Extent(" + osGeomCol + ") AS ext, COUNT(" +
+        osGeomCol + ") AS n FROM \"" + m_osTableName + "\") T";
 
-    long long rs = h2gis_execute_prepared(thread, stmt);
-    if (!rs)
+    long long sizeOut = 0;
+    void *buffer = h2gis_query_first_row(thread, conn, (char *)sql.c_str(),
+                                         nullptr, 0, &sizeOut);
+    if (!buffer)
     {
-        h2gis_close_query(thread, stmt);
         return OGRERR_FAILURE;
     }
 
-    long long sizeOut = 0;
-    void *buffer = h2gis_fetch_one(thread, rs, &sizeOut);
-
     OGRErr eErr = OGRERR_FAILURE;
+    bool bComputed = false;
+    OGREnvelope oExtent;
 
-    if (buffer && sizeOut > 0)
+    std::vector<uint8_t *> apCursors;
+    std::vector<int> anTypes;
+    if (sizeOut > 0 &&
+        H2GISParseBatchBuffer(buffer, apCursors, anTypes) > 0 &&
+        anTypes.size() >= 5 && anTypes[4] == H2GIS_TYPE_LONG)
     {
-        uint8_t *ptr = (uint8_t *)buffer;
+        int64_t nGeoms;
+        memcpy(&nGeoms, apCursors[4], 8);
 
-        int32_t colCount, rowCount;
-        memcpy(&colCount, ptr, 4);
-        ptr += 4;
-        memcpy(&rowCount, ptr, 4);
-        ptr += 4;
+        double vals[4];
+        bool valid = true;
+        for (int c = 0; c < 4 && valid; c++)
+        {
+            double val;
+            memcpy(&val, apCursors[c], 8);
+            if (anTypes[c] != H2GIS_TYPE_DOUBLE || std::isnan(val) ||
+                std::isinf(val))
+                valid = false;
+            else
+                vals[c] = val;
+        }
 
-        if (rowCount > 0 && colCount >= 4)
+        if (nGeoms == 0)
         {
-            // Read column offsets
-            std::vector<int64_t> offsets(colCount);
-            for (int i = 0; i < colCount; i++)
-            {
-                memcpy(&offsets[i], ptr, 8);
-                ptr += 8;
-            }
+            bComputed = true;  // Empty extent
+        }
+        else if (valid)
+        {
+            oExtent.MinX = vals[0];
+            oExtent.MinY = vals[1];
+            oExtent.MaxX = vals[2];
+            oExtent.MaxY = vals[3];
+            *psExtent = oExtent;
+            bComputed = true;
+            eErr = OGRERR_NONE;
+        }
+    }
+    h2gis_release_result_buffer(thread, buffer);
 
-            uint8_t *base = (uint8_t *)buffer;
+    if (bCacheable && bComputed)
+    {
+        // Saved again only if it changed
+        const bool bChanged =
+            !m_bExtentValid ||
+            m_oCachedExtent.IsInit() != oExtent.IsInit() ||
+            (oExtent.IsInit() && !(m_oCachedExtent.Contains(oExtent) &&
+                                   oExtent.Contains(m_oCachedExtent)));
+        m_oCachedExtent = oExtent;
+        m_bExtentValid = true;
+        m_bExtentDirty = m_bExtentDirty || bChanged;
+    }
 
-            double vals[4];
-            bool valid = true;
-            for (int c = 0; c < 4 && valid; c++)
-            {
-                uint8_t *colPtr = base + offsets[c];
-                int32_t nameLen;
-                memcpy(&nameLen, colPtr, 4);
-                colPtr += 4 + nameLen;
-                colPtr += 4;  // Skip type
-                colPtr += 4;  // Skip dataLen
+    return eErr;
+}
 
-                double val;
-                memcpy(&val, colPtr, 8);
-                if (std::isnan(val) || std::isinf(val))
-                    valid = false;
-                else
-                    vals[c] = val;
-            }
+/**
+ * Widen the cached extent to the envelope of a geometry being written.
+ *
+ * The first change also deletes the row saved in H2GIS_EXTENT_TABLE, in the
+ * transaction of the write, so that a session ending without
+ * SaveCachedExtent() leaves no stale extent behind.
+ */
+void OGRH2GISLayer::ExtendCachedExtent(const OGRGeometry *poGeom)
+{
+    if (poGeom == nullptr || poGeom->IsEmpty() || m_osGeomCol.empty())
+        return;
+    if (m_bExtentStored)
+    {
+        m_poDS->DeleteStoredExtent(m_osTableName, m_osGeomCol);
+        m_bExtentStored = false;
+    }
+    if (!m_bExtentValid)
+        return;
 
-            if (valid)
-            {
-                psExtent->MinX = vals[0];
-                psExtent->MinY = vals[1];
-                psExtent->MaxX = vals[2];
-                psExtent->MaxY = vals[3];
-                eErr = OGRERR_NONE;
-            }
-        }
+    OGREnvelope oEnvelope;
+    poGeom->getEnvelope(&oEnvelope);
+    m_oCachedExtent.Merge(oEnvelope);
+    m_bExtentDirty = true;
+}
 
-        h2gis_free_result_buffer(thread, buffer);
+/**
+ * Forget the cached extent after rows were deleted or modified behind the
+ * layer, until the next forced GetExtent() recomputes it.
+ */
+void OGRH2GISLayer::InvalidateCachedExtent()
+{
+    if (m_bExtentStored)
+    {
+        m_poDS->DeleteStoredExtent(m_osTableName, m_osGeomCol);
+        m_bExtentStored = false;
     }
+    m_bExtentValid = false;
+    m_bExtentDirty = false;
+}
 
-    h2gis_close_query(thread, rs);
-    h2gis_close_query(thread, stmt);
+void OGRH2GISLayer::SetCachedExtent(const OGREnvelope &oExtent, bool bStored)
+{
+    m_oCachedExtent = oExtent;
+    m_bExtentValid = true;
+    m_bExtentDirty = false;
+    m_bExtentStored = bStored;
+}
 
-    return eErr;
+/**
+ * Save the cached extent in H2GIS_EXTENT_TABLE if it changed, so that the
+ * next session gets it without a scan. Empty extents are not saved.
+ */
+void OGRH2GISLayer::SaveCachedExtent()
+{
+    if (!m_bExtentDirty)
+        return;
+    if (!m_bExtentValid || !m_oCachedExtent.IsInit())
+    {
+        m_bExtentDirty = false;
+        return;
+    }
+    if (m_poDS->StoreExtent(m_osTableName, m_osGeomCol, m_oCachedExtent))
+    {
+        m_bExtentDirty = false;
+        m_bExtentStored = true;
+    }
 }
 
 #if GDAL_VERSION_NUM >= 3090000
@@ -1320,9 +2075,10 @@ OGRErr OGRH2GISLayer::CreateField(const OGRFieldDefn *poField, int bApproxOK)
 OGRErr OGRH2GISLayer::CreateField(OGRFieldDefn *poField, int bApproxOK)
 #endif
 {
-    // ALTER TABLE ADD COLUMN
-    // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
-    std::string sql = "ALTER TABLE \"" + m_osTableName + "\" ADD COLUMN \"";
+    m_poDS->InvalidateMetadataCache();
+
+    // Column definition
+    std::string sql = "\"";
     sql += poField->GetNameRef();
     sql += "\" ";
 
@@ -1359,129 +2115,204 @@ OGRErr OGRH2GISLayer::CreateField(OGRFieldDefn *poField, int bApproxOK)
             break;
     }
 
-    graal_isolatethread_t *thread =
-        (graal_isolatethread_t *)m_poDS->GetThread();
-    long long conn = m_poDS->GetConnection();
-
-    if (h2gis_execute(thread, conn, (char *)sql.c_str()) < 0)
+    if (!m_osDeferredTableSQL.empty())
     {
-        return OGRERR_FAILURE;
+        // Not created yet: the column joins the CREATE TABLE
+        m_osDeferredTableSQL += ", " + sql;
+    }
+    else
+    {
+        // DDL ends the current transaction: commit the pending inserts first
+        m_poDS->CommitImplicitTransaction();
+
+        // ALTER TABLE ADD COLUMN
+        // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
+        sql = "ALTER TABLE \"" + m_osTableName + "\" ADD COLUMN " + sql;
+        graal_isolatethread_t *thread =
+            (graal_isolatethread_t *)m_poDS->GetThread();
+        long long conn = m_poDS->GetConnection();
+
+        if (h2gis_execute(thread, conn, (char *)sql.c_str()) < 0)
+        {
+            return OGRERR_FAILURE;
+        }
     }
 
     m_poFeatureDefn->AddFieldDefn(poField);
+    ClearFIDBurstCache();  // Cached features lack the new field
+    ClearTileCache();
     return OGRERR_NONE;
 }
 
-OGRErr OGRH2GISLayer::ICreateFeature(OGRFeature *poFeature)
+/**
+ * Bind field iField of poFeature to parameter nParam (1-based) of a
+ * prepared statement. Null and unset fields are bound as SQL NULL.
+ */
+static void BindFeatureField(graal_isolatethread_t *thread, long long stmt,
+                             int nParam, OGRFeature *poFeature, int iField)
 {
-    // INSERT INTO "Table" (Fields...) VALUES (Values...)
-    // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
-
-    bool bReturnID = (poFeature->GetFID() == OGRNullFID);
-    std::string sql;
-
-    const std::string fidColName = m_osFIDCol.empty() ? "ID" : m_osFIDCol;
-    if (bReturnID)
-    {
-        // H2 syntax for returning keys: SELECT <FID> FROM FINAL TABLE (INSERT ...)
-        sql = "SELECT \"" + fidColName + "\" FROM FINAL TABLE (INSERT INTO \"" +
-              m_osTableName + "\" (";
-    }
-    else
+    if (!poFeature->IsFieldSetAndNotNull(iField))
     {
-        sql = "INSERT INTO \"" + m_osTableName + "\" (";
+        h2gis_bind_string(thread, stmt, nParam, nullptr);
+        return;
     }
 
-    std::string values = "VALUES (";
-
-    bool first = true;
-
-    // 1. FID
-    if (poFeature->GetFID() != OGRNullFID)
+    switch (poFeature->GetFieldDefnRef(iField)->GetType())
     {
-        sql += "\"" + fidColName + "\"";
-        values += std::to_string(poFeature->GetFID());
-        first = false;
+        case OFTInteger:
+            h2gis_bind_int(thread, stmt, nParam,
+                           poFeature->GetFieldAsInteger(iField));
+            break;
+        case OFTInteger64:
+            h2gis_bind_long(thread, stmt, nParam,
+                            poFeature->GetFieldAsInteger64(iField));
+            break;
+        case OFTReal:
+            h2gis_bind_double(thread, stmt, nParam,
+                              poFeature->GetFieldAsDouble(iField));
+            break;
+        case OFTDate:
+        case OFTTime:
+        case OFTDateTime:
+        {
+            // H2 parses YYYY-MM-DD, HH:MM:SS and YYYY-MM-DD HH:MM:SS
+            int year, month, day, hour, minute, tzflag;
+            float second;
+            poFeature->GetFieldAsDateTime(iField, &year, &month, &day, &hour,
+                                          &minute, &second, &tzflag);
+            const OGRFieldType eType =
+                poFeature->GetFieldDefnRef(iField)->GetType();
+            const char *pszValue =
+                eType == OFTDate
+                    ? CPLSPrintf("%04d-%02d-%02d", year, month, day)
+                : eType == OFTTime
+                    ? CPLSPrintf("%02d:%02d:%02d", hour, minute, (int)second)
+                    : CPLSPrintf("%04d-%02d-%02d %02d:%02d:%02d", year, month,
+                                 day, hour, minute, (int)second);
+            h2gis_bind_string(thread, stmt, nParam, (char *)pszValue);
+            break;
+        }
+        case OFTBinary:
+        {
+            int nBytes = 0;
+            GByte *pabyData = poFeature->GetFieldAsBinary(iField, &nBytes);
+            h2gis_bind_blob(thread, stmt, nParam, (char *)pabyData, nBytes);
+            break;
+        }
+        default:
+            h2gis_bind_string(thread, stmt, nParam,
+                              (char *)poFeature->GetFieldAsString(iField));
+            break;
     }
+}
 
-    // 2. Geometry
-    if (poFeature->GetGeometryRef() != nullptr)
+/**
+ * Export the geometry of poFeature as EWKB for an INSERT, UPDATE or MERGE
+ * parameter, or leave abyEWKB empty when the feature has no geometry.
+ */
+void OGRH2GISLayer::ExportFeatureGeometry(OGRFeature *poFeature,
+                                          std::vector<uint8_t> &abyEWKB)
+{
+    abyEWKB.clear();
+    OGRGeometry *poGeom = poFeature->GetGeometryRef();
+    if (poGeom != nullptr)
     {
-        if (!first)
-        {
-            sql += ", ";
-            values += ", ";
-        }
+        // Prepare geometry for export (flatten Z if target is 2D)
+        bool bFreeGeom = false;
+        OGRwkbGeometryType eTargetType = wkbUnknown;
+        if (m_poFeatureDefn->GetGeomFieldCount() > 0)
+            eTargetType = m_poFeatureDefn->GetGeomFieldDefn(0)->GetType();
+        OGRGeometry *poGeomToExport =
+            PrepareGeometryForExport(poGeom, eTargetType, bFreeGeom);
 
-        std::string geomName = "GEOM";
+        int nSRID = 0;
         if (m_poFeatureDefn->GetGeomFieldCount() > 0)
         {
-            const char *name =
-                m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef();
-            if (name && strlen(name) > 0)
-                geomName = std::string(name);
+            const OGRSpatialReference *poSRS =
+                m_poFeatureDefn->GetGeomFieldDefn(0)->GetSpatialRef();
+            if (poSRS)
+            {
+                const char *pszAuthName = poSRS->GetAuthorityName(nullptr);
+                const char *pszAuthCode = poSRS->GetAuthorityCode(nullptr);
+                if (pszAuthName && EQUAL(pszAuthName, "EPSG") && pszAuthCode)
+                {
+                    nSRID = atoi(pszAuthCode);
+                }
+            }
         }
 
-        sql += "\"" + geomName + "\"";
+        if (!H2GISExportToEWKB(poGeomToExport, nSRID, abyEWKB))
+            abyEWKB.clear();
+        if (bFreeGeom)
+            delete poGeomToExport;
+    }
+}
 
-        // Prepare geometry for export (flatten Z if target is 2D)
-        OGRGeometry *poGeom = poFeature->GetGeometryRef();
-        bool bFreeGeom = false;
-        OGRwkbGeometryType eTargetType = wkbUnknown;
-        if (m_poFeatureDefn->GetGeomFieldCount() > 0)
-            eTargetType = m_poFeatureDefn->GetGeomFieldDefn(0)->GetType();
-        OGRGeometry *poGeomToExport = PrepareGeometryForExport(poGeom, eTargetType, bFreeGeom);
-        
-        int nWkbSize = static_cast<int>(poGeomToExport->WkbSize());
-        unsigned char *pabyWkb = (unsigned char *)CPLMalloc(nWkbSize);
+OGRErr OGRH2GISLayer::ICreateFeature(OGRFeature *poFeature)
+{
+    // INSERT INTO "Table" (Fields...) VALUES (?, ...), prepared once per
+    // column list and kept in the statement cache: values are bound, so
+    // neither SQL text nor hex-encoded WKB is built per feature.
+    // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
 
-        if (poGeomToExport->exportToWkb(wkbNDR, pabyWkb) == OGRERR_NONE)
-        {
-            char *pszHex = CPLBinaryToHex(nWkbSize, pabyWkb);
+    if (CreateDeferredTable() != OGRERR_NONE)
+        return OGRERR_FAILURE;
 
-            int nSRID = 0;
-            if (m_poFeatureDefn->GetGeomFieldCount() > 0)
-            {
-                const OGRSpatialReference *poSRS =
-                    m_poFeatureDefn->GetGeomFieldDefn(0)->GetSpatialRef();
-                if (poSRS)
-                {
-                    const char *pszAuthName = poSRS->GetAuthorityName(nullptr);
-                    const char *pszAuthCode = poSRS->GetAuthorityCode(nullptr);
-                    if (pszAuthName && EQUAL(pszAuthName, "EPSG") &&
-                        pszAuthCode)
-                    {
-                        nSRID = atoi(pszAuthCode);
-                    }
-                }
-            }
+    bool bReturnID = (poFeature->GetFID() == OGRNullFID);
+    m_oKeysetIndex.clear();  // Feature indexes may shift
+    ClearFIDBurstCache();
+    ExtendCachedExtent(poFeature->GetGeometryRef());
 
-            if (nSRID > 0)
-            {
-                values += "ST_GeomFromWKB(X'";
-                values += pszHex;
-                values += "', " + std::to_string(nSRID) + ")";
-            }
-            else
-            {
-                values += "X'";
-                values += pszHex;
-                values += "'";
-            }
-            CPLFree(pszHex);
+    const std::string fidColName = m_osFIDCol.empty() ? "ID" : m_osFIDCol;
+
+    // Tables with a FID column go through the write buffer
+    if (!m_osFIDCol.empty())
+        return QueueInsert(poFeature);
+    FlushPendingInserts();  // Queued deletes come first
+    m_poDS->BeginImplicitTransaction();
+
+    // 1. Geometry, exported before the SQL so that a failure omits it
+    std::vector<uint8_t> abyEWKB;
+    ExportFeatureGeometry(poFeature, abyEWKB);
+
+    // 2. Column list
+    std::string sql;
+    std::string values = "VALUES (";
+    if (bReturnID)
+    {
+        // H2 syntax for returning keys: SELECT <FID> FROM FINAL TABLE (INSERT ...)
+        sql = "SELECT \"" + fidColName + "\" FROM FINAL TABLE (INSERT INTO \"" +
+              m_osTableName + "\" (";
+    }
+    else
+    {
+        sql = "INSERT INTO \"" + m_osTableName + "\" (";
+        sql += "\"" + fidColName + "\"";
+        values += "?";
+    }
+
+    const bool bHasGeom = !abyEWKB.empty();
+    if (bHasGeom)
+    {
+        std::string geomName = "GEOM";
+        if (m_poFeatureDefn->GetGeomFieldCount() > 0)
+        {
+            const char *name =
+                m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef();
+            if (name && strlen(name) > 0)
+                geomName = std::string(name);
         }
-        else
+        if (!bReturnID)
         {
-            values += "NULL";
+            sql += ", ";
+            values += ", ";
         }
-        CPLFree(pabyWkb);
-        if (bFreeGeom)
-            delete poGeomToExport;
-
-        first = false;
+        sql += "\"" + geomName + "\"";
+        values += "?";
     }
 
-    // 3. Attributes
+    // 3. Attributes (unset fields are left out, so that defaults apply)
+    std::vector<int> anBoundFields;
     int fieldCount = m_poFeatureDefn->GetFieldCount();
     for (int i = 0; i < fieldCount; i++)
     {
@@ -1496,79 +2327,16 @@ OGRErr OGRH2GISLayer::ICreateFeature(OGRFeature *poFeature)
             EQUAL(poFDefn->GetNameRef(), m_osFIDCol.c_str()))
             continue;
 
-        if (!first)
+        if (!bReturnID || bHasGeom || !anBoundFields.empty())
         {
             sql += ", ";
             values += ", ";
         }
-
         sql += "\"";
         sql += poFDefn->GetNameRef();
         sql += "\"";
-
-        switch (poFDefn->GetType())
-        {
-            case OFTInteger:
-                values += std::to_string(poFeature->GetFieldAsInteger(i));
-                break;
-            case OFTInteger64:
-                values += std::to_string(poFeature->GetFieldAsInteger64(i));
-                break;
-            case OFTReal:
-                // Use CPLSPrintf for locale-independent decimal formatting
-                values += CPLSPrintf("%.15g", poFeature->GetFieldAsDouble(i));
-                break;
-            case OFTString:
-            {
-                std::string s = poFeature->GetFieldAsString(i);
-                // Escape single quote
-                std::string escaped;
-                for (char c : s)
-                {
-                    if (c == '\'')
-                        escaped += "''";
-                    else
-                        escaped += c;
-                }
-                values += "'";
-                values += escaped;
-                values += "'";
-                break;
-            }
-            case OFTDate:
-            {
-                // H2 expects YYYY-MM-DD format
-                int year, month, day, hour, minute, tzflag;
-                float second;
-                poFeature->GetFieldAsDateTime(i, &year, &month, &day, &hour, &minute, &second, &tzflag);
-                values += CPLSPrintf("'%04d-%02d-%02d'", year, month, day);
-                break;
-            }
-            case OFTTime:
-            {
-                // H2 expects HH:MM:SS format
-                int year, month, day, hour, minute, tzflag;
-                float second;
-                poFeature->GetFieldAsDateTime(i, &year, &month, &day, &hour, &minute, &second, &tzflag);
-                values += CPLSPrintf("'%02d:%02d:%02d'", hour, minute, (int)second);
-                break;
-            }
-            case OFTDateTime:
-            {
-                // H2 expects YYYY-MM-DD HH:MM:SS format
-                int year, month, day, hour, minute, tzflag;
-                float second;
-                poFeature->GetFieldAsDateTime(i, &year, &month, &day, &hour, &minute, &second, &tzflag);
-                values += CPLSPrintf("'%04d-%02d-%02d %02d:%02d:%02d'", year, month, day, hour, minute, (int)second);
-                break;
-            }
-            default:
-                values += "'";
-                values += poFeature->GetFieldAsString(i);
-                values += "'";
-                break;
-        }
-        first = false;
+        values += "?";
+        anBoundFields.push_back(i);
     }
 
     sql += ") " + values + ")";
@@ -1580,281 +2348,1467 @@ OGRErr OGRH2GISLayer::ICreateFeature(OGRFeature *poFeature)
 
     graal_isolatethread_t *thread =
         (graal_isolatethread_t *)m_poDS->GetThread();
-    long long conn = m_poDS->GetConnection();
 
-    if (bReturnID)
+    long long hStmt = GetCachedStatement(sql);
+    if (!hStmt)
+        return OGRERR_FAILURE;
+
+    // Parameter indexes are 1-based (JDBC)
+    int nParam = 1;
+    if (!bReturnID)
+        h2gis_bind_long(thread, hStmt, nParam++, poFeature->GetFID());
+    if (bHasGeom)
+        h2gis_bind_blob(thread, hStmt, nParam++, (char *)abyEWKB.data(),
+                        static_cast<int>(abyEWKB.size()));
+    for (int iField : anBoundFields)
+        BindFeatureField(thread, hStmt, nParam++, poFeature, iField);
+
+    if (!bReturnID)
     {
-        long long hStmt = h2gis_prepare(thread, conn, (char *)sql.c_str());
-        if (!hStmt)
-            return OGRERR_FAILURE;
-        long long hRS = h2gis_execute_prepared(thread, hStmt);
-        if (!hRS)
-        {
-            h2gis_close_query(thread, hStmt);
+        if (h2gis_execute_prepared_update(thread, hStmt) < 0)
             return OGRERR_FAILURE;
-        }
+        AdjustFeatureCount(1);
+        return OGRERR_NONE;
+    }
 
-        long long sizeOut = 0;
-        void *pData = h2gis_fetch_one(thread, hRS, &sizeOut);
+    long long sizeOut = 0;
+    void *pData = h2gis_execute_prepared_first_row(thread, hStmt, &sizeOut);
+    if (!pData)
+        return OGRERR_FAILURE;
+    AdjustFeatureCount(1);
 
-        if (pData && sizeOut > 0)
+    if (sizeOut > 0)
+    {
+        std::vector<uint8_t *> apCursors;
+        std::vector<int> anTypes;
+        if (H2GISParseBatchBuffer(pData, apCursors, anTypes) > 0)
         {
-            uint8_t *ptr = (uint8_t *)pData;
-            // Skip col count (4 bytes)
-            ptr += 4;
-
-            // 1. Col Name
-            int32_t nameLen;
-            memcpy(&nameLen, ptr, 4);
-            ptr += 4;
-            ptr += nameLen;
-
-            // 2. Type
-            int32_t type;
-            memcpy(&type, ptr, 4);
-            ptr += 4;
-
-            if (type == H2GIS_TYPE_LONG)
+            if (anTypes[0] == H2GIS_TYPE_LONG)
             {
                 int64_t val;
-                memcpy(&val, ptr, 8);
+                memcpy(&val, apCursors[0], 8);
                 poFeature->SetFID((GIntBig)val);
             }
-            else if (type == H2GIS_TYPE_INT)
+            else if (anTypes[0] == H2GIS_TYPE_INT)
             {
                 int32_t val;
-                memcpy(&val, ptr, 4);
+                memcpy(&val, apCursors[0], 4);
                 poFeature->SetFID((GIntBig)val);
             }
-
-            h2gis_free_result_buffer(thread, pData);
-        }
-        else
-        {
-            // Failed to get ID
-        }
-        h2gis_close_query(thread, hRS);
-        h2gis_close_query(thread, hStmt);
-    }
-    else
-    {
-        if (h2gis_execute(thread, conn, (char *)sql.c_str()) < 0)
-        {
-            return OGRERR_FAILURE;
         }
     }
+    h2gis_free_result_buffer(thread, pData);
 
     return OGRERR_NONE;
 }
 
-OGRErr OGRH2GISLayer::ISetFeature(OGRFeature *poFeature)
+/**
+ * Run a query returning an integer in its first column, binding aosParams
+ * as strings, and store the value of the first row in *pnValue.
+ *
+ * @return false if the query failed or returned no integer.
+ */
+bool H2GISFetchFirstInt64(graal_isolatethread_t *thread, long long conn,
+                          const std::string &osSQL,
+                          const std::vector<std::string> &aosParams,
+                          GIntBig *pnValue)
 {
-    if (poFeature->GetFID() == OGRNullFID)
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "SetFeature: FID required for update");
-        return OGRERR_FAILURE;
-    }
-
-    // UPDATE "Table" SET col1=val1, col2=val2, ... WHERE ID = fid
-    // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
-    std::string sql = "UPDATE \"" + m_osTableName + "\" SET ";
+    std::vector<char *> apszParams;
+    for (const std::string &osParam : aosParams)
+        apszParams.push_back(const_cast<char *>(osParam.c_str()));
 
-    bool first = true;
+    long long sizeOut = 0;
+    void *buffer = h2gis_query_first_row(
+        thread, conn, (char *)osSQL.c_str(), apszParams.data(),
+        static_cast<int>(apszParams.size()), &sizeOut);
+    if (!buffer)
+        return false;
 
-    // 1. Geometry
-    if (poFeature->GetGeometryRef() != nullptr)
+    bool bOK = false;
+    std::vector<uint8_t *> apCursors;
+    std::vector<int> anTypes;
+    if (sizeOut > 0 &&
+        H2GISParseBatchBuffer(buffer, apCursors, anTypes) > 0)
     {
-        std::string geomName = "GEOM";
-        if (m_poFeatureDefn->GetGeomFieldCount() > 0)
+        if (anTypes[0] == H2GIS_TYPE_LONG)
         {
-            const char *name =
-                m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef();
-            if (name && strlen(name) > 0)
-                geomName = std::string(name);
+            int64_t val;
+            memcpy(&val, apCursors[0], 8);
+            *pnValue = val;
+            bOK = true;
+        }
+        else if (anTypes[0] == H2GIS_TYPE_INT)
+        {
+            int32_t val;
+            memcpy(&val, apCursors[0], 4);
+            *pnValue = val;
+            bOK = true;
         }
+    }
+    h2gis_free_result_buffer(thread, buffer);
+    return bOK;
+}
 
-        sql += "\"" + geomName + "\" = ";
+/**
+ * Split the scan of osSQL in PARALLEL_SCAN ranges of _ROWID_, each run on
+ * its own connection (see OGRH2GISDataSource::GetScanConnection()) with its
+ * first batch requested immediately, so that all of them are queried and
+ * serialized concurrently by the worker threads. Batches are then handed out
+ * round-robin (see FetchNextPartitionBatch()), so the scan is unordered.
+ *
+ * @param osSQL Scan query, without ORDER BY nor OFFSET.
+ * @param bHasWhere Whether osSQL already has a WHERE clause.
+ * @return false if the table is too small to be split or a range could not
+ *         be queried, in which case the caller runs osSQL as a single query.
+ */
+bool OGRH2GISLayer::StartParallelScan(const std::string &osSQL,
+                                      bool bHasWhere)
+{
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    long long conn = m_poDS->GetConnection();
 
-        // Prepare geometry for export (flatten Z if target is 2D)
-        OGRGeometry *poGeom = poFeature->GetGeometryRef();
-        bool bFreeGeom = false;
-        OGRwkbGeometryType eTargetType = wkbUnknown;
-        if (m_poFeatureDefn->GetGeomFieldCount() > 0)
-            eTargetType = m_poFeatureDefn->GetGeomFieldDefn(0)->GetType();
-        OGRGeometry *poGeomToExport = PrepareGeometryForExport(poGeom, eTargetType, bFreeGeom);
-        
-        int nWkbSize = static_cast<int>(poGeomToExport->WkbSize());
-        unsigned char *pabyWkb = (unsigned char *)CPLMalloc(nWkbSize);
+    // Rows inserted by the driver must be visible to the other connections
+    if (m_poDS->CommitImplicitTransaction() != OGRERR_NONE)
+        return false;
 
-        if (poGeomToExport->exportToWkb(wkbNDR, pabyWkb) == OGRERR_NONE)
-        {
-            char *pszHex = CPLBinaryToHex(nWkbSize, pabyWkb);
+    GIntBig nMin = 0;
+    GIntBig nMax = 0;
+    if (!H2GISFetchFirstInt64(thread, conn,
+                              "SELECT COALESCE(MIN(_ROWID_), 0) FROM \"" +
+                                  m_osTableName + "\"",
+                              {}, &nMin) ||
+        !H2GISFetchFirstInt64(thread, conn,
+                              "SELECT COALESCE(MAX(_ROWID_), -1) FROM \"" +
+                                  m_osTableName + "\"",
+                              {}, &nMax))
+        return false;
 
-            int nSRID = 0;
-            if (m_poFeatureDefn->GetGeomFieldCount() > 0)
-            {
-                const OGRSpatialReference *poSRS =
-                    m_poFeatureDefn->GetGeomFieldDefn(0)->GetSpatialRef();
-                if (poSRS)
-                {
-                    const char *pszAuthName = poSRS->GetAuthorityName(nullptr);
-                    const char *pszAuthCode = poSRS->GetAuthorityCode(nullptr);
-                    if (pszAuthName && EQUAL(pszAuthName, "EPSG") &&
-                        pszAuthCode)
-                    {
-                        nSRID = atoi(pszAuthCode);
-                    }
-                }
-            }
+    const GIntBig nSpan = nMax - nMin + 1;
+    const int nPartitions = static_cast<int>(std::min<GIntBig>(
+        m_poDS->GetParallelScan(), nSpan / H2GIS_PARALLEL_SCAN_MIN_ROWS));
+    if (nPartitions < 2)
+        return false;
 
-            if (nSRID > 0)
-            {
-                sql += "ST_GeomFromWKB(X'";
-                sql += pszHex;
-                sql += "', " + std::to_string(nSRID) + ")";
-            }
-            else
-            {
-                sql += "X'";
-                sql += pszHex;
-                sql += "'";
-            }
-            CPLFree(pszHex);
+    const GIntBig nStep = nSpan / nPartitions;
+    for (int i = 0; i < nPartitions; i++)
+    {
+        const GIntBig nLow = nMin + i * nStep;
+        const GIntBig nHigh = i == nPartitions - 1 ? nMax + 1 : nLow + nStep;
+        const std::string osPartitionSQL =
+            osSQL + (bHasWhere ? " AND " : " WHERE ") + "_ROWID_ >= " +
+            std::to_string(nLow) + " AND _ROWID_ < " + std::to_string(nHigh);
+
+        H2GISScanPartition oPartition = {0, 0, nullptr, 0};
+        const long long hConn = m_poDS->GetScanConnection(i);
+        if (hConn > 0)
+            oPartition.hStmt =
+                h2gis_prepare(thread, hConn, (char *)osPartitionSQL.c_str());
+        if (oPartition.hStmt)
+        {
+            BindSpatialFilter(oPartition.hStmt);
+            oPartition.hRS = h2gis_execute_prepared(thread, oPartition.hStmt);
         }
+        if (oPartition.hRS)
+            CountQuery();
         else
         {
-            sql += "NULL";
+            ClosePartition(oPartition);
+            for (H2GISScanPartition &oStarted : m_aoScanPartitions)
+                ClosePartition(oStarted);
+            m_aoScanPartitions.clear();
+            return false;
         }
-        CPLFree(pabyWkb);
-        if (bFreeGeom)
-            delete poGeomToExport;
 
-        first = false;
+        oPartition.nRequestedRows = m_oBatchSizer.GetRows();
+        oPartition.hFetch = h2gis_fetch_batch_async(
+            thread, oPartition.hRS, oPartition.nRequestedRows);
+        m_aoScanPartitions.push_back(oPartition);
     }
 
-    // 2. Attributes
-    int fieldCount = m_poFeatureDefn->GetFieldCount();
-    for (int i = 0; i < fieldCount; i++)
-    {
-        OGRFieldDefn *poFDefn = m_poFeatureDefn->GetFieldDefn(i);
+    m_iScanPartition = 0;
+    m_bQueryOrderedByFID = false;
+    LogLayer("PrepareQuery with parallel scan",
+             std::to_string(nPartitions).c_str());
+    return true;
+}
 
-        // Skip FID field (it's the primary key)
-        if (!m_osFIDCol.empty() &&
-            EQUAL(poFDefn->GetNameRef(), m_osFIDCol.c_str()))
-            continue;
+/**
+ * FetchNextBatch() of a parallel scan: take the pending batch of the next
+ * partition and immediately request the following one of that partition,
+ * or drop the partition once its range is exhausted.
+ */
+bool OGRH2GISLayer::FetchNextPartitionBatch()
+{
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
 
-        if (!first)
-            sql += ", ";
+    while (!m_aoScanPartitions.empty())
+    {
+        if (m_iScanPartition >= m_aoScanPartitions.size())
+            m_iScanPartition = 0;
+        H2GISScanPartition &oPartition = m_aoScanPartitions[m_iScanPartition];
 
-        sql += "\"";
-        sql += poFDefn->GetNameRef();
-        sql += "\" = ";
+        long long sizeOut = 0;
+        const auto oFetchStart = std::chrono::steady_clock::now();
+        void *pBuffer = h2gis_fetch_batch_wait(oPartition.hFetch, &sizeOut);
+        oPartition.hFetch = nullptr;
+        const GIntBig nWaitUs = H2GISElapsedUs(oFetchStart);
+
+        if (m_pBatchBuffer)
+            h2gis_release_result_buffer(thread, m_pBatchBuffer);
+        m_pBatchBuffer = pBuffer;
+        m_nBatchRows = pBuffer && sizeOut > 0
+                           ? H2GISParseBatchBuffer(pBuffer, m_columnValues,
+                                                   m_columnTypes)
+                           : 0;
+        CountBatch(m_nBatchRows, sizeOut, nWaitUs);
+        if (m_nBatchRows > 0)
+        {
+            m_oBatchSizer.Update(m_nBatchRows, sizeOut);
+            if (m_aoDecodePlan.empty())
+                H2GISBuildDecodePlan(m_poFeatureDefn, m_columnTypes,
+                                     m_anColumnFieldIndex, m_aoDecodePlan);
+        }
 
-        if (!poFeature->IsFieldSet(i) || poFeature->IsFieldNull(i))
+        // A short batch means the range is exhausted
+        if (m_nBatchRows > 0 && m_nBatchRows >= oPartition.nRequestedRows)
         {
-            sql += "NULL";
+            oPartition.nRequestedRows = m_oBatchSizer.GetRows();
+            oPartition.hFetch = h2gis_fetch_batch_async(
+                thread, oPartition.hRS, oPartition.nRequestedRows);
+            m_iScanPartition++;
         }
         else
         {
-            switch (poFDefn->GetType())
-            {
-                case OFTInteger:
-                    sql += std::to_string(poFeature->GetFieldAsInteger(i));
-                    break;
-                case OFTInteger64:
-                    sql += std::to_string(poFeature->GetFieldAsInteger64(i));
-                    break;
-                case OFTReal:
-                    // Use CPLSPrintf for locale-independent decimal formatting
-                    sql += CPLSPrintf("%.15g", poFeature->GetFieldAsDouble(i));
-                    break;
-                case OFTString:
-                {
-                    std::string s = poFeature->GetFieldAsString(i);
-                    std::string escaped;
-                    for (char c : s)
-                    {
-                        if (c == '\'')
-                            escaped += "''";
-                        else
-                            escaped += c;
-                    }
-                    sql += "'";
-                    sql += escaped;
-                    sql += "'";
-                    break;
-                }
-                case OFTDate:
-                {
-                    int year, month, day, hour, minute, tzflag;
-                    float second;
-                    poFeature->GetFieldAsDateTime(i, &year, &month, &day, &hour, &minute, &second, &tzflag);
-                    sql += CPLSPrintf("'%04d-%02d-%02d'", year, month, day);
-                    break;
-                }
-                case OFTTime:
-                {
-                    int year, month, day, hour, minute, tzflag;
-                    float second;
-                    poFeature->GetFieldAsDateTime(i, &year, &month, &day, &hour, &minute, &second, &tzflag);
-                    sql += CPLSPrintf("'%02d:%02d:%02d'", hour, minute, (int)second);
-                    break;
-                }
-                case OFTDateTime:
-                {
-                    int year, month, day, hour, minute, tzflag;
-                    float second;
-                    poFeature->GetFieldAsDateTime(i, &year, &month, &day, &hour, &minute, &second, &tzflag);
-                    sql += CPLSPrintf("'%04d-%02d-%02d %02d:%02d:%02d'", year, month, day, hour, minute, (int)second);
-                    break;
-                }
-                default:
-                    sql += "'";
-                    sql += poFeature->GetFieldAsString(i);
-                    sql += "'";
-                    break;
-            }
+            ClosePartition(oPartition);
+            m_aoScanPartitions.erase(m_aoScanPartitions.begin() +
+                                     m_iScanPartition);
         }
-        first = false;
-    }
 
-    std::string fidCol =
-        m_osFIDCol.empty() ? "_ROWID_" : ("\"" + m_osFIDCol + "\"");
-    sql += " WHERE " + fidCol + " = " + std::to_string(poFeature->GetFID());
+        if (m_nBatchRows > 0)
+        {
+            m_iNextRowInBatch = 0;
+            return true;
+        }
+    }
+    return false;
+}
 
+void OGRH2GISLayer::ClosePartition(H2GISScanPartition &oPartition)
+{
     graal_isolatethread_t *thread =
         (graal_isolatethread_t *)m_poDS->GetThread();
-    long long conn = m_poDS->GetConnection();
-
-    if (h2gis_execute(thread, conn, (char *)sql.c_str()) < 0)
+    if (oPartition.hFetch)
     {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "SetFeature: SQL execution failed");
-        return OGRERR_FAILURE;
+        // Collect the in-flight batch before its result set is closed
+        void *pBuffer = h2gis_fetch_batch_wait(oPartition.hFetch, nullptr);
+        oPartition.hFetch = nullptr;
+        if (pBuffer)
+            h2gis_free_result_buffer(thread, pBuffer);
+    }
+    if (oPartition.hRS)
+    {
+        h2gis_close_query(thread, oPartition.hRS);
+        oPartition.hRS = 0;
+    }
+    if (oPartition.hStmt)
+    {
+        h2gis_close_query(thread, oPartition.hStmt);
+        oPartition.hStmt = 0;
     }
-
-    return OGRERR_NONE;
 }
 
-OGRErr OGRH2GISLayer::DeleteFeature(GIntBig nFID)
+/**
+ * Start giving FIDs to buffered features. Rows of an identity FID column
+ * get theirs from the identity when inserted (see ExecutePendingInserts()),
+ * so they are given from its next value, which also counts the values
+ * other connections took without committing yet. Otherwise they are given
+ * from MAX(fid) + 1, which assumes that no other connection inserts into
+ * the table meanwhile. They are allocated again after each commit (see
+ * OnTransactionCommitted()).
+ */
+bool OGRH2GISLayer::AllocateFIDs()
 {
-    // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
-    std::string fidCol =
+    m_bFIDIdentity = FetchIdentityBase(&m_nNextFID);
+    if (m_bFIDIdentity)
+        return true;
+
+    GIntBig nMaxFID = 0;
+    if (!H2GISFetchFirstInt64((graal_isolatethread_t *)m_poDS->GetThread(),
+                              m_poDS->GetConnection(),
+                              "SELECT COALESCE(MAX(\"" + m_osFIDCol +
+                                  "\"), 0) FROM \"" + m_osTableName + "\"",
+                              {}, &nMaxFID))
+        return false;
+    m_nNextFID = nMaxFID + 1;
+    return true;
+}
+
+/**
+ * Next value of the FID column identity, which counts the values handed
+ * out to every connection, committed or not.
+ *
+ * @return false if the FID column is not an identity column.
+ */
+bool OGRH2GISLayer::FetchIdentityBase(GIntBig *pnBase)
+{
+    return H2GISFetchFirstInt64(
+        (graal_isolatethread_t *)m_poDS->GetThread(), m_poDS->GetConnection(),
+        "SELECT IDENTITY_BASE FROM INFORMATION_SCHEMA.COLUMNS "
+        "WHERE TABLE_NAME = ? AND COLUMN_NAME = ? AND IS_IDENTITY = 'YES'",
+        {m_osTableName, m_osFIDCol}, pnBase);
+}
+
+/**
+ * Queue a feature in the write buffer. Features sharing the same column
+ * list are inserted together by one multi-row INSERT when the buffer is
+ * full (H2GIS_INSERT_BUFFER_ROWS / H2GIS_INSERT_BUFFER_BYTES), and before
+ * anything reads, updates or commits the table. The FID is given here, so
+ * that the caller gets it back as with an immediate insert (see
+ * AllocateFIDs()); errors (e.g. a duplicate explicit FID) are only reported
+ * by the flush.
+ */
+OGRErr OGRH2GISLayer::QueueInsert(OGRFeature *poFeature)
+{
+    if (!m_anPendingDeletes.empty())
+    {
+        const OGRErr eErr = FlushPendingDeletes();
+        if (eErr != OGRERR_NONE)
+            return eErr;
+    }
+    m_poDS->BeginImplicitTransaction();
+
+    const bool bNewFID = poFeature->GetFID() == OGRNullFID;
+    if (bNewFID && m_nNextFID <= 0 && !AllocateFIDs())
+        return OGRERR_FAILURE;
+    const bool bGeneratedFID = bNewFID && m_bFIDIdentity;
+
+    // Column list: FID (unless generated), geometry (NULL when missing, so
+    // that features with and without geometry share one statement), then
+    // the set fields, as unset fields are left out so that defaults apply
+    const bool bHasGeomField = m_poFeatureDefn->GetGeomFieldCount() > 0;
+    std::string osColumns;
+    if (!bGeneratedFID)
+        osColumns = "\"" + m_osFIDCol + "\"";
+    if (bHasGeomField)
+    {
+        if (!osColumns.empty())
+            osColumns += ", ";
+        osColumns += "\"";
+        osColumns += m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef();
+        osColumns += "\"";
+    }
+    std::vector<int> anFields;
+    for (int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++)
+    {
+        OGRFieldDefn *poFDefn = m_poFeatureDefn->GetFieldDefn(i);
+        if (!poFeature->IsFieldSet(i) ||
+            EQUAL(poFDefn->GetNameRef(), m_osFIDCol.c_str()))
+            continue;
+        if (!osColumns.empty())
+            osColumns += ", ";
+        osColumns += "\"";
+        osColumns += poFDefn->GetNameRef();
+        osColumns += "\"";
+        anFields.push_back(i);
+    }
+
+    // A failure of the flush belongs to features queued before: this one
+    // is still queued
+    OGRErr eErr = OGRERR_NONE;
+    if (osColumns != m_osPendingColumns ||
+        bGeneratedFID != m_bPendingKeys)
+    {
+        eErr = FlushPendingInserts();
+        m_osPendingColumns = osColumns;
+        m_anPendingFields = anFields;
+        m_bPendingKeys = bGeneratedFID;
+    }
+
+    // Given after the flush, which catches up with the identity
+    if (bNewFID)
+        poFeature->SetFID(m_nNextFID++);
+    else if (!m_bFIDIdentity && m_nNextFID > 0 &&
+             poFeature->GetFID() >= m_nNextFID)
+        m_nNextFID = poFeature->GetFID() + 1;
+
+    OGRFeature *poRow = new OGRFeature(m_poFeatureDefn);
+    poRow->SetFID(poFeature->GetFID());
+    for (int iField : anFields)
+    {
+        const OGRField *psField = poFeature->GetRawFieldRef(iField);
+        poRow->SetField(iField, psField);
+        if (poFeature->IsFieldNull(iField))
+            continue;
+        switch (m_poFeatureDefn->GetFieldDefn(iField)->GetType())
+        {
+            case OFTString:
+                m_nPendingBytes += strlen(psField->String);
+                break;
+            case OFTBinary:
+                m_nPendingBytes += psField->Binary.nCount;
+                break;
+            default:
+                m_nPendingBytes += 8;
+                break;
+        }
+    }
+    m_apoPendingInserts.push_back(poRow);
+    m_aabyPendingEWKB.emplace_back();
+    if (bHasGeomField)
+        ExportFeatureGeometry(poFeature, m_aabyPendingEWKB.back());
+    m_nPendingBytes += m_aabyPendingEWKB.back().size();
+    AdjustFeatureCount(1);  // Undone if the flush fails
+
+    if (m_apoPendingInserts.size() >=
+            static_cast<size_t>(H2GIS_INSERT_BUFFER_ROWS) ||
+        m_nPendingBytes >= H2GIS_INSERT_BUFFER_BYTES)
+    {
+        const OGRErr eFlushErr = FlushPendingInserts();
+        if (eErr == OGRERR_NONE)
+            eErr = eFlushErr;
+    }
+    return eErr;
+}
+
+/**
+ * Build the multi-row INSERT of the write buffer.
+ *
+ * @param osTableName Table inserted into.
+ * @param osColumns Quoted column list, without parentheses.
+ * @param nParams Number of parameters of a row.
+ * @param nRows Number of rows inserted.
+ * @return INSERT INTO "table" (columns) VALUES (?, ...), ... with nRows rows.
+ */
+std::string H2GISBuildInsertSQL(const std::string &osTableName,
+                                const std::string &osColumns, size_t nParams,
+                                int nRows)
+{
+    std::string osRow = "(";
+    for (size_t i = 0; i < nParams; i++)
+        osRow += i ? ", ?" : "?";
+    osRow += ")";
+    std::string sql;
+    sql.reserve(osTableName.size() + osColumns.size() + 32 +
+                (osRow.size() + 2) * static_cast<size_t>(nRows));
+    sql = "INSERT INTO \"" + osTableName + "\" (" + osColumns + ") VALUES " +
+          osRow;
+    for (int i = 1; i < nRows; i++)
+    {
+        sql += ", ";
+        sql += osRow;
+    }
+    return sql;
+}
+
+/**
+ * Bind rows [iFirst, iFirst + nRows) of the write buffer to hStmt, built by
+ * H2GISBuildInsertSQL() for nRows rows, and run it. When the FIDs are left
+ * to the identity, the statement selects them FROM FINAL TABLE (INSERT
+ * ...), and they are compared with the ones given by QueueInsert().
+ *
+ * @param pnMovedFIDs Incremented for each row inserted with another FID.
+ * @return false if the INSERT failed.
+ */
+bool OGRH2GISLayer::ExecutePendingInserts(long long hStmt, int iFirst,
+                                          int nRows, int *pnMovedFIDs)
+{
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    const bool bHasGeomField = m_poFeatureDefn->GetGeomFieldCount() > 0;
+
+    // Parameter indexes are 1-based (JDBC)
+    int nParam = 1;
+    for (int iRow = iFirst; iRow < iFirst + nRows; iRow++)
+    {
+        OGRFeature *poRow = m_apoPendingInserts[iRow];
+        if (!m_bPendingKeys)
+            h2gis_bind_long(thread, hStmt, nParam++, poRow->GetFID());
+        if (bHasGeomField)
+        {
+            std::vector<uint8_t> &abyEWKB = m_aabyPendingEWKB[iRow];
+            if (abyEWKB.empty())
+                h2gis_bind_string(thread, hStmt, nParam++, nullptr);
+            else
+                h2gis_bind_blob(thread, hStmt, nParam++,
+                                (char *)abyEWKB.data(),
+                                static_cast<int>(abyEWKB.size()));
+        }
+        for (int iField : m_anPendingFields)
+            BindFeatureField(thread, hStmt, nParam++, poRow, iField);
+    }
+    if (!m_bPendingKeys)
+        return h2gis_execute_prepared_update(thread, hStmt) >= 0;
+
+    const long long hRS = h2gis_execute_prepared(thread, hStmt);
+    if (!hRS)
+        return false;
+    long long nSize = 0;
+    void *pBuffer = h2gis_fetch_batch(thread, hRS, nRows, &nSize);
+    std::vector<uint8_t *> apCursors;
+    std::vector<int> anTypes;
+    const int nKeys = pBuffer && nSize > 0
+                          ? H2GISParseBatchBuffer(pBuffer, apCursors, anTypes)
+                          : 0;
+    // Keys come in VALUES order
+    for (int i = 0; i < nKeys && i < nRows; i++)
+    {
+        GIntBig nFID = OGRNullFID;
+        if (anTypes[0] == H2GIS_TYPE_LONG)
+        {
+            int64_t val;
+            memcpy(&val, apCursors[0] + 8 * i, 8);
+            nFID = val;
+        }
+        else if (anTypes[0] == H2GIS_TYPE_INT)
+        {
+            int32_t val;
+            memcpy(&val, apCursors[0] + 4 * i, 4);
+            nFID = val;
+        }
+        if (nFID != m_apoPendingInserts[iFirst + i]->GetFID())
+            (*pnMovedFIDs)++;
+        m_nNextFID = std::max(m_nNextFID, nFID + 1);
+    }
+    if (pBuffer)
+        h2gis_free_result_buffer(thread, pBuffer);
+    h2gis_close_query(thread, hRS);
+    return nKeys == nRows;
+}
+
+/**
+ * Insert the features of the write buffer with one multi-row INSERT.
+ * Full buffers always have the same shape, so their statement is kept in
+ * the statement cache; partial flushes use a one-off statement. If it
+ * fails, the rows are inserted again one at a time, so that only the
+ * failing ones are lost.
+ */
+OGRErr OGRH2GISLayer::FlushPendingInserts()
+{
+    // Anything flushed or read needs the table
+    if (!m_osDeferredTableSQL.empty() && CreateDeferredTable() != OGRERR_NONE)
+        return OGRERR_FAILURE;
+    // Deletes and inserts are never queued together (see DeleteFeature)
+    if (!m_anPendingDeletes.empty())
+        return FlushPendingDeletes();
+    if (m_apoPendingInserts.empty())
+        return OGRERR_NONE;
+
+    const int nRows = static_cast<int>(m_apoPendingInserts.size());
+    const bool bHasGeomField = m_poFeatureDefn->GetGeomFieldCount() > 0;
+    const size_t nParams = (m_bPendingKeys ? 0 : 1) +
+                           (bHasGeomField ? 1 : 0) + m_anPendingFields.size();
+    const std::string osKeys =
+        m_bPendingKeys ? "SELECT \"" + m_osFIDCol + "\" FROM FINAL TABLE ("
+                       : std::string();
+    const auto BuildSQL = [&](int nStatementRows)
+    {
+        std::string osSQL = osKeys + H2GISBuildInsertSQL(m_osTableName,
+                                                         m_osPendingColumns,
+                                                         nParams,
+                                                         nStatementRows);
+        if (m_bPendingKeys)
+            osSQL += ")";
+        return osSQL;
+    };
+
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    const std::string sql = BuildSQL(nRows);
+    const bool bCached = nRows == H2GIS_INSERT_BUFFER_ROWS || nRows == 1;
+    long long hStmt =
+        bCached ? GetCachedStatement(sql)
+                : h2gis_prepare(thread, m_poDS->GetConnection(),
+                                (char *)sql.c_str());
+
+    int nMovedFIDs = 0;
+    int nFailed = 0;
+    const bool bOK =
+        hStmt && ExecutePendingInserts(hStmt, 0, nRows, &nMovedFIDs);
+    if (hStmt && !bCached)
+        h2gis_close_query(thread, hStmt);
+
+    if (!bOK && nRows > 1)
+    {
+        CPLDebug("H2GIS",
+                 "Multi-row INSERT into %s failed, inserting its %d rows "
+                 "one at a time",
+                 m_osTableName.c_str(), nRows);
+        const long long hRowStmt = GetCachedStatement(BuildSQL(1));
+        for (int iRow = 0; iRow < nRows; iRow++)
+        {
+            if (hRowStmt &&
+                ExecutePendingInserts(hRowStmt, iRow, 1, &nMovedFIDs))
+                continue;
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "H2GIS: Failed to insert buffered feature " CPL_FRMT_GIB
+                     " into %s",
+                     m_apoPendingInserts[iRow]->GetFID(),
+                     m_osTableName.c_str());
+            nFailed++;
+        }
+    }
+    else if (!bOK)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "H2GIS: Failed to insert buffered feature " CPL_FRMT_GIB
+                 " into %s",
+                 m_apoPendingInserts[0]->GetFID(), m_osTableName.c_str());
+        nFailed = 1;
+    }
+
+    if (nMovedFIDs > 0)
+    {
+        // Another connection inserted since the FIDs were given, or a
+        // failed INSERT used up identity values
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "H2GIS: %d features inserted into %s got another FID than "
+                 "the one returned by CreateFeature()",
+                 nMovedFIDs, m_osTableName.c_str());
+    }
+    if (nFailed > 0)
+        AdjustFeatureCount(-nFailed);
+
+    DiscardPendingInserts();
+    return nFailed > 0 ? OGRERR_FAILURE : OGRERR_NONE;
+}
+
+void OGRH2GISLayer::DiscardPendingInserts()
+{
+    for (OGRFeature *poRow : m_apoPendingInserts)
+        delete poRow;
+    m_apoPendingInserts.clear();
+    m_aabyPendingEWKB.clear();
+    m_nPendingBytes = 0;
+    m_anPendingDeletes.clear();
+}
+
+void OGRH2GISLayer::OnTransactionCommitted()
+{
+    // Other connections may insert before the next transaction, whose FIDs
+    // are allocated again (see AllocateFIDs())
+    m_nNextFID = 0;
+}
+
+void OGRH2GISLayer::OnTransactionRolledBack()
+{
+    DiscardPendingInserts();
+    // The rollback may have restored the saved extent of the layer
+    m_bExtentStored = m_poDS->HasExtentTable();
+    InvalidateCachedData();
+}
+
+OGRErr OGRH2GISLayer::SyncToDisk()
+{
+    OGRErr eErr = FlushPendingInserts();
+    if (m_poDS->CommitImplicitTransaction() != OGRERR_NONE)
+        eErr = OGRERR_FAILURE;
+    BuildDeferredSpatialIndex();
+    if (!m_poDS->IsInTransaction())
+        SaveCachedExtent();
+    return eErr;
+}
+
+/**
+ * Run the CREATE TABLE postponed by ICreateLayer(), with every field
+ * created since, then the spatial index it was created with. One statement
+ * replaces an ALTER TABLE ... ADD COLUMN per CreateField(), each of which
+ * would rewrite the table in H2.
+ */
+OGRErr OGRH2GISLayer::CreateDeferredTable()
+{
+    if (m_osDeferredTableSQL.empty())
+        return OGRERR_NONE;
+    // Cleared first: committing flushes this layer again
+    const std::string sql = m_osDeferredTableSQL + ")";
+    m_osDeferredTableSQL.clear();
+
+    // DDL ends the current transaction: commit the pending inserts first
+    m_poDS->CommitImplicitTransaction();
+
+    LogLayer("Creating deferred table", sql.c_str());
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    if (h2gis_execute(thread, m_poDS->GetConnection(), (char *)sql.c_str()) <
+        0)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "H2GIS: Failed to create table %s", m_osTableName.c_str());
+        return OGRERR_FAILURE;
+    }
+
+    if (m_bDeferredTableIndex && !m_osGeomCol.empty())
+    {
+        std::string idxSql = "CREATE SPATIAL INDEX ON \"" + m_osTableName +
+                             "\"(\"" + m_osGeomCol + "\")";
+        h2gis_execute(thread, m_poDS->GetConnection(),
+                      (char *)idxSql.c_str());
+    }
+    return OGRERR_NONE;
+}
+
+/**
+ * Create the spatial index postponed by SPATIAL_INDEX=DEFERRED. Building
+ * it once over the loaded rows avoids maintaining the R-tree on every
+ * insert. CREATE SPATIAL INDEX is DDL and would commit a transaction
+ * started by StartTransaction(), so the build waits until none is active.
+ */
+void OGRH2GISLayer::BuildDeferredSpatialIndex()
+{
+    if (!m_bDeferredSpatialIndex || m_osGeomCol.empty() ||
+        m_poDS->IsInTransaction())
+        return;
+    m_bDeferredSpatialIndex = false;
+
+    FlushPendingInserts();
+    m_poDS->CommitImplicitTransaction();
+
+    LogLayer("Building deferred spatial index", m_osTableName.c_str());
+    std::string sql = "CREATE SPATIAL INDEX ON \"" + m_osTableName + "\"(\"" +
+                      m_osGeomCol + "\")";
+    if (h2gis_execute((graal_isolatethread_t *)m_poDS->GetThread(),
+                      m_poDS->GetConnection(), (char *)sql.c_str()) < 0)
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "H2GIS: Failed to create the deferred spatial index of %s",
+                 m_osTableName.c_str());
+    }
+}
+
+/**
+ * UPDATE of every field of the feature, and of its geometry unless it has
+ * none, through a prepared statement kept in the statement cache: features
+ * with the same shape (geometry or not) reuse it and are only bound.
+ */
+OGRErr OGRH2GISLayer::ISetFeature(OGRFeature *poFeature)
+{
+    FlushPendingInserts();
+    if (poFeature->GetFID() == OGRNullFID)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "SetFeature: FID required for update");
+        return OGRERR_FAILURE;
+    }
+    m_poDS->BeginImplicitTransaction();
+
+    // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
+    m_oKeysetIndex.clear();  // The feature may leave the attribute filter
+    ClearFIDBurstCache();
+    ExtendCachedExtent(poFeature->GetGeometryRef());
+    AdjustFeatureCount(0);  // The feature may enter or leave filters
+
+    // 1. Geometry, set to NULL if it cannot be exported
+    const bool bHasGeom = poFeature->GetGeometryRef() != nullptr &&
+                          m_poFeatureDefn->GetGeomFieldCount() > 0;
+    std::vector<uint8_t> abyEWKB;
+    std::string sql = "UPDATE \"" + m_osTableName + "\" SET ";
+    if (bHasGeom)
+    {
+        ExportFeatureGeometry(poFeature, abyEWKB);
+        sql += "\"";
+        sql += m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef();
+        sql += "\" = ?";
+    }
+
+    // 2. Attributes, unset ones being set to NULL
+    std::vector<int> anBoundFields;
+    for (int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++)
+    {
+        OGRFieldDefn *poFDefn = m_poFeatureDefn->GetFieldDefn(i);
+
+        // Skip FID field (it's the primary key)
+        if (!m_osFIDCol.empty() &&
+            EQUAL(poFDefn->GetNameRef(), m_osFIDCol.c_str()))
+            continue;
+
+        if (bHasGeom || !anBoundFields.empty())
+            sql += ", ";
+        sql += "\"";
+        sql += poFDefn->GetNameRef();
+        sql += "\" = ?";
+        anBoundFields.push_back(i);
+    }
+    if (!bHasGeom && anBoundFields.empty())
+        return OGRERR_NONE;  // Nothing but the FID to write
+
+    std::string fidCol =
         m_osFIDCol.empty() ? "_ROWID_" : ("\"" + m_osFIDCol + "\"");
-    std::string sql = "DELETE FROM \"" + m_osTableName + "\" WHERE " + fidCol +
-                      " = " + std::to_string(nFID);
+    sql += " WHERE " + fidCol + " = ?";
 
     graal_isolatethread_t *thread =
         (graal_isolatethread_t *)m_poDS->GetThread();
-    long long conn = m_poDS->GetConnection();
+    long long hStmt = GetCachedStatement(sql);
+    if (!hStmt)
+        return OGRERR_FAILURE;
+
+    // Parameter indexes are 1-based (JDBC)
+    int nParam = 1;
+    if (bHasGeom && abyEWKB.empty())
+        h2gis_bind_string(thread, hStmt, nParam++, nullptr);
+    else if (bHasGeom)
+        h2gis_bind_blob(thread, hStmt, nParam++, (char *)abyEWKB.data(),
+                        static_cast<int>(abyEWKB.size()));
+    for (int iField : anBoundFields)
+        BindFeatureField(thread, hStmt, nParam++, poFeature, iField);
+    h2gis_bind_long(thread, hStmt, nParam, poFeature->GetFID());
+
+    const int nUpdated = h2gis_execute_prepared_update(thread, hStmt);
+    if (nUpdated < 0)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "SetFeature: SQL execution failed");
+        return OGRERR_FAILURE;
+    }
+    return nUpdated == 0 ? OGRERR_NON_EXISTING_FEATURE : OGRERR_NONE;
+}
+
+#if GDAL_VERSION_NUM >= 3060000
+/**
+ * Insert the feature, or replace the row of its FID, with one MERGE INTO
+ * ... KEY (fid) statement. As for inserts, unset fields are left out, so
+ * that a new row gets their default and an existing one keeps its values.
+ * Tables without a FID column cannot be merged on _ROWID_, and fall back
+ * on an update, then an insert if the FID does not exist.
+ */
+OGRErr OGRH2GISLayer::IUpsertFeature(OGRFeature *poFeature)
+{
+    if (poFeature->GetFID() == OGRNullFID)
+        return ICreateFeature(poFeature);
+    if (m_osFIDCol.empty())
+    {
+        const OGRErr eErr = ISetFeature(poFeature);
+        return eErr == OGRERR_NON_EXISTING_FEATURE ? ICreateFeature(poFeature)
+                                                   : eErr;
+    }
+
+    FlushPendingInserts();
+    m_poDS->BeginImplicitTransaction();
+    m_oKeysetIndex.clear();  // Feature indexes may shift
+    ClearFIDBurstCache();
+    ExtendCachedExtent(poFeature->GetGeometryRef());
+    AdjustFeatureCount(0);
+    m_bFeatureCountExact = false;  // Inserted or updated: not told apart
+
+    // Same column list as QueueInsert()
+    const bool bHasGeomField = m_poFeatureDefn->GetGeomFieldCount() > 0;
+    std::vector<uint8_t> abyEWKB;
+    std::string osColumns = "\"" + m_osFIDCol + "\"";
+    std::string osValues = "?";
+    if (bHasGeomField)
+    {
+        ExportFeatureGeometry(poFeature, abyEWKB);
+        osColumns += ", \"";
+        osColumns += m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef();
+        osColumns += "\"";
+        osValues += ", ?";
+    }
+    std::vector<int> anBoundFields;
+    for (int i = 0; i < m_poFeatureDefn->GetFieldCount(); i++)
+    {
+        OGRFieldDefn *poFDefn = m_poFeatureDefn->GetFieldDefn(i);
+        if (!poFeature->IsFieldSet(i) ||
+            EQUAL(poFDefn->GetNameRef(), m_osFIDCol.c_str()))
+            continue;
+        osColumns += ", \"";
+        osColumns += poFDefn->GetNameRef();
+        osColumns += "\"";
+        osValues += ", ?";
+        anBoundFields.push_back(i);
+    }
+    const std::string sql = "MERGE INTO \"" + m_osTableName + "\" (" +
+                            osColumns + ") KEY (\"" + m_osFIDCol +
+                            "\") VALUES (" + osValues + ")";
+
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    long long hStmt = GetCachedStatement(sql);
+    if (!hStmt)
+        return OGRERR_FAILURE;
+
+    // Parameter indexes are 1-based (JDBC)
+    int nParam = 1;
+    h2gis_bind_long(thread, hStmt, nParam++, poFeature->GetFID());
+    if (bHasGeomField && abyEWKB.empty())
+        h2gis_bind_string(thread, hStmt, nParam++, nullptr);
+    else if (bHasGeomField)
+        h2gis_bind_blob(thread, hStmt, nParam++, (char *)abyEWKB.data(),
+                        static_cast<int>(abyEWKB.size()));
+    for (int iField : anBoundFields)
+        BindFeatureField(thread, hStmt, nParam++, poFeature, iField);
 
-    if (h2gis_execute(thread, conn, (char *)sql.c_str()) < 0)
+    if (h2gis_execute_prepared_update(thread, hStmt) < 0)
     {
         CPLError(CE_Failure, CPLE_AppDefined,
-                 "DeleteFeature: SQL execution failed");
+                 "UpsertFeature: SQL execution failed");
         return OGRERR_FAILURE;
     }
 
+    // Keep the FIDs given by QueueInsert() clear of this one (an identity
+    // is not advanced by explicit values)
+    if (!m_bFIDIdentity && m_nNextFID > 0 && poFeature->GetFID() >= m_nNextFID)
+        m_nNextFID = poFeature->GetFID() + 1;
     return OGRERR_NONE;
 }
+#endif
+
+/**
+ * Deletes are queued (see FlushPendingDeletes), and run together once
+ * H2GIS_DELETE_BUFFER_ROWS FIDs are queued, or before anything reads,
+ * inserts, updates or commits the table. Errors are only reported by the
+ * flush.
+ */
+OGRErr OGRH2GISLayer::DeleteFeature(GIntBig nFID)
+{
+    if (CreateDeferredTable() != OGRERR_NONE)
+        return OGRERR_FAILURE;
+    // The FID may be among the queued inserts
+    if (!m_apoPendingInserts.empty())
+    {
+        const OGRErr eErr = FlushPendingInserts();
+        if (eErr != OGRERR_NONE)
+            return eErr;
+    }
+    m_poDS->BeginImplicitTransaction();
+
+    m_anPendingDeletes.push_back(nFID);
+    m_oKeysetIndex.clear();  // Later feature indexes shift by one
+    ClearFIDBurstCache();
+    InvalidateCachedExtent();
+
+    if (m_anPendingDeletes.size() >= H2GIS_DELETE_BUFFER_ROWS)
+        return FlushPendingDeletes();
+    return OGRERR_NONE;
+}
+
+/**
+ * Delete the queued FIDs: a single one through a cached prepared DELETE,
+ * several with one DELETE ... WHERE fid IN (...).
+ */
+OGRErr OGRH2GISLayer::FlushPendingDeletes()
+{
+    if (m_anPendingDeletes.empty())
+        return OGRERR_NONE;
+
+    // Use table name for SQL (not layer name which may be TABLE.GEOM_COL)
+    std::string fidCol =
+        m_osFIDCol.empty() ? "_ROWID_" : ("\"" + m_osFIDCol + "\"");
+    std::string sql =
+        "DELETE FROM \"" + m_osTableName + "\" WHERE " + fidCol;
+
+    graal_isolatethread_t *thread =
+        (graal_isolatethread_t *)m_poDS->GetThread();
+    const size_t nQueued = m_anPendingDeletes.size();
+    int nDeleted = -1;
+    if (nQueued == 1)
+    {
+        long long hStmt = GetCachedStatement(sql + " = ?");
+        if (hStmt)
+        {
+            h2gis_bind_long(thread, hStmt, 1, m_anPendingDeletes[0]);
+            nDeleted = h2gis_execute_prepared_update(thread, hStmt);
+        }
+    }
+    else
+    {
+        sql += " IN (";
+        for (size_t i = 0; i < nQueued; i++)
+        {
+            if (i > 0)
+                sql += ", ";
+            sql += std::to_string(m_anPendingDeletes[i]);
+        }
+        sql += ")";
+        nDeleted =
+            h2gis_execute(thread, m_poDS->GetConnection(), (char *)sql.c_str());
+    }
+    m_anPendingDeletes.clear();
+
+    if (nDeleted < 0)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "H2GIS: Failed to delete %d buffered features from %s",
+                 static_cast<int>(nQueued), m_osTableName.c_str());
+        return OGRERR_FAILURE;
+    }
+    AdjustFeatureCount(-nDeleted);  // Affected row count
+    return OGRERR_NONE;
+}
+
+/**
+ * Check whether the layer schema can be exported with the native Arrow path.
+ *
+ * The native path builds Arrow arrays straight from the columnar batch buffers
+ * returned by h2gis_fetch_batch(). It covers the types H2GIS sends as packed
+ * values (INT, LONG, FLOAT, DOUBLE, BOOL, STRING) plus the geometry column as
+ * WKB. Anything else (dates, binary, subtypes, non-WKB geometry encodings) is
+ * left to the generic OGRLayer implementation built on GetNextFeature().
+ */
+bool OGRH2GISLayer::IsArrowFastPathSupported(CSLConstList papszOptions) const
+{
+    const char *pszGeomEncoding =
+        CSLFetchNameValue(papszOptions, "GEOMETRY_ENCODING");
+    if (pszGeomEncoding && !EQUAL(pszGeomEncoding, "WKB"))
+        return false;
+
+    const OGRFeatureDefn *poDefn = m_poFeatureDefn;
+    for (int i = 0; i < poDefn->GetFieldCount(); i++)
+    {
+        const OGRFieldDefn *poFieldDefn = poDefn->GetFieldDefn(i);
+        if (poFieldDefn->IsIgnored())
+            continue;
+        if (poFieldDefn->GetSubType() != OFSTNone)
+            return false;
+        switch (poFieldDefn->GetType())
+        {
+            case OFTInteger:
+            case OFTInteger64:
+            case OFTReal:
+            case OFTString:
+                break;
+            default:
+                return false;
+        }
+    }
+    return poDefn->GetGeomFieldCount() <= 1;
+}
+
+#if GDAL_VERSION_NUM >= 3060000
+
+// Release callback shared by the struct array and all its children
+static void OGRH2GISReleaseArrowArray(struct ArrowArray *psArray)
+{
+    if (psArray->buffers)
+    {
+        for (int64_t i = 0; i < psArray->n_buffers; i++)
+            VSIFreeAligned(const_cast<void *>(psArray->buffers[i]));
+        CPLFree(psArray->buffers);
+    }
+    if (psArray->children)
+    {
+        for (int64_t i = 0; i < psArray->n_children; i++)
+        {
+            if (psArray->children[i] && psArray->children[i]->release)
+                psArray->children[i]->release(psArray->children[i]);
+            CPLFree(psArray->children[i]);
+        }
+        CPLFree(psArray->children);
+    }
+    psArray->release = nullptr;
+}
+
+static struct ArrowArray *OGRH2GISNewArrowChild(int64_t nLength, int nBuffers)
+{
+    struct ArrowArray *psChild = static_cast<struct ArrowArray *>(
+        CPLCalloc(1, sizeof(struct ArrowArray)));
+    psChild->length = nLength;
+    psChild->n_buffers = nBuffers;
+    psChild->buffers =
+        static_cast<const void **>(CPLCalloc(nBuffers, sizeof(void *)));
+    psChild->release = OGRH2GISReleaseArrowArray;
+    return psChild;
+}
+
+static void *OGRH2GISAllocArrowBuffer(size_t nSize)
+{
+    // Arrow recommends 64-byte alignment; never hand out a null data buffer
+    void *pBuffer = VSIMallocAligned(64, std::max<size_t>(nSize, 1));
+    if (!pBuffer)
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "H2GIS: cannot allocate %llu bytes for Arrow buffer",
+                 static_cast<unsigned long long>(nSize));
+    }
+    return pBuffer;
+}
+
+// Clear the validity bit of a row, allocating the bitmap on first null
+static bool OGRH2GISSetArrowNull(struct ArrowArray *psChild, int64_t iRow)
+{
+    if (psChild->buffers[0] == nullptr)
+    {
+        const size_t nBytes = static_cast<size_t>((psChild->length + 7) / 8);
+        void *pValidity = OGRH2GISAllocArrowBuffer(nBytes);
+        if (!pValidity)
+            return false;
+        memset(pValidity, 0xFF, nBytes);
+        psChild->buffers[0] = pValidity;
+    }
+    uint8_t *pabyValidity =
+        static_cast<uint8_t *>(const_cast<void *>(psChild->buffers[0]));
+    pabyValidity[iRow / 8] &= static_cast<uint8_t>(~(1 << (iRow % 8)));
+    psChild->null_count++;
+    return true;
+}
+
+// Can a batch column of H2GIS type nH2Type feed an Arrow array of eType?
+static bool IsArrowCompatibleColumn(OGRFieldType eType, int nH2Type)
+{
+    switch (eType)
+    {
+        case OFTInteger:
+            return nH2Type == H2GIS_TYPE_INT || nH2Type == H2GIS_TYPE_BOOL;
+        case OFTInteger64:
+            return nH2Type == H2GIS_TYPE_INT || nH2Type == H2GIS_TYPE_LONG ||
+                   nH2Type == H2GIS_TYPE_BOOL;
+        case OFTReal:
+            return nH2Type == H2GIS_TYPE_DOUBLE ||
+                   nH2Type == H2GIS_TYPE_FLOAT || nH2Type == H2GIS_TYPE_INT ||
+                   nH2Type == H2GIS_TYPE_LONG;
+        case OFTString:
+            return nH2Type == H2GIS_TYPE_STRING;
+        default:
+            return false;
+    }
+}
+
+// Convert nRows packed values of a batch column into a primitive Arrow array
+template <class T>
+static bool OGRH2GISFillArrowNumeric(struct ArrowArray *psChild,
+                                     const uint8_t *ptr, int nH2Type,
+                                     int nRows)
+{
+    T *paValues =
+        static_cast<T *>(OGRH2GISAllocArrowBuffer(sizeof(T) * nRows));
+    if (!paValues)
+        return false;
+    psChild->buffers[1] = paValues;
+
+    switch (nH2Type)
+    {
+        case H2GIS_TYPE_INT:
+            for (int i = 0; i < nRows; i++, ptr += 4)
+            {
+                int32_t val;
+                memcpy(&val, ptr, 4);
+                paValues[i] = static_cast<T>(val);
+            }
+            break;
+        case H2GIS_TYPE_LONG:
+            for (int i = 0; i < nRows; i++, ptr += 8)
+            {
+                int64_t val;
+                memcpy(&val, ptr, 8);
+                paValues[i] = static_cast<T>(val);
+            }
+            break;
+        case H2GIS_TYPE_FLOAT:
+            for (int i = 0; i < nRows; i++, ptr += 4)
+            {
+                float val;
+                memcpy(&val, ptr, 4);
+                paValues[i] = static_cast<T>(val);
+            }
+            break;
+        case H2GIS_TYPE_DOUBLE:
+            for (int i = 0; i < nRows; i++, ptr += 8)
+            {
+                double val;
+                memcpy(&val, ptr, 8);
+                paValues[i] = static_cast<T>(val);
+            }
+            break;
+        case H2GIS_TYPE_BOOL:
+            for (int i = 0; i < nRows; i++, ptr += 1)
+                paValues[i] = static_cast<T>(static_cast<int8_t>(*ptr));
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+// Convert nRows length-prefixed values (STRING, or GEOM as WKB) into a
+// variable-size Arrow array with int32 offsets
+static bool OGRH2GISFillArrowBinary(struct ArrowArray *psChild,
+                                    const uint8_t *ptr, int nRows,
+                                    bool bGeometry)
+{
+    // First pass: compute the size of the data buffer
+    size_t nTotalSize = 0;
+    const uint8_t *p = ptr;
+    for (int i = 0; i < nRows; i++)
+    {
+        int32_t nLen;
+        memcpy(&nLen, p, 4);
+        p += 4;
+        if (nLen > 0)
+        {
+            nTotalSize += bGeometry ? H2GISEWKBSizeAsWKB(p, nLen) : nLen;
+            p += nLen;
+        }
+    }
+    if (nTotalSize > static_cast<size_t>(INT_MAX))
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "H2GIS: Arrow batch exceeds 2 GB for a single column");
+        return false;
+    }
+
+    int32_t *panOffsets = static_cast<int32_t *>(
+        OGRH2GISAllocArrowBuffer(sizeof(int32_t) * (nRows + 1)));
+    if (!panOffsets)
+        return false;
+    psChild->buffers[1] = panOffsets;
+    uint8_t *pabyData =
+        static_cast<uint8_t *>(OGRH2GISAllocArrowBuffer(nTotalSize));
+    if (!pabyData)
+        return false;
+    psChild->buffers[2] = pabyData;
+
+    // Second pass: copy values
+    int32_t nOffset = 0;
+    for (int i = 0; i < nRows; i++)
+    {
+        panOffsets[i] = nOffset;
+        int32_t nLen;
+        memcpy(&nLen, ptr, 4);
+        ptr += 4;
+        if (nLen <= 0)
+        {
+            // Same convention as GetNextFeature(): empty value is unset
+            if (!OGRH2GISSetArrowNull(psChild, i))
+                return false;
+            continue;
+        }
+        if (bGeometry)
+        {
+            const int32_t nOutLen = H2GISEWKBSizeAsWKB(ptr, nLen);
+            H2GISCopyEWKBAsWKB(ptr, nLen, nOutLen, pabyData + nOffset);
+            nOffset += nOutLen;
+        }
+        else
+        {
+            memcpy(pabyData + nOffset, ptr, nLen);
+            nOffset += nLen;
+        }
+        ptr += nLen;
+    }
+    panOffsets[nRows] = nOffset;
+    return true;
+}
+
+// Move a column cursor past nRows values of H2GIS type nType. Unknown
+// layouts leave it in place, as H2GISDecodeRow() does.
+static uint8_t *SkipColumnValues(uint8_t *ptr, int nType, int nRows)
+{
+    switch (GetSkipOp(nType))
+    {
+        case H2GIS_DECODE_SKIP_1:
+            return ptr + nRows;
+        case H2GIS_DECODE_SKIP_4:
+            return ptr + 4 * static_cast<size_t>(nRows);
+        case H2GIS_DECODE_SKIP_8:
+            return ptr + 8 * static_cast<size_t>(nRows);
+        case H2GIS_DECODE_SKIP_VARLEN:
+            for (int i = 0; i < nRows; i++)
+            {
+                int32_t len;
+                memcpy(&len, ptr, 4);
+                ptr += 4;
+                if (len > 0)
+                    ptr += len;
+            }
+            return ptr;
+        default:
+            return ptr;
+    }
+}
+
+bool OGRH2GISLayer::GetArrowStream(struct ArrowArrayStream *out_stream,
+                                   CSLConstList papszOptions)
+{
+    m_bArrowFastPath = IsArrowFastPathSupported(papszOptions);
+    m_bArrowIncludeFID = CPLTestBool(
+        CSLFetchNameValueDef(papszOptions, "INCLUDE_FID", "YES"));
+    m_nArrowMaxBatchRows = std::max(
+        1, atoi(CSLFetchNameValueDef(papszOptions, "MAX_FEATURES_IN_BATCH",
+                                     "65536")));
+    LogLayer(m_bArrowFastPath ? "GetArrowStream (native batches)"
+                              : "GetArrowStream (generic)",
+             m_poFeatureDefn->GetName());
+
+    // The base class installs the stream callbacks and builds the schema
+    // from the layer definition; GetNextArrowArray() fills it batch by batch.
+    return OGRLayer::GetArrowStream(out_stream, papszOptions);
+}
+
+int OGRH2GISLayer::GetNextArrowArray(struct ArrowArrayStream *stream,
+                                     struct ArrowArray *out_array)
+{
+    if (!m_bArrowFastPath)
+        return OGRLayer::GetNextArrowArray(stream, out_array);
+
+    memset(out_array, 0, sizeof(*out_array));
+
+    if (m_bResetPending)
+        PrepareQuery();
+    if (m_bTileScan)  // No batches: built from the cached features
+        return OGRLayer::GetNextArrowArray(stream, out_array);
+
+    // End of stream is signalled by leaving out_array->release to nullptr
+    if (m_iNextRowInBatch >= m_nBatchRows && !FetchNextBatch())
+        return 0;
+
+    // Map the batch columns to the Arrow children (FID, fields, geometry)
+    // from the decode plan of the query
+    const int nFieldCount = m_poFeatureDefn->GetFieldCount();
+    const bool bHasGeom = m_poFeatureDefn->GetGeomFieldCount() > 0 &&
+                          !m_poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored();
+    std::vector<int> anFieldToCol(nFieldCount, -1);
+    int iFIDCol = -1;
+    int iGeomCol = -1;
+
+    for (size_t iCol = 0; iCol < m_aoDecodePlan.size(); iCol++)
+    {
+        const H2GISDecodeStep &oStep = m_aoDecodePlan[iCol];
+        switch (oStep.eOp)
+        {
+            case H2GIS_DECODE_FID_INT:
+            case H2GIS_DECODE_FID_LONG:
+                if (iFIDCol < 0)
+                    iFIDCol = static_cast<int>(iCol);
+                break;
+            case H2GIS_DECODE_GEOM:
+                if (iGeomCol < 0 && oStep.iTarget == 0)
+                    iGeomCol = static_cast<int>(iCol);
+                break;
+            case H2GIS_DECODE_STRING:
+            case H2GIS_DECODE_INT:
+            case H2GIS_DECODE_LONG:
+            case H2GIS_DECODE_FLOAT:
+            case H2GIS_DECODE_DOUBLE:
+            case H2GIS_DECODE_BOOL:
+            case H2GIS_DECODE_STRING_RAW:
+            case H2GIS_DECODE_INT_RAW:
+            case H2GIS_DECODE_LONG_RAW:
+            case H2GIS_DECODE_DOUBLE_RAW:
+                if (anFieldToCol[oStep.iTarget] < 0)
+                    anFieldToCol[oStep.iTarget] = static_cast<int>(iCol);
+                break;
+            default:
+                break;
+        }
+    }
+
+    int nChildren = m_bArrowIncludeFID ? 1 : 0;
+    bool bCompatible = !bHasGeom || iGeomCol >= 0;
+    for (int i = 0; i < nFieldCount && bCompatible; i++)
+    {
+        const OGRFieldDefn *poFieldDefn = m_poFeatureDefn->GetFieldDefn(i);
+        if (poFieldDefn->IsIgnored())
+            continue;
+        bCompatible = anFieldToCol[i] >= 0 &&
+                      IsArrowCompatibleColumn(poFieldDefn->GetType(),
+                                              m_columnTypes[anFieldToCol[i]]);
+        nChildren++;
+    }
+    if (!bCompatible)
+    {
+        // The batch is left untouched, so the generic implementation
+        // resumes exactly where we are.
+        LogLayer("GetNextArrowArray: falling back to generic path",
+                 m_poFeatureDefn->GetName());
+        m_bArrowFastPath = false;
+        return OGRLayer::GetNextArrowArray(stream, out_array);
+    }
+    if (bHasGeom)
+        nChildren++;
+
+    const int nRows =
+        std::min(m_nBatchRows - m_iNextRowInBatch, m_nArrowMaxBatchRows);
+    out_array->length = nRows;
+    out_array->n_buffers = 1;
+    out_array->buffers =
+        static_cast<const void **>(CPLCalloc(1, sizeof(void *)));
+    out_array->n_children = nChildren;
+    out_array->children = static_cast<struct ArrowArray **>(
+        CPLCalloc(nChildren, sizeof(struct ArrowArray *)));
+    out_array->release = OGRH2GISReleaseArrowArray;
+
+    bool bOK = true;
+    int iChild = 0;
+
+    if (m_bArrowIncludeFID)
+    {
+        struct ArrowArray *psChild = OGRH2GISNewArrowChild(nRows, 2);
+        out_array->children[iChild++] = psChild;
+        if (iFIDCol >= 0)
+        {
+            bOK = OGRH2GISFillArrowNumeric<int64_t>(
+                psChild, m_columnValues[iFIDCol], m_columnTypes[iFIDCol],
+                nRows);
+        }
+        else
+        {
+            // Same fallback as GetNextFeature(): sequential FIDs
+            int64_t *panFIDs = static_cast<int64_t *>(
+                OGRH2GISAllocArrowBuffer(sizeof(int64_t) * nRows));
+            bOK = panFIDs != nullptr;
+            psChild->buffers[1] = panFIDs;
+            for (int i = 0; bOK && i < nRows; i++)
+                panFIDs[i] = m_iNextShapeId + i;
+        }
+    }
+
+    for (int i = 0; bOK && i < nFieldCount; i++)
+    {
+        const OGRFieldDefn *poFieldDefn = m_poFeatureDefn->GetFieldDefn(i);
+        if (poFieldDefn->IsIgnored())
+            continue;
+        const int iCol = anFieldToCol[i];
+        const uint8_t *ptr = m_columnValues[iCol];
+        const int type = m_columnTypes[iCol];
+
+        struct ArrowArray *psChild = nullptr;
+        switch (poFieldDefn->GetType())
+        {
+            case OFTInteger:
+                psChild = OGRH2GISNewArrowChild(nRows, 2);
+                bOK = OGRH2GISFillArrowNumeric<int32_t>(psChild, ptr, type,
+                                                        nRows);
+                break;
+            case OFTInteger64:
+                psChild = OGRH2GISNewArrowChild(nRows, 2);
+                bOK = OGRH2GISFillArrowNumeric<int64_t>(psChild, ptr, type,
+                                                        nRows);
+                break;
+            case OFTReal:
+                psChild = OGRH2GISNewArrowChild(nRows, 2);
+                bOK = OGRH2GISFillArrowNumeric<double>(psChild, ptr, type,
+                                                       nRows);
+                break;
+            default:
+                psChild = OGRH2GISNewArrowChild(nRows, 3);
+                bOK = OGRH2GISFillArrowBinary(psChild, ptr, nRows, false);
+                break;
+        }
+        out_array->children[iChild++] = psChild;
+    }
+
+    if (bOK && bHasGeom)
+    {
+        struct ArrowArray *psChild = OGRH2GISNewArrowChild(nRows, 3);
+        out_array->children[iChild++] = psChild;
+        bOK = OGRH2GISFillArrowBinary(psChild, m_columnValues[iGeomCol],
+                                      nRows, true);
+    }
+
+    if (!bOK)
+    {
+        out_array->release(out_array);
+        memset(out_array, 0, sizeof(*out_array));
+        return ENOMEM;
+    }
+
+    // Rows left in the batch are read by the next call, or by
+    // GetNextFeature() after a fallback
+    for (size_t iCol = 0; iCol < m_columnValues.size(); iCol++)
+        m_columnValues[iCol] =
+            SkipColumnValues(m_columnValues[iCol], m_columnTypes[iCol], nRows);
+    m_iNextShapeId += nRows;
+    m_iNextRowInBatch += nRows;
+    return 0;
+}
+
+#endif  // GDAL_VERSION_NUM >= 3060000
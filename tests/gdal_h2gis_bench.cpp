@@ -0,0 +1,602 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024-2026 H2GIS Team
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  gdal_h2gis_bench: micro-benchmarks of the decode and encode
+ *           paths, and end-to-end scenarios against a generated database,
+ *           reported as JSON
+ * Author:   H2GIS Team
+ *
+ ******************************************************************************/
+
+#include "ogr_h2gis.h"
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_json.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+#include "gdal_priv.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+void RegisterOGRH2GIS();  // ogrh2gisdriver.cpp
+
+namespace
+{
+
+struct BenchOptions
+{
+    int nIterations = 5;
+    GIntBig nMicroRows = 1000000;
+    GIntBig nFeatures = 100000;
+    int nVertices = 16;
+    int nRandomReads = 1000;
+    bool bMicroOnly = false;
+    bool bKeep = false;
+    std::string osDB;
+    std::string osOutput;
+    CPLStringList aosOpenOptions;
+};
+
+// Written by the micro-benchmarks so that their work is not optimized out
+volatile double g_dfSink = 0;
+
+void Usage()
+{
+    fprintf(stderr,
+            "Usage: gdal_h2gis_bench [--iterations N] [--micro-rows N]\n"
+            "                        [--features N] [--vertices N]\n"
+            "                        [--random-reads N] [--micro-only]\n"
+            "                        [--db FILE.mv.db] [--keep]\n"
+            "                        [--oo NAME=VALUE]... [--output FILE]\n");
+}
+
+/************************************************************************/
+/*                            RunBenchmark()                            */
+/************************************************************************/
+
+// Time nIterations runs of pfnRun, which returns the number of items
+// (rows, features, statements) it processed, or -1 on failure
+CPLJSONObject RunBenchmark(const char *pszName, int nIterations,
+                           const std::function<GIntBig()> &pfnRun)
+{
+    CPLJSONObject oResult;
+    oResult.Add("name", pszName);
+
+    std::vector<double> adfMs;
+    GIntBig nItems = 0;
+    for (int i = 0; i < nIterations; i++)
+    {
+        const auto oStart = std::chrono::steady_clock::now();
+        nItems = pfnRun();
+        const std::chrono::duration<double, std::milli> oElapsed =
+            std::chrono::steady_clock::now() - oStart;
+        if (nItems < 0)
+        {
+            fprintf(stderr, "%-20s failed: %s\n", pszName,
+                    CPLGetLastErrorMsg());
+            oResult.Add("error", std::string(CPLGetLastErrorMsg()));
+            return oResult;
+        }
+        adfMs.push_back(oElapsed.count());
+    }
+
+    std::sort(adfMs.begin(), adfMs.end());
+    double dfSum = 0;
+    for (double dfMs : adfMs)
+        dfSum += dfMs;
+    const double dfBest = adfMs.front();
+    const double dfRate = dfBest > 0 ? nItems * 1000.0 / dfBest : 0.0;
+
+    oResult.Add("iterations", nIterations);
+    oResult.Add("items", static_cast<GInt64>(nItems));
+    oResult.Add("best_ms", dfBest);
+    oResult.Add("median_ms", adfMs[adfMs.size() / 2]);
+    oResult.Add("mean_ms", dfSum / adfMs.size());
+    oResult.Add("items_per_second", dfRate);
+    fprintf(stderr, "%-20s best %10.3f ms %14.0f items/s\n", pszName, dfBest,
+            dfRate);
+    return oResult;
+}
+
+/************************************************************************/
+/*                         Synthetic features                           */
+/************************************************************************/
+
+// Line string of feature i, in its cell of a nSide x nSide grid covering
+// [0, 1000] x [0, 1000], so that a window selects a known share of them
+void MakeLine(GIntBig i, GIntBig nSide, int nVertices, OGRLineString &oLine)
+{
+    const double dfCell = 1000.0 / nSide;
+    const double dfX = (i % nSide) * dfCell;
+    const double dfY = ((i / nSide) % nSide) * dfCell;
+    oLine.empty();
+    for (int k = 0; k < nVertices; k++)
+        oLine.addPoint(dfX + dfCell * k / (nVertices - 1),
+                       dfY + dfCell * 0.5 * (k % 2));
+}
+
+GIntBig GridSide(GIntBig nFeatures)
+{
+    return std::max<GIntBig>(
+        1, static_cast<GIntBig>(std::ceil(std::sqrt(double(nFeatures)))));
+}
+
+template <class T> void AppendValue(std::vector<uint8_t> &aby, T value)
+{
+    const uint8_t *pabyValue = reinterpret_cast<const uint8_t *>(&value);
+    aby.insert(aby.end(), pabyValue, pabyValue + sizeof(T));
+}
+
+void AppendVarLen(std::vector<uint8_t> &aby, const void *pData, size_t nSize)
+{
+    AppendValue<int32_t>(aby, static_cast<int32_t>(nSize));
+    const uint8_t *pabyData = static_cast<const uint8_t *>(pData);
+    aby.insert(aby.end(), pabyData, pabyData + nSize);
+}
+
+// Batch of nRows rows laid out as h2gis_fetch_batch() returns it (see
+// H2GISParseBatchBuffer()): ID BIGINT, GEOM, NAME VARCHAR, VALUE DOUBLE,
+// COUNT INTEGER
+std::vector<uint8_t> BuildSyntheticBatch(int nRows, int nVertices)
+{
+    const char *const apszNames[] = {"ID", "GEOM", "NAME", "VALUE", "COUNT"};
+    const int anTypes[] = {H2GIS_TYPE_LONG, H2GIS_TYPE_GEOM, H2GIS_TYPE_STRING,
+                           H2GIS_TYPE_DOUBLE, H2GIS_TYPE_INT};
+    constexpr int nCols = 5;
+
+    std::vector<std::vector<uint8_t>> aabyColumns(nCols);
+    std::vector<uint8_t> abyEWKB;
+    OGRLineString oLine;
+    for (int iRow = 0; iRow < nRows; iRow++)
+    {
+        AppendValue<int64_t>(aabyColumns[0], iRow + 1);
+        MakeLine(iRow, GridSide(nRows), nVertices, oLine);
+        H2GISExportToEWKB(&oLine, 4326, abyEWKB);
+        AppendVarLen(aabyColumns[1], abyEWKB.data(), abyEWKB.size());
+        const std::string osName = CPLSPrintf("feature_%d", iRow);
+        AppendVarLen(aabyColumns[2], osName.data(), osName.size());
+        AppendValue<double>(aabyColumns[3], iRow * 0.5);
+        AppendValue<int32_t>(aabyColumns[4], iRow % 1000);
+    }
+
+    std::vector<uint8_t> abyBatch;
+    AppendValue<int32_t>(abyBatch, nCols);
+    AppendValue<int32_t>(abyBatch, nRows);
+    const size_t nOffsetsPos = abyBatch.size();
+    abyBatch.resize(nOffsetsPos + 8 * nCols);
+    for (int i = 0; i < nCols; i++)
+    {
+        const int64_t nOffset = static_cast<int64_t>(abyBatch.size());
+        memcpy(abyBatch.data() + nOffsetsPos + 8 * i, &nOffset, 8);
+        AppendVarLen(abyBatch, apszNames[i], strlen(apszNames[i]));
+        AppendValue<int32_t>(abyBatch, anTypes[i]);
+        AppendValue<int32_t>(abyBatch,
+                             static_cast<int32_t>(aabyColumns[i].size()));
+        abyBatch.insert(abyBatch.end(), aabyColumns[i].begin(),
+                        aabyColumns[i].end());
+    }
+    return abyBatch;
+}
+
+/************************************************************************/
+/*                          Micro-benchmarks                            */
+/************************************************************************/
+
+// Parse and decode nBatches copies of abyPristine, as FetchNextBatch() and
+// GetNextFeature() do. The batch is copied first, as geometries are decoded
+// in place, which stands for the fetch of a fresh buffer.
+GIntBig DecodeBatches(const std::vector<uint8_t> &abyPristine,
+                      GIntBig nBatches, OGRFeatureDefn *poDefn,
+                      const std::vector<int> &anTargets)
+{
+    std::vector<uint8_t> abyBatch(abyPristine.size());
+    std::vector<uint8_t *> apCursors;
+    std::vector<int> anTypes;
+    std::vector<H2GISDecodeStep> aoPlan;
+    OGRFeature *poFeature = nullptr;
+    GIntBig nRows = 0;
+    double dfSum = 0;
+    for (GIntBig iBatch = 0; iBatch < nBatches; iBatch++)
+    {
+        memcpy(abyBatch.data(), abyPristine.data(), abyPristine.size());
+        const int nBatchRows =
+            H2GISParseBatchBuffer(abyBatch.data(), apCursors, anTypes);
+        H2GISBuildDecodePlan(poDefn, anTypes, anTargets, aoPlan);
+        for (int iRow = 0; iRow < nBatchRows; iRow++)
+        {
+            poFeature = H2GISDecodeRow(poDefn, aoPlan, apCursors, poFeature);
+            dfSum += poFeature->GetFID();
+        }
+        nRows += nBatchRows;
+    }
+    delete poFeature;
+    g_dfSink = dfSum;
+    return nRows;
+}
+
+void RunMicroBenchmarks(const BenchOptions &oOptions, CPLJSONArray &oResults)
+{
+    const int nBatchRows = H2GIS_BATCH_SIZE;
+    const GIntBig nBatches =
+        std::max<GIntBig>(1, oOptions.nMicroRows / nBatchRows);
+    const GIntBig nRows = nBatches * nBatchRows;
+    const std::vector<uint8_t> abyBatch =
+        BuildSyntheticBatch(nBatchRows, oOptions.nVertices);
+
+    OGRSpatialReference oSRS;
+    oSRS.importFromEPSG(4326);
+    OGRFeatureDefn *poDefn = new OGRFeatureDefn("bench");
+    poDefn->Reference();
+    poDefn->GetGeomFieldDefn(0)->SetName("GEOM");
+    poDefn->GetGeomFieldDefn(0)->SetType(wkbLineString);
+    poDefn->GetGeomFieldDefn(0)->SetSpatialRef(&oSRS);
+    OGRFieldDefn oName("NAME", OFTString);
+    poDefn->AddFieldDefn(&oName);
+    OGRFieldDefn oValue("VALUE", OFTReal);
+    poDefn->AddFieldDefn(&oValue);
+    OGRFieldDefn oCount("COUNT", OFTInteger);
+    poDefn->AddFieldDefn(&oCount);
+
+    // Every column skipped: the cost of walking the buffer alone
+    oResults.Add(RunBenchmark(
+        "batch_walk", oOptions.nIterations, [&]()
+        { return DecodeBatches(abyBatch, nBatches, poDefn, {}); }));
+
+    const std::vector<int> anTargets = {H2GIS_COL_FID, H2GIS_COL_GEOM, 0, 1,
+                                        2};
+    oResults.Add(RunBenchmark(
+        "batch_decode", oOptions.nIterations, [&]()
+        { return DecodeBatches(abyBatch, nBatches, poDefn, anTargets); }));
+    poDefn->Release();
+
+    OGRLineString oLine;
+    MakeLine(0, 1, oOptions.nVertices, oLine);
+    oResults.Add(RunBenchmark("ewkb_export", oOptions.nIterations,
+                              [&]()
+                              {
+                                  std::vector<uint8_t> abyEWKB;
+                                  double dfSum = 0;
+                                  for (GIntBig i = 0; i < nRows; i++)
+                                  {
+                                      H2GISExportToEWKB(&oLine, 4326, abyEWKB);
+                                      dfSum += abyEWKB[9];
+                                  }
+                                  g_dfSink = dfSum;
+                                  return nRows;
+                              }));
+
+    std::vector<uint8_t> abyPristine;
+    H2GISExportToEWKB(&oLine, 4326, abyPristine);
+    oResults.Add(RunBenchmark(
+        "ewkb_to_geometry", oOptions.nIterations,
+        [&]()
+        {
+            std::vector<uint8_t> abyEWKB(abyPristine.size());
+            const int32_t nLen = static_cast<int32_t>(abyPristine.size());
+            double dfSum = 0;
+            for (GIntBig i = 0; i < nRows; i++)
+            {
+                memcpy(abyEWKB.data(), abyPristine.data(), nLen);
+                OGRGeometry *poGeom =
+                    H2GISGeometryFromEWKB(abyEWKB.data(), nLen);
+                if (!poGeom)
+                    return GIntBig(-1);
+                dfSum += poGeom->toLineString()->getNumPoints();
+                delete poGeom;
+            }
+            g_dfSink = dfSum;
+            return nRows;
+        }));
+
+    // One statement per full write buffer, as FlushPendingInserts() builds
+    const std::string osColumns = "\"ID\", \"GEOM\", \"NAME\", \"VALUE\", "
+                                  "\"COUNT\"";
+    const GIntBig nStatements =
+        std::max<GIntBig>(1, nRows / H2GIS_INSERT_BUFFER_ROWS);
+    oResults.Add(RunBenchmark("insert_sql", oOptions.nIterations,
+                              [&]()
+                              {
+                                  double dfSum = 0;
+                                  for (GIntBig i = 0; i < nStatements; i++)
+                                      dfSum += H2GISBuildInsertSQL(
+                                                   "bench", osColumns, 5,
+                                                   H2GIS_INSERT_BUFFER_ROWS)
+                                                   .size();
+                                  g_dfSink = dfSum;
+                                  return nStatements;
+                              }));
+}
+
+/************************************************************************/
+/*                        End-to-end scenarios                          */
+/************************************************************************/
+
+constexpr const char *BENCH_LAYER = "bench";
+// Share of the grid selected by the bbox_scan window
+constexpr double BENCH_BBOX_FRACTION = 0.1;
+
+// Create the database and load nFeatures features through CreateFeature()
+GIntBig BulkInsert(const BenchOptions &oOptions)
+{
+    GDALDriver *poDriver =
+        GetGDALDriverManager()->GetDriverByName(H2GIS_DRIVER_NAME);
+    if (!poDriver)
+        return -1;
+    GDALDataset *poDS =
+        poDriver->Create(oOptions.osDB.c_str(), 0, 0, 0, GDT_Unknown, nullptr);
+    if (!poDS)
+        return -1;
+
+    OGRSpatialReference oSRS;
+    oSRS.importFromEPSG(4326);
+    CPLStringList aosLCO;
+    aosLCO.SetNameValue("SPATIAL_INDEX", "DEFERRED");
+    OGRLayer *poLayer =
+        poDS->CreateLayer(BENCH_LAYER, &oSRS, wkbLineString, aosLCO.List());
+    bool bOK = poLayer != nullptr;
+    if (bOK)
+    {
+        OGRFieldDefn oName("NAME", OFTString);
+        OGRFieldDefn oValue("VALUE", OFTReal);
+        OGRFieldDefn oCount("COUNT", OFTInteger);
+        bOK = poLayer->CreateField(&oName) == OGRERR_NONE &&
+              poLayer->CreateField(&oValue) == OGRERR_NONE &&
+              poLayer->CreateField(&oCount) == OGRERR_NONE;
+    }
+
+    if (bOK)
+    {
+        const GIntBig nSide = GridSide(oOptions.nFeatures);
+        OGRFeature oFeature(poLayer->GetLayerDefn());
+        OGRLineString oLine;
+        for (GIntBig i = 0; bOK && i < oOptions.nFeatures; i++)
+        {
+            MakeLine(i, nSide, oOptions.nVertices, oLine);
+            oFeature.SetFID(OGRNullFID);
+            oFeature.SetGeometry(&oLine);
+            oFeature.SetField(0, CPLSPrintf("feature_" CPL_FRMT_GIB, i));
+            oFeature.SetField(1, i * 0.5);
+            oFeature.SetField(2, static_cast<int>(i % 1000));
+            bOK = poLayer->CreateFeature(&oFeature) == OGRERR_NONE;
+        }
+    }
+
+    // Closing flushes the write buffer and builds the deferred index
+    GDALClose(poDS);
+    return bOK ? oOptions.nFeatures : -1;
+}
+
+GIntBig ScanLayer(OGRLayer *poLayer, std::vector<GIntBig> *panFIDs)
+{
+    poLayer->ResetReading();
+    GIntBig nFeatures = 0;
+    while (OGRFeature *poFeature = poLayer->GetNextFeature())
+    {
+        if (panFIDs)
+            panFIDs->push_back(poFeature->GetFID());
+        delete poFeature;
+        nFeatures++;
+    }
+    return nFeatures;
+}
+
+#if GDAL_VERSION_NUM >= 3060000
+GIntBig ExportArrow(OGRLayer *poLayer)
+{
+    struct ArrowArrayStream oStream;
+    if (!poLayer->GetArrowStream(&oStream, nullptr))
+        return -1;
+    GIntBig nRows = 0;
+    while (true)
+    {
+        struct ArrowArray oArray;
+        if (oStream.get_next(&oStream, &oArray) != 0)
+        {
+            nRows = -1;
+            break;
+        }
+        if (!oArray.release)
+            break;
+        nRows += oArray.length;
+        oArray.release(&oArray);
+    }
+    oStream.release(&oStream);
+    return nRows;
+}
+#endif
+
+GDALDataset *OpenDatabase(const BenchOptions &oOptions)
+{
+    return GDALDataset::FromHandle(
+        GDALOpenEx(oOptions.osDB.c_str(), GDAL_OF_VECTOR, nullptr,
+                   oOptions.aosOpenOptions, nullptr));
+}
+
+bool RunScenarios(const BenchOptions &oOptions, CPLJSONArray &oResults)
+{
+    RegisterOGRH2GIS();
+
+    CPLJSONObject oInsert = RunBenchmark("bulk_insert", 1, [&]()
+                                         { return BulkInsert(oOptions); });
+    oResults.Add(oInsert);
+    if (!oInsert.GetString("error").empty())
+        return false;
+
+    oResults.Add(RunBenchmark("open", oOptions.nIterations,
+                              [&]()
+                              {
+                                  GDALDataset *poDS = OpenDatabase(oOptions);
+                                  const bool bOK =
+                                      poDS && poDS->GetLayerCount() > 0;
+                                  GDALClose(poDS);
+                                  return bOK ? GIntBig(1) : GIntBig(-1);
+                              }));
+
+    GDALDataset *poDS = OpenDatabase(oOptions);
+    OGRLayer *poLayer = poDS ? poDS->GetLayerByName(BENCH_LAYER) : nullptr;
+    if (!poLayer)
+    {
+        GDALClose(poDS);
+        return false;
+    }
+
+    std::vector<GIntBig> anFIDs;
+    ScanLayer(poLayer, &anFIDs);
+    oResults.Add(RunBenchmark("full_scan", oOptions.nIterations, [&]()
+                              { return ScanLayer(poLayer, nullptr); }));
+
+    const double dfHalf = 500.0 * std::sqrt(BENCH_BBOX_FRACTION);
+    poLayer->SetSpatialFilterRect(500.0 - dfHalf, 500.0 - dfHalf,
+                                  500.0 + dfHalf, 500.0 + dfHalf);
+    oResults.Add(RunBenchmark("bbox_scan", oOptions.nIterations, [&]()
+                              { return ScanLayer(poLayer, nullptr); }));
+    poLayer->SetSpatialFilter(nullptr);
+
+    // The same FIDs in every iteration, drawn with a fixed seed
+    std::mt19937 oRandom(42);
+    std::vector<GIntBig> anReads;
+    for (int i = 0; !anFIDs.empty() && i < oOptions.nRandomReads; i++)
+        anReads.push_back(anFIDs[oRandom() % anFIDs.size()]);
+    oResults.Add(RunBenchmark("random_get_feature", oOptions.nIterations,
+                              [&]()
+                              {
+                                  for (GIntBig nFID : anReads)
+                                  {
+                                      OGRFeature *poFeature =
+                                          poLayer->GetFeature(nFID);
+                                      if (!poFeature)
+                                          return GIntBig(-1);
+                                      delete poFeature;
+                                  }
+                                  return GIntBig(anReads.size());
+                              }));
+
+#if GDAL_VERSION_NUM >= 3060000
+    oResults.Add(RunBenchmark("arrow_export", oOptions.nIterations, [&]()
+                              { return ExportArrow(poLayer); }));
+#endif
+
+    GDALClose(poDS);
+    return true;
+}
+
+bool ParseArgs(int argc, char **argv, BenchOptions &oOptions)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *pszArg = argv[i];
+        const bool bHasValue = i + 1 < argc;
+        if (EQUAL(pszArg, "--iterations") && bHasValue)
+            oOptions.nIterations = std::max(1, atoi(argv[++i]));
+        else if (EQUAL(pszArg, "--micro-rows") && bHasValue)
+            oOptions.nMicroRows = CPLAtoGIntBig(argv[++i]);
+        else if (EQUAL(pszArg, "--features") && bHasValue)
+            oOptions.nFeatures = std::max<GIntBig>(1, CPLAtoGIntBig(argv[++i]));
+        else if (EQUAL(pszArg, "--vertices") && bHasValue)
+            oOptions.nVertices = std::max(2, atoi(argv[++i]));
+        else if (EQUAL(pszArg, "--random-reads") && bHasValue)
+            oOptions.nRandomReads = std::max(0, atoi(argv[++i]));
+        else if (EQUAL(pszArg, "--db") && bHasValue)
+            oOptions.osDB = argv[++i];
+        else if (EQUAL(pszArg, "--oo") && bHasValue)
+            oOptions.aosOpenOptions.AddString(argv[++i]);
+        else if (EQUAL(pszArg, "--output") && bHasValue)
+            oOptions.osOutput = argv[++i];
+        else if (EQUAL(pszArg, "--micro-only"))
+            oOptions.bMicroOnly = true;
+        else if (EQUAL(pszArg, "--keep"))
+            oOptions.bKeep = true;
+        else
+            return false;
+    }
+
+    if (oOptions.osDB.empty())
+    {
+        oOptions.osDB = CPLGenerateTempFilename("h2gis_bench");
+        oOptions.osDB += ".mv.db";
+    }
+    if (CPLIsFilenameRelative(oOptions.osDB.c_str()))
+    {
+        // H2 resolves relative paths against its own base directory
+        char *pszCurDir = CPLGetCurrentDir();
+        if (pszCurDir)
+            oOptions.osDB = CPLFormFilename(pszCurDir, oOptions.osDB.c_str(),
+                                            nullptr);
+        CPLFree(pszCurDir);
+    }
+    return true;
+}
+
+void RemoveDatabase(const std::string &osDB)
+{
+    VSIUnlink(osDB.c_str());
+    const std::string osBase = osDB.substr(0, osDB.size() - strlen(".mv.db"));
+    VSIUnlink((osBase + ".trace.db").c_str());
+    VSIUnlink((osDB + H2GIS_METADATA_CACHE_SUFFIX).c_str());
+}
+
+}  // namespace
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main(int argc, char **argv)
+{
+    BenchOptions oOptions;
+    if (!ParseArgs(argc, argv, oOptions))
+    {
+        Usage();
+        return 1;
+    }
+
+    CPLJSONDocument oDoc;
+    CPLJSONObject oRoot = oDoc.GetRoot();
+    oRoot.Add("gdal_version", GDALVersionInfo("RELEASE_NAME"));
+
+    CPLJSONObject oParameters;
+    oParameters.Add("iterations", oOptions.nIterations);
+    oParameters.Add("micro_rows", static_cast<GInt64>(oOptions.nMicroRows));
+    oParameters.Add("batch_rows", H2GIS_BATCH_SIZE);
+    oParameters.Add("features", static_cast<GInt64>(oOptions.nFeatures));
+    oParameters.Add("vertices", oOptions.nVertices);
+    oParameters.Add("random_reads", oOptions.nRandomReads);
+    oParameters.Add("bbox_fraction", BENCH_BBOX_FRACTION);
+    CPLJSONArray oOpenOptions;
+    for (int i = 0; i < oOptions.aosOpenOptions.Count(); i++)
+        oOpenOptions.Add(oOptions.aosOpenOptions[i]);
+    oParameters.Add("open_options", oOpenOptions);
+    oRoot.Add("parameters", oParameters);
+
+    CPLJSONArray oMicro;
+    RunMicroBenchmarks(oOptions, oMicro);
+    oRoot.Add("micro", oMicro);
+
+    bool bOK = true;
+    if (!oOptions.bMicroOnly)
+    {
+        oRoot.Add("database", oOptions.osDB);
+        CPLJSONArray oScenarios;
+        bOK = RunScenarios(oOptions, oScenarios);
+        oRoot.Add("scenarios", oScenarios);
+        if (!oOptions.bKeep)
+            RemoveDatabase(oOptions.osDB);
+    }
+    GDALDestroyDriverManager();
+
+    if (oOptions.osOutput.empty())
+        printf("%s\n",
+               oRoot.Format(CPLJSONObject::PrettyFormat::Pretty).c_str());
+    else if (!oDoc.Save(oOptions.osOutput))
+        bOK = false;
+    return bOK ? 0 : 1;
+}
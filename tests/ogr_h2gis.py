@@ -122,6 +122,151 @@ def test_ogr_h2gis_srid_crs_roundtrip(h2gis_ds):
     assert abs(geom_read.GetY() - 48.85) < 0.001
 
 
+def test_ogr_h2gis_ewkb_geometries(h2gis_ds):
+    """Test EWKB geometries with SRID on every read path."""
+    srs = osr.SpatialReference()
+    srs.ImportFromEPSG(4326)
+    lyr = h2gis_ds.CreateLayer("ewkb_test", srs=srs,
+                               geom_type=ogr.wkbPolygon)
+    wkt = "POLYGON ((0 0,0 1,1 1,1 0,0 0))"
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetGeometry(ogr.CreateGeometryFromWkt(wkt))
+    assert lyr.CreateFeature(feat) == 0
+    fid = feat.GetFID()
+
+    lyr.ResetReading()
+    assert lyr.GetNextFeature().GetGeometryRef().ExportToWkt() == wkt
+    assert lyr.GetFeature(fid).GetGeometryRef().ExportToWkt() == wkt
+
+    sql_lyr = h2gis_ds.ExecuteSQL('SELECT "GEOM" FROM "ewkb_test"')
+    feat = sql_lyr.GetNextFeature()
+    assert feat.GetGeometryRef() is not None
+    assert feat.GetGeometryRef().ExportToWkt() == wkt
+    h2gis_ds.ReleaseResultSet(sql_lyr)
+
+
+def test_ogr_h2gis_decode_columns(h2gis_ds):
+    """Test that decoded values land in their field, whatever is selected."""
+    lyr = h2gis_ds.CreateLayer("decode_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("name", ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn("val", ogr.OFTReal))
+    lyr.CreateField(ogr.FieldDefn("n", ogr.OFTInteger64))
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField("name", "first")
+    feat.SetField("val", 1.5)
+    feat.SetField("n", 1234567890123)
+    feat.SetGeometry(ogr.CreateGeometryFromWkt("POINT (1 2)"))
+    assert lyr.CreateFeature(feat) == 0
+
+    lyr.SetIgnoredFields(["val"])
+    lyr.ResetReading()
+    feat = lyr.GetNextFeature()
+    assert feat.GetField("name") == "first"
+    assert not feat.IsFieldSet("val")
+    assert feat.GetField("n") == 1234567890123
+    assert feat.GetGeometryRef().ExportToWkt() == "POINT (1 2)"
+    lyr.SetIgnoredFields([])
+
+    # _ROWID_ gives the FID of result rows and is not a field
+    sql_lyr = h2gis_ds.ExecuteSQL(
+        'SELECT _ROWID_, "name", "val" FROM "decode_test"')
+    assert sql_lyr.GetLayerDefn().GetFieldCount() == 2
+    feat = sql_lyr.GetNextFeature()
+    assert feat.GetFieldAsString(0) == "first"
+    assert feat.GetFieldAsDouble(1) == 1.5
+    h2gis_ds.ReleaseResultSet(sql_lyr)
+
+
+def test_ogr_h2gis_sql_result_filters(h2gis_ds):
+    """Test filters, counts and ignored fields on ExecuteSQL() results."""
+    srs = osr.SpatialReference()
+    srs.ImportFromEPSG(4326)
+    lyr = h2gis_ds.CreateLayer("sql_filter_test", srs=srs,
+                               geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn("label", ogr.OFTString))
+    for i in range(10):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        feat.SetField("label", f"f{i}")
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {i})"))
+        assert lyr.CreateFeature(feat) == 0
+
+    sql = 'SELECT "idx", "label", "GEOM" FROM "sql_filter_test" ORDER BY "idx"'
+    sql_lyr = h2gis_ds.ExecuteSQL(
+        sql, ogr.CreateGeometryFromWkt(
+            "POLYGON ((1.5 1.5,1.5 5.5,5.5 5.5,5.5 1.5,1.5 1.5))"))
+    assert sql_lyr.GetFeatureCount() == 4
+    assert [f.GetField("idx") for f in sql_lyr] == [2, 3, 4, 5]
+
+    sql_lyr.SetAttributeFilter('"idx" >= 4')
+    assert sql_lyr.GetFeatureCount() == 2
+    assert [f.GetField("idx") for f in sql_lyr] == [4, 5]
+
+    sql_lyr.SetSpatialFilter(None)
+    sql_lyr.SetAttributeFilter(None)
+    assert sql_lyr.GetFeatureCount() == 10
+    assert sql_lyr.TestCapability(ogr.OLCIgnoreFields)
+    sql_lyr.SetIgnoredFields(["label", "OGR_GEOMETRY"])
+    feat = sql_lyr.GetNextFeature()
+    assert feat.GetField("idx") == 0
+    assert not feat.IsFieldSet("label")
+    assert feat.GetGeometryRef() is None
+    h2gis_ds.ReleaseResultSet(sql_lyr)
+
+    # Statements that cannot be wrapped are filtered on the features
+    sql_lyr = h2gis_ds.ExecuteSQL(
+        'SELECT a."idx", b."idx" FROM "sql_filter_test" a, '
+        '"sql_filter_test" b WHERE a."idx" = b."idx"')
+    sql_lyr.SetAttributeFilter("idx < 3")
+    assert sql_lyr.GetFeatureCount() == 3
+    h2gis_ds.ReleaseResultSet(sql_lyr)
+
+
+def test_ogr_h2gis_same_type_decode(h2gis_ds):
+    """Test values stored as is and rejected result rows decoded again."""
+    lyr = h2gis_ds.CreateLayer("same_type_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("s", ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn("i", ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn("big", ogr.OFTInteger64))
+    lyr.CreateField(ogr.FieldDefn("r", ogr.OFTReal))
+    for i in range(6):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        if i != 1:
+            feat.SetField("s", f"row {i}")
+            feat.SetField("r", i * 0.25)
+        feat.SetField("i", i)
+        feat.SetField("big", (1 << 40) + i)
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} 0)"))
+        assert lyr.CreateFeature(feat) == 0
+
+    lyr.ResetReading()
+    feat = lyr.GetNextFeature()
+    assert feat.GetField("s") == "row 0"
+    assert feat.GetField("i") == 0
+    assert feat.GetField("big") == 1 << 40
+    assert feat.GetField("r") == 0.0
+    feat = lyr.GetNextFeature()
+    assert not feat.IsFieldSet("s")
+    assert not feat.IsFieldSet("r")
+    assert feat.GetField("big") == (1 << 40) + 1
+
+    # Not wrappable (duplicate column names): rows 0, 2 and 5 are rejected
+    # on the client and their features decoded again for the next rows
+    sql_lyr = h2gis_ds.ExecuteSQL(
+        'SELECT a."s", a."i", a."big", a."r", b."i" FROM "same_type_test" a, '
+        '"same_type_test" b WHERE a."i" = b."i" ORDER BY a."i"')
+    sql_lyr.SetAttributeFilter(
+        "big IN (1099511627777, 1099511627779, 1099511627780)")
+    rows = [(f.GetField(0) if f.IsFieldSet(0) else None, f.GetField(1),
+             f.GetField(2), f.GetField(3) if f.IsFieldSet(3) else None)
+            for f in sql_lyr]
+    assert rows == [(None, 1, (1 << 40) + 1, None),
+                    ("row 3", 3, (1 << 40) + 3, 0.75),
+                    ("row 4", 4, (1 << 40) + 4, 1.0)]
+    h2gis_ds.ReleaseResultSet(sql_lyr)
+
+
 def test_ogr_h2gis_geometry_types(h2gis_ds):
     """Test that different geometry types are correctly preserved."""
     test_cases = [
@@ -299,6 +444,368 @@ def test_ogr_h2gis_date_datetime_fields(h2gis_ds):
     # This test verifies that CREATE FIELD and INSERT work correctly.
 
 
+def test_ogr_h2gis_prepared_insert(h2gis_ds):
+    """Test that CreateFeature() binds values through a prepared INSERT."""
+    srs = osr.SpatialReference()
+    srs.ImportFromEPSG(4326)
+    lyr = h2gis_ds.CreateLayer("insert_test", srs=srs, geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("i", ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn("big", ogr.OFTInteger64))
+    lyr.CreateField(ogr.FieldDefn("r", ogr.OFTReal))
+    lyr.CreateField(ogr.FieldDefn("s", ogr.OFTString))
+
+    fids = []
+    for i in range(50):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("i", i)
+        feat.SetField("big", 1 << 40 | i)
+        feat.SetField("r", i + 0.25)
+        if i % 2:
+            feat.SetFieldNull("s")
+        else:
+            feat.SetField("s", f"it's {i}")
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} -{i})"))
+        assert lyr.CreateFeature(feat) == 0
+        fids.append(feat.GetFID())
+
+    # Generated FIDs are returned to the caller
+    assert len(set(fids)) == 50
+    assert min(fids) >= 1
+
+    lyr.ResetReading()
+    for i, feat in enumerate(lyr):
+        assert feat.GetFID() == fids[i]
+        assert feat.GetField("i") == i
+        assert feat.GetField("big") == 1 << 40 | i
+        assert feat.GetField("r") == i + 0.25
+        if i % 2:
+            assert not feat.IsFieldSetAndNotNull("s")
+        else:
+            assert feat.GetField("s") == f"it's {i}"
+        geom = feat.GetGeometryRef()
+        assert (geom.GetX(), geom.GetY()) == (i, -i)
+        assert geom.GetSpatialReference().GetAuthorityCode(None) == "4326"
+
+    # An explicit FID is inserted as is
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetFID(1000)
+    feat.SetField("i", 1000)
+    assert lyr.CreateFeature(feat) == 0
+    assert lyr.GetFeature(1000).GetField("i") == 1000
+
+
+def test_ogr_h2gis_buffered_inserts(h2gis_ds):
+    """Test the insert buffer and implicit transactions."""
+    lyr = h2gis_ds.CreateLayer("buffer_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+
+    # More than one buffer, outside any explicit transaction, with and
+    # without geometries and with a varying set of fields
+    nFeatures = 1234
+    fids = []
+    for i in range(nFeatures):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        if i % 100 != 7:
+            feat.SetField("idx", i)
+        if i % 3:
+            feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {i})"))
+        assert lyr.CreateFeature(feat) == 0
+        fids.append(feat.GetFID())
+    assert fids == list(range(fids[0], fids[0] + nFeatures))
+
+    # Reads see the queued features
+    assert lyr.GetFeatureCount() == nFeatures
+    feat = lyr.GetFeature(fids[-1])
+    assert feat.GetField("idx") == nFeatures - 1
+    assert feat.GetGeometryRef() is not None
+    assert lyr.GetFeature(fids[3]).GetGeometryRef() is None
+    assert not lyr.GetFeature(fids[7]).IsFieldSet("idx")
+
+    # Inserts relying on the FID column default do not collide
+    assert lyr.SyncToDisk() == 0
+    h2gis_ds.ExecuteSQL('INSERT INTO "buffer_test" ("idx") VALUES (-1)')
+    sql_lyr = h2gis_ds.ExecuteSQL(
+        f'SELECT COUNT(*) AS n FROM "buffer_test" WHERE "ID" > {fids[-1]}')
+    assert sql_lyr.GetNextFeature().GetField(0) == 1
+    h2gis_ds.ReleaseResultSet(sql_lyr)
+
+    # Queued features are dropped by a rollback
+    assert h2gis_ds.StartTransaction() == 0
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField("idx", 5000)
+    assert lyr.CreateFeature(feat) == 0
+    assert h2gis_ds.RollbackTransaction() == 0
+    lyr.SetAttributeFilter('"idx" = 5000')
+    assert lyr.GetFeatureCount() == 0
+    lyr.SetAttributeFilter(None)
+    assert lyr.GetFeatureCount() == nFeatures + 1
+
+
+def test_ogr_h2gis_buffered_inserts_failing_row(h2gis_ds):
+    """Test that a failing feature does not lose the rest of the queue."""
+    lyr = h2gis_ds.CreateLayer("failing_row_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+    for i in range(5):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        assert lyr.CreateFeature(feat) == 0
+    assert lyr.SyncToDisk() == 0
+    existing_fid = feat.GetFID()
+
+    # One explicit FID of the queue is taken
+    for i in range(10):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetFID(existing_fid if i == 5 else 100 + i)
+        feat.SetField("idx", 100 + i)
+        assert lyr.CreateFeature(feat) == 0
+    messages = []
+    gdal.PushErrorHandler(lambda cls, no, msg: messages.append(msg))
+    try:
+        assert lyr.SyncToDisk() != 0
+    finally:
+        gdal.PopErrorHandler()
+    assert any(f"buffered feature {existing_fid} " in m for m in messages)
+
+    assert lyr.GetFeatureCount() == 14
+    assert lyr.GetFeature(existing_fid).GetField("idx") == 4
+    assert lyr.GetFeature(104).GetField("idx") == 104
+    assert lyr.GetFeature(109).GetField("idx") == 109
+
+
+def test_ogr_h2gis_buffered_inserts_concurrent_writers(h2gis_ds):
+    """Test two datasets queueing inserts into the same table at once."""
+    lyr = h2gis_ds.CreateLayer("writers_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+    assert lyr.SyncToDisk() == 0
+
+    ds2 = gdal.OpenEx(h2gis_ds.GetDescription(),
+                      gdal.OF_VECTOR | gdal.OF_UPDATE)
+    lyr2 = ds2.GetLayerByName("writers_test")
+    for i in range(10):
+        for layer, idx in ((lyr, i), (lyr2, 100 + i)):
+            feat = ogr.Feature(layer.GetLayerDefn())
+            feat.SetField("idx", idx)
+            assert layer.CreateFeature(feat) == 0
+
+    # Both expect the same identity values: the second flush gets others
+    messages = []
+    gdal.PushErrorHandler(lambda cls, no, msg: messages.append(msg))
+    try:
+        assert lyr.SyncToDisk() == 0
+        assert lyr2.SyncToDisk() == 0
+    finally:
+        gdal.PopErrorHandler()
+    assert any("got another FID" in m for m in messages)
+    ds2 = None
+
+    sql_lyr = h2gis_ds.ExecuteSQL(
+        'SELECT COUNT(DISTINCT "ID") AS n FROM "writers_test"')
+    assert sql_lyr.GetNextFeature().GetField(0) == 20
+    h2gis_ds.ReleaseResultSet(sql_lyr)
+
+
+def test_ogr_h2gis_buffered_inserts_concurrent_fids(h2gis_ds):
+    """Test that buffered inserts do not reuse FIDs taken by another dataset
+    of the database through the FID identity after a commit."""
+    lyr = h2gis_ds.CreateLayer("fid_alloc_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+
+    def insert(idx):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", idx)
+        assert lyr.CreateFeature(feat) == 0
+        return feat.GetFID()
+
+    fids = [insert(i) for i in range(10)]
+    assert lyr.SyncToDisk() == 0
+
+    # Another dataset inserts through the column default
+    ds2 = gdal.OpenEx(h2gis_ds.GetDescription(),
+                      gdal.OF_VECTOR | gdal.OF_UPDATE)
+    ds2.ExecuteSQL('INSERT INTO "fid_alloc_test" ("idx") VALUES (-1)')
+    ds2 = None
+
+    fids += [insert(i) for i in range(10, 20)]
+    assert lyr.SyncToDisk() == 0
+    assert len(set(fids)) == 20
+    assert lyr.GetFeatureCount() == 21
+
+    # The identity never moves back over FIDs handed out before
+    assert lyr.DeleteFeature(fids[-1]) == 0
+    assert lyr.SyncToDisk() == 0
+    assert insert(20) > fids[-1]
+    assert lyr.SyncToDisk() == 0
+    h2gis_ds.ExecuteSQL('INSERT INTO "fid_alloc_test" ("idx") VALUES (-2)')
+    lyr.SetAttributeFilter('"idx" = -2')
+    assert lyr.GetNextFeature().GetFID() > fids[-1] + 1
+    lyr.SetAttributeFilter(None)
+    assert lyr.GetFeatureCount() == 22
+
+
+def test_ogr_h2gis_deferred_spatial_index(h2gis_ds):
+    """Test that SPATIAL_INDEX=DEFERRED builds the index after loading."""
+
+    def spatial_index_count():
+        sql_lyr = h2gis_ds.ExecuteSQL(
+            "SELECT COUNT(*) AS n FROM INFORMATION_SCHEMA.INDEXES "
+            "WHERE TABLE_NAME = 'deferred_idx' "
+            "AND INDEX_TYPE_NAME = 'SPATIAL INDEX'")
+        n = sql_lyr.GetNextFeature().GetField(0)
+        h2gis_ds.ReleaseResultSet(sql_lyr)
+        return n
+
+    lyr = h2gis_ds.CreateLayer("deferred_idx", geom_type=ogr.wkbPoint,
+                               options=["SPATIAL_INDEX=DEFERRED"])
+    for i in range(100):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {i})"))
+        assert lyr.CreateFeature(feat) == 0
+    assert spatial_index_count() == 0
+
+    # First read builds the index
+    lyr.SetSpatialFilterRect(10.5, 10.5, 20.5, 20.5)
+    assert lyr.GetFeatureCount() == 10
+    assert spatial_index_count() == 1
+    lyr.SetSpatialFilter(None)
+
+
+def test_ogr_h2gis_extent_cache(h2gis_ds):
+    """Test that the layer extent is cached, saved and invalidated."""
+    lyr = h2gis_ds.CreateLayer("extent_cache", geom_type=ogr.wkbPoint)
+    for i in range(10):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {2 * i})"))
+        assert lyr.CreateFeature(feat) == 0
+
+    # Widened by each insert, no scan needed
+    assert lyr.TestCapability(ogr.OLCFastGetExtent) == 1
+    assert lyr.GetExtent(force=0) == (0, 9, 0, 18)
+
+    # Saved on flush, found by the next session without computing it
+    assert lyr.SyncToDisk() == 0
+    ds = gdal.OpenEx(h2gis_ds.GetDescription(), gdal.OF_VECTOR)
+    assert ds.GetLayerCount() == 1  # Side table is not a layer
+    other_lyr = ds.GetLayerByName("extent_cache")
+    assert other_lyr.TestCapability(ogr.OLCFastGetExtent) == 1
+    assert other_lyr.GetExtent(force=0) == (0, 9, 0, 18)
+    ds = None
+
+    # Delete invalidates it until a forced computation
+    lyr.ResetReading()
+    last_fid = max(f.GetFID() for f in lyr)
+    assert lyr.DeleteFeature(last_fid) == 0
+    assert lyr.TestCapability(ogr.OLCFastGetExtent) == 0
+    assert lyr.GetExtent() == (0, 8, 0, 16)
+    assert lyr.TestCapability(ogr.OLCFastGetExtent) == 1
+
+    # Rows written by another application are seen by forced calls, which
+    # refresh the cached and saved extent
+    assert lyr.SyncToDisk() == 0
+    ds = gdal.OpenEx(h2gis_ds.GetDescription(),
+                     gdal.OF_VECTOR | gdal.OF_UPDATE)
+    ds.ExecuteSQL('INSERT INTO "extent_cache" ("GEOM") '
+                  "VALUES (ST_GeomFromText('POINT (100 200)'))")
+    ds = None
+    assert lyr.GetExtent() == (0, 100, 0, 200)
+    assert lyr.GetExtent(force=0) == (0, 100, 0, 200)
+    assert lyr.SyncToDisk() == 0
+    ds = gdal.OpenEx(h2gis_ds.GetDescription(), gdal.OF_VECTOR)
+    assert ds.GetLayerByName("extent_cache").GetExtent(force=0) == \
+        (0, 100, 0, 200)
+    ds = None
+
+
+def test_ogr_h2gis_feature_count_cache(h2gis_ds):
+    """Test that counts follow the writes and filtered counts are cached."""
+    lyr = h2gis_ds.CreateLayer("count_cache", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+    for i in range(20):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {i})"))
+        assert lyr.CreateFeature(feat) == 0
+
+    # Exact without a scan, also after deletes
+    assert lyr.GetFeatureCount(force=0) == 20
+    lyr.ResetReading()
+    fid = lyr.GetNextFeature().GetFID()
+    assert lyr.DeleteFeature(fid) == 0
+    assert lyr.GetFeatureCount(force=0) == 19
+
+    lyr.SetAttributeFilter("idx >= 10")
+    assert lyr.GetFeatureCount(force=0) == -1
+    assert lyr.GetFeatureCount() == 10
+    assert lyr.GetFeatureCount(force=0) == 10  # Cached
+    lyr.SetSpatialFilterRect(11.5, 11.5, 20, 20)
+    assert lyr.GetFeatureCount() == 8
+    lyr.SetSpatialFilter(None)
+    assert lyr.GetFeatureCount(force=0) == 10
+
+    # Writes drop the cached filtered counts
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField("idx", 100)
+    assert lyr.CreateFeature(feat) == 0
+    assert lyr.GetFeatureCount() == 11
+
+    # A filtered count does not replace the unfiltered one
+    lyr.SetAttributeFilter(None)
+    assert lyr.GetFeatureCount(force=0) == 20
+
+
+def test_ogr_h2gis_metadata_cache(tmp_path, h2gis_driver):
+    """Test that METADATA_CACHE=YES reopens an unchanged database from the
+    cache file, and that schema changes make it query the database again."""
+    path = str(tmp_path / "cache.mv.db")
+    ds = h2gis_driver.CreateDataSource(path)
+    lyr = ds.CreateLayer("cached", geom_type=ogr.wkbPolygon)
+    lyr.CreateField(ogr.FieldDefn("name", ogr.OFTString))
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField("name", "a")
+    feat.SetGeometry(ogr.CreateGeometryFromWkt(
+        "POLYGON ((0 0, 1 0, 1 1, 0 0))"))
+    assert lyr.CreateFeature(feat) == 0
+    ds = None
+
+    messages = []
+
+    def open_cached():
+        messages.clear()
+        gdal.PushErrorHandler(lambda cls, no, msg: messages.append(msg))
+        gdal.SetConfigOption("CPL_DEBUG", "ON")
+        try:
+            return gdal.OpenEx(path, gdal.OF_VECTOR | gdal.OF_UPDATE,
+                               open_options=["METADATA_CACHE=YES"])
+        finally:
+            gdal.SetConfigOption("CPL_DEBUG", None)
+            gdal.PopErrorHandler()
+
+    def read_from_cache():
+        return any("metadata cache" in m and "read" in m for m in messages)
+
+    # First open queries the database and saves the cache on close
+    ds = open_cached()
+    assert not read_from_cache()
+    assert ds.GetLayerCount() == 1
+    ds = None
+    assert (tmp_path / "cache.h2gis_cache.json").exists()
+
+    ds = open_cached()
+    assert read_from_cache()
+    lyr = ds.GetLayerByName("cached")
+    assert lyr.GetGeomType() == ogr.wkbPolygon
+    assert lyr.GetLayerDefn().GetFieldIndex("name") >= 0
+    assert lyr.GetFeatureCount() == 1
+    assert lyr.GetNextFeature().GetField("name") == "a"
+
+    # A new table is seen by the next open
+    ds.CreateLayer("other", geom_type=ogr.wkbPoint)
+    ds = None
+    ds = open_cached()
+    assert not read_from_cache()
+    assert ds.GetLayerCount() == 2
+    ds = None
+
+
 def test_ogr_h2gis_set_next_by_index(h2gis_ds):
     """Test SetNextByIndex for fast random access."""
     lyr = h2gis_ds.CreateLayer("setnext_test", geom_type=ogr.wkbPoint)
@@ -326,3 +833,746 @@ def test_ogr_h2gis_set_next_by_index(h2gis_ds):
     feat = lyr.GetNextFeature()
     assert feat is not None
     assert feat.GetField("idx") == 6
+
+
+def test_ogr_h2gis_set_next_by_index_keyset(h2gis_ds):
+    """Test SetNextByIndex seeks from recorded batch boundaries."""
+    lyr = h2gis_ds.CreateLayer("keyset_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+
+    nFeatures = 3500
+    assert h2gis_ds.StartTransaction() == 0
+    for i in range(nFeatures):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {i})"))
+        assert lyr.CreateFeature(feat) == 0
+    assert h2gis_ds.CommitTransaction() == 0
+
+    # First seek, then a full ordered scan records the batch boundaries
+    assert lyr.SetNextByIndex(10) == 0
+    assert lyr.GetNextFeature().GetField("idx") == 10
+    lyr.ResetReading()
+    assert [f.GetField("idx") for f in lyr] == list(range(nFeatures))
+
+    for nIndex in (2500, 1999, 3499, 0, 1000):
+        assert lyr.SetNextByIndex(nIndex) == 0
+        assert lyr.GetNextFeature().GetField("idx") == nIndex
+        assert lyr.GetNextFeature() is not None or nIndex == nFeatures - 1
+
+    # Deleting a feature shifts the indexes of the following ones
+    lyr.ResetReading()
+    fid = lyr.GetNextFeature().GetFID()
+    assert lyr.DeleteFeature(fid) == 0
+    assert lyr.SetNextByIndex(2500) == 0
+    assert lyr.GetNextFeature().GetField("idx") == 2501
+
+    # Seeks honour the attribute filter
+    lyr.SetAttributeFilter('"idx" >= 3000')
+    assert lyr.SetNextByIndex(5) == 0
+    assert lyr.GetNextFeature().GetField("idx") == 3005
+    lyr.SetAttributeFilter(None)
+
+
+def test_ogr_h2gis_set_next_by_index_non_unique_fid(h2gis_ds):
+    """Test SetNextByIndex on a table whose ID column holds duplicates."""
+    h2gis_ds.ExecuteSQL(
+        'CREATE TABLE "dup_fid_test" ("ID" INT, "idx" INT)')
+    h2gis_ds.ExecuteSQL(
+        'INSERT INTO "dup_fid_test" SELECT X / 7, X FROM SYSTEM_RANGE(0, 299)')
+
+    # Small batches, so that a keyset seek would start within duplicates
+    ds = gdal.OpenEx(h2gis_ds.GetDescription(), gdal.OF_VECTOR,
+                     open_options=["BATCH_SIZE=10"])
+    lyr = ds.GetLayerByName("dup_fid_test")
+    assert lyr.SetNextByIndex(3) == 0
+    values = []
+    feat = lyr.GetNextFeature()
+    while feat is not None:
+        values.append(feat.GetField("idx"))
+        feat = lyr.GetNextFeature()
+    assert values == list(range(3, 300))
+
+    for nIndex in (125, 24, 299, 0, 73):
+        assert lyr.SetNextByIndex(nIndex) == 0
+        assert lyr.GetNextFeature().GetField("idx") == nIndex
+        feat = lyr.GetNextFeature()
+        assert feat is None or feat.GetField("idx") == nIndex + 1
+    ds = None
+
+def test_ogr_h2gis_ignored_fields(h2gis_ds):
+    """Test that SetIgnoredFields projects columns out of the SELECT."""
+    lyr = h2gis_ds.CreateLayer("ignored_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("keep", ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn("drop", ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn("last", ogr.OFTReal))
+
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField("keep", 7)
+    feat.SetField("drop", "unused")
+    feat.SetField("last", 1.5)
+    feat.SetGeometry(ogr.CreateGeometryFromWkt("POINT (1 2)"))
+    assert lyr.CreateFeature(feat) == 0
+
+    assert lyr.SetIgnoredFields(["drop", "OGR_GEOMETRY"]) == 0
+    lyr.ResetReading()
+    feat_read = lyr.GetNextFeature()
+    assert feat_read is not None
+    assert feat_read.GetFID() >= 1
+    assert feat_read.GetField("keep") == 7
+    assert not feat_read.IsFieldSet("drop")
+    assert feat_read.GetField("last") == 1.5
+    assert feat_read.GetGeometryRef() is None
+
+    assert lyr.SetIgnoredFields(None) == 0
+    lyr.ResetReading()
+    feat_read = lyr.GetNextFeature()
+    assert feat_read.GetField("drop") == "unused"
+    assert feat_read.GetGeometryRef() is not None
+
+def test_ogr_h2gis_get_feature_burst(h2gis_ds):
+    """Test GetFeature() through cached statements and FID range fetches."""
+    lyr = h2gis_ds.CreateLayer("get_feature_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn("name", ogr.OFTString))
+
+    assert h2gis_ds.StartTransaction() == 0
+    for i in range(200):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        feat.SetField("name", f"n{i}")
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {i})"))
+        assert lyr.CreateFeature(feat) == 0
+    assert h2gis_ds.CommitTransaction() == 0
+
+    lyr.ResetReading()
+    fids = [f.GetFID() for f in lyr]
+
+    # Sequential lookups are served by growing FID range fetches
+    for i, fid in enumerate(fids):
+        feat = lyr.GetFeature(fid)
+        assert feat.GetFID() == fid
+        assert feat.GetField("idx") == i
+        assert feat.GetField("name") == f"n{i}"
+        assert feat.GetGeometryRef().GetX() == i
+
+    # Random and missing lookups
+    for i in (150, 3, 199, 42):
+        assert lyr.GetFeature(fids[i]).GetField("idx") == i
+    assert lyr.GetFeature(fids[-1] + 1000) is None
+
+    # Writes invalidate features fetched ahead
+    assert lyr.GetFeature(fids[10]) is not None
+    feat = lyr.GetFeature(fids[11])
+    feat.SetField("name", "updated")
+    assert lyr.SetFeature(feat) == 0
+    assert lyr.DeleteFeature(fids[12]) == 0
+    assert lyr.GetFeature(fids[11]).GetField("name") == "updated"
+    assert lyr.GetFeature(fids[12]) is None
+    assert lyr.GetFeature(fids[13]).GetField("idx") == 13
+
+    # Ignored fields apply to cached lookups too
+    assert lyr.SetIgnoredFields(["name"]) == 0
+    feat = lyr.GetFeature(fids[20])
+    assert feat.GetField("idx") == 20
+    assert not feat.IsFieldSet("name")
+    assert not lyr.GetFeature(fids[21]).IsFieldSet("name")
+    assert lyr.SetIgnoredFields([]) == 0
+    assert lyr.GetFeature(fids[22]).GetField("name") == "n22"
+
+
+def test_ogr_h2gis_prefetch(h2gis_ds):
+    """Test PREFETCH=YES scans across several batches and resets."""
+    lyr = h2gis_ds.CreateLayer("prefetch_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+
+    nFeatures = 2500  # several 1000-row batches, the last one short
+    assert h2gis_ds.StartTransaction() == 0
+    for i in range(nFeatures):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {i})"))
+        assert lyr.CreateFeature(feat) == 0
+    assert h2gis_ds.CommitTransaction() == 0
+
+    ds = gdal.OpenEx(h2gis_ds.GetDescription(), gdal.OF_VECTOR,
+                     open_options=["PREFETCH=YES"])
+    assert ds is not None
+    lyr = ds.GetLayerByName("prefetch_test")
+    assert lyr is not None
+
+    assert [f.GetField("idx") for f in lyr] == list(range(nFeatures))
+
+    # Reset while the next batch is still in flight
+    lyr.ResetReading()
+    for _ in range(1500):
+        assert lyr.GetNextFeature() is not None
+    lyr.ResetReading()
+    feat = lyr.GetNextFeature()
+    assert feat.GetField("idx") == 0
+    assert feat.GetGeometryRef().ExportToWkt() == "POINT (0 0)"
+    ds = None
+
+
+@pytest.mark.parametrize("batch_size", ["7", "AUTO"])
+def test_ogr_h2gis_batch_size(h2gis_ds, batch_size):
+    """Test BATCH_SIZE on table layers and ExecuteSQL() results."""
+    lyr = h2gis_ds.CreateLayer("batch_size_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+
+    nFeatures = 1200
+    assert h2gis_ds.StartTransaction() == 0
+    for i in range(nFeatures):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} 0)"))
+        assert lyr.CreateFeature(feat) == 0
+    assert h2gis_ds.CommitTransaction() == 0
+
+    ds = gdal.OpenEx(h2gis_ds.GetDescription(), gdal.OF_VECTOR,
+                     open_options=[f"BATCH_SIZE={batch_size}"])
+    assert ds is not None
+    lyr = ds.GetLayerByName("batch_size_test")
+    assert [f.GetField("idx") for f in lyr] == list(range(nFeatures))
+
+    sql_lyr = ds.ExecuteSQL(
+        'SELECT "idx" FROM "batch_size_test" ORDER BY "idx"')
+    assert [f.GetField(0) for f in sql_lyr] == list(range(nFeatures))
+    ds.ReleaseResultSet(sql_lyr)
+    ds = None
+
+
+def test_ogr_h2gis_stats(h2gis_ds):
+    """Test the H2GIS_STATS metadata domain of layers and datasources."""
+    lyr = h2gis_ds.CreateLayer("stats_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+    for i in range(20):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} 0)"))
+        assert lyr.CreateFeature(feat) == 0
+
+    assert "H2GIS_STATS" in lyr.GetMetadataDomainList()
+    before = lyr.GetMetadata("H2GIS_STATS")
+    lyr.ResetReading()
+    assert sum(1 for _ in lyr) == 20
+    after = lyr.GetMetadata("H2GIS_STATS")
+    assert int(after["QUERIES"]) == int(before["QUERIES"]) + 1
+    assert int(after["ROWS"]) == int(before["ROWS"]) + 20
+    assert int(after["BYTES"]) > int(before["BYTES"])
+    assert float(after["FETCH_WAIT_MS"]) >= 0
+
+    sql_lyr = h2gis_ds.ExecuteSQL('SELECT "idx" FROM "stats_test"')
+    assert sum(1 for _ in sql_lyr) == 20
+    assert int(sql_lyr.GetMetadata("H2GIS_STATS")["ROWS"]) == 20
+    h2gis_ds.ReleaseResultSet(sql_lyr)
+
+    stats = h2gis_ds.GetMetadata("H2GIS_STATS")
+    assert int(stats["ROWS"]) >= 40
+    assert int(stats["WRAPPER_TASKS"]) > 0
+    assert int(stats["WRAPPER_PREPARES"]) >= int(stats["QUERIES"])
+    assert int(stats["WRAPPER_FETCH_ROWS"]) >= int(stats["ROWS"])
+    assert float(stats["WRAPPER_WORKER_MS"]) > 0
+
+
+def test_ogr_h2gis_eager_init(tmp_path):
+    """Test H2GIS_EAGER_INIT=YES in a fresh process."""
+    import os
+    import subprocess
+    import sys
+
+    db_path = str(tmp_path / "eager.mv.db")
+    script = (
+        "from osgeo import gdal, ogr\n"
+        "ds = ogr.GetDriverByName('H2GIS').CreateDataSource(%r)\n"
+        "lyr = ds.CreateLayer('eager', geom_type=ogr.wkbPoint)\n"
+        "feat = ogr.Feature(lyr.GetLayerDefn())\n"
+        "feat.SetGeometry(ogr.CreateGeometryFromWkt('POINT (1 2)'))\n"
+        "assert lyr.CreateFeature(feat) == 0\n"
+        "lyr.ResetReading()\n"
+        "print(lyr.GetNextFeature().GetGeometryRef().ExportToWkt())\n"
+        % db_path)
+    env = dict(os.environ, H2GIS_EAGER_INIT="YES")
+    out = subprocess.run([sys.executable, "-c", script], env=env,
+                         capture_output=True, text=True, timeout=120)
+    assert out.returncode == 0, out.stderr
+    assert "POINT (1 2)" in out.stdout
+
+
+def test_ogr_h2gis_simplify_tolerance(h2gis_ds):
+    """Test SIMPLIFY_TOLERANCE on scans of a read-only dataset."""
+    lyr = h2gis_ds.CreateLayer("simplify_test", geom_type=ogr.wkbPolygon)
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetGeometry(ogr.CreateGeometryFromWkt(
+        "POLYGON ((0 0, 1 0.001, 2 0, 2 2, 0 2, 0 0))"))
+    assert lyr.CreateFeature(feat) == 0
+    fid = feat.GetFID()
+    lyr.SyncToDisk()
+
+    messages = []
+    gdal.PushErrorHandler(lambda cls, no, msg: messages.append(msg))
+    try:
+        ds = gdal.OpenEx(h2gis_ds.GetDescription(), gdal.OF_VECTOR,
+                         open_options=["SIMPLIFY_TOLERANCE=0.1"])
+    finally:
+        gdal.PopErrorHandler()
+    assert ds is not None
+    lyr = ds.GetLayerByName("simplify_test")
+    geom = lyr.GetNextFeature().GetGeometryRef()
+    if any("not available" in m for m in messages):
+        # Native library built without the generalization functions
+        assert geom.GetGeometryRef(0).GetPointCount() == 6
+    else:
+        assert geom.GetGeometryRef(0).GetPointCount() == 5
+        # Lookups by FID stay exact
+        geom = lyr.GetFeature(fid).GetGeometryRef()
+        assert geom.GetGeometryRef(0).GetPointCount() == 6
+    ds = None
+
+    # Ignored in update mode
+    gdal.PushErrorHandler("CPLQuietErrorHandler")
+    try:
+        ds = gdal.OpenEx(h2gis_ds.GetDescription(),
+                         gdal.OF_VECTOR | gdal.OF_UPDATE,
+                         open_options=["SIMPLIFY_TOLERANCE=0.1"])
+    finally:
+        gdal.PopErrorHandler()
+    lyr = ds.GetLayerByName("simplify_test")
+    geom = lyr.GetNextFeature().GetGeometryRef()
+    assert geom.GetGeometryRef(0).GetPointCount() == 6
+    ds = None
+
+
+def test_ogr_h2gis_update_delete_upsert(h2gis_ds):
+    """Test prepared updates, buffered deletes and upserts."""
+    lyr = h2gis_ds.CreateLayer("edit_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("name", ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn("val", ogr.OFTInteger))
+    fids = []
+    for i in range(50):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("name", f"f{i}")
+        feat.SetField("val", i)
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} 0)"))
+        assert lyr.CreateFeature(feat) == 0
+        fids.append(feat.GetFID())
+
+    for fid in fids:
+        feat = lyr.GetFeature(fid)
+        feat.SetField("val", feat.GetField("val") + 100)
+        assert lyr.SetFeature(feat) == 0
+    lyr.ResetReading()
+    assert sorted(f.GetField("val") for f in lyr) == list(range(100, 150))
+
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetFID(max(fids) + 1000)
+    assert lyr.SetFeature(feat) == ogr.OGRERR_NON_EXISTING_FEATURE
+
+    # Deletes are queued, then run before the next read
+    for fid in fids[:20]:
+        assert lyr.DeleteFeature(fid) == 0
+    assert lyr.GetFeatureCount() == 30
+    assert lyr.GetFeature(fids[0]) is None
+
+    # A deleted FID can be created again
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetFID(fids[0])
+    feat.SetField("val", -1)
+    assert lyr.DeleteFeature(fids[20]) == 0
+    assert lyr.CreateFeature(feat) == 0
+    assert lyr.GetFeature(fids[0]).GetField("val") == -1
+    assert lyr.GetFeature(fids[20]) is None
+    assert lyr.GetFeatureCount() == 30
+
+    if not hasattr(lyr, "UpsertFeature"):
+        return
+    assert lyr.TestCapability(ogr.OLCUpsertFeature) == 1
+    # Existing FID: replaced, unset fields keep their value
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetFID(fids[30])
+    feat.SetField("val", 7)
+    assert lyr.UpsertFeature(feat) == 0
+    feat = lyr.GetFeature(fids[30])
+    assert feat.GetField("val") == 7
+    assert feat.GetField("name") == "f30"
+    # New FID: inserted
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetFID(max(fids) + 1)
+    feat.SetField("name", "new")
+    assert lyr.UpsertFeature(feat) == 0
+    assert lyr.GetFeature(max(fids) + 1).GetField("name") == "new"
+    assert lyr.GetFeatureCount() == 31
+
+
+def test_ogr_h2gis_deferred_table_creation(h2gis_ds):
+    """Test that the fields created after CreateLayer join its CREATE TABLE."""
+    lyr = h2gis_ds.CreateLayer("wide_test", geom_type=ogr.wkbPoint)
+    for i in range(50):
+        assert lyr.CreateField(ogr.FieldDefn(f"f{i}", ogr.OFTInteger)) == 0
+
+    # The SQL statement creates the table, with every column
+    sql_lyr = h2gis_ds.ExecuteSQL(
+        "SELECT COUNT(*) FROM INFORMATION_SCHEMA.COLUMNS "
+        "WHERE TABLE_NAME = 'wide_test'")
+    assert sql_lyr.GetNextFeature().GetField(0) == 52
+    h2gis_ds.ReleaseResultSet(sql_lyr)
+
+    # Fields created afterwards alter the table
+    assert lyr.CreateField(ogr.FieldDefn("late", ogr.OFTString)) == 0
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField("f49", 49)
+    feat.SetField("late", "x")
+    feat.SetGeometry(ogr.CreateGeometryFromWkt("POINT (1 2)"))
+    assert lyr.CreateFeature(feat) == 0
+    lyr.ResetReading()
+    feat = lyr.GetNextFeature()
+    assert feat.GetField("f49") == 49
+    assert feat.GetField("late") == "x"
+
+    # Created by the first feature, with its spatial index
+    lyr = h2gis_ds.CreateLayer("narrow_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("name", ogr.OFTString))
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField("name", "a")
+    assert lyr.CreateFeature(feat) == 0
+    assert lyr.GetFeatureCount() == 1
+
+    gdal.PushErrorHandler("CPLQuietErrorHandler")
+    assert h2gis_ds.CreateLayer("narrow_test") is None
+    gdal.PopErrorHandler()
+
+
+def test_ogr_h2gis_shared_database(h2gis_ds):
+    """Test datasets opening the same database share its connections and
+    layer list."""
+    lyr = h2gis_ds.CreateLayer("shared_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("name", ogr.OFTString))
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField("name", "a")
+    feat.SetGeometry(ogr.CreateGeometryFromWkt("POINT (1 2)"))
+    assert lyr.CreateFeature(feat) == 0
+    assert lyr.SyncToDisk() == 0
+    path = h2gis_ds.GetDescription()
+
+    # The first dataset opened reads the layer list, the next ones reuse it
+    ds2 = gdal.OpenEx(path, gdal.OF_VECTOR)
+    ds3 = gdal.OpenEx(path, gdal.OF_VECTOR)
+    for ds in (ds2, ds3):
+        assert ds.GetLayerCount() == 1
+        assert ds.GetLayer(0).GetFeatureCount() == 1
+    ds2 = None
+
+    # Takes the connection ds2 released
+    ds4 = gdal.OpenEx(path, gdal.OF_VECTOR)
+    feat = ds4.GetLayerByName("shared_test").GetNextFeature()
+    assert feat.GetField("name") == "a"
+    ds3 = None
+    ds4 = None
+
+    # Schema changes are seen by the datasets opened afterwards
+    h2gis_ds.ExecuteSQL("CREATE TABLE \"other_test\" (\"ID\" INT PRIMARY KEY)")
+    ds5 = gdal.OpenEx(path, gdal.OF_VECTOR)
+    assert ds5.GetLayerCount() == 2
+    assert ds5.GetLayerByName("other_test") is not None
+    ds5 = None
+
+
+def test_ogr_h2gis_shared_database_metadata_cache(tmp_path, h2gis_driver):
+    """Test that the last dataset of a database closed does not save its
+    layer list to METADATA_CACHE after another one changed the schema."""
+    path = str(tmp_path / "shared_cache.mv.db")
+    ds = h2gis_driver.CreateDataSource(path)
+    ds.CreateLayer("first", geom_type=ogr.wkbPoint)
+    ds = None
+    cache = tmp_path / "shared_cache.h2gis_cache.json"
+
+    options = ["METADATA_CACHE=YES"]
+    ds1 = gdal.OpenEx(path, gdal.OF_VECTOR | gdal.OF_UPDATE,
+                      open_options=options)
+    ds2 = gdal.OpenEx(path, gdal.OF_VECTOR | gdal.OF_UPDATE,
+                      open_options=options)
+    assert ds1.GetLayerCount() == 1
+    lyr = ds2.CreateLayer("second", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("name", ogr.OFTString))
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField("name", "a")
+    assert lyr.CreateFeature(feat) == 0
+    ds2 = None
+    ds1 = None
+    assert not cache.exists()
+
+    ds = gdal.OpenEx(path, gdal.OF_VECTOR, open_options=options)
+    assert ds.GetLayerCount() == 2
+    lyr = ds.GetLayerByName("second")
+    assert lyr.GetLayerDefn().GetFieldIndex("name") >= 0
+    assert lyr.GetFeatureCount() == 1
+    ds = None
+    assert cache.exists()
+
+
+def test_ogr_h2gis_tile_cache(h2gis_ds):
+    """Test TILE_CACHE serves overlapping spatial filters from memory."""
+    lyr = h2gis_ds.CreateLayer("tile_cache_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+    for i in range(100):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        feat.SetGeometry(
+            ogr.CreateGeometryFromWkt(f"POINT ({i % 10} {i // 10})"))
+        assert lyr.CreateFeature(feat) == 0
+    lyr.SyncToDisk()
+
+    def scan(lyr, rect):
+        lyr.SetSpatialFilterRect(*rect)
+        lyr.ResetReading()
+        return sorted((f.GetFID(), f.GetField("idx")) for f in lyr)
+
+    rects = [(1.5, 1.5, 4.5, 4.5), (2.5, 2.5, 5.5, 5.5), (1.5, 1.5, 4.5, 4.5)]
+    expected = [scan(lyr, rect) for rect in rects]
+    assert len(expected[0]) == 9
+
+    ds = gdal.OpenEx(h2gis_ds.GetDescription(),
+                     gdal.OF_VECTOR | gdal.OF_UPDATE,
+                     open_options=["TILE_CACHE=16"])
+    lyr = ds.GetLayerByName("tile_cache_test")
+    assert [scan(lyr, rect) for rect in rects] == expected
+
+    # Filters within the tiles read already run no query
+    before = int(lyr.GetMetadata("H2GIS_STATS")["QUERIES"])
+    assert scan(lyr, (2, 2, 4, 4)) == scan(h2gis_ds.GetLayerByName(
+        "tile_cache_test"), (2, 2, 4, 4))
+    assert int(lyr.GetMetadata("H2GIS_STATS")["QUERIES"]) == before
+
+    # Writes drop the tiles
+    feat = lyr.GetFeature(expected[0][0][0])
+    feat.SetField("idx", -1)
+    assert lyr.SetFeature(feat) == 0
+    assert (expected[0][0][0], -1) in scan(lyr, rects[0])
+    assert lyr.DeleteFeature(expected[0][0][0]) == 0
+    assert len(scan(lyr, rects[0])) == 8
+    ds = None
+
+
+def test_ogr_h2gis_spatial_filter_geometry(h2gis_ds):
+    """Test spatial filters use the filter geometry, or its envelope with
+    SPATIAL_FILTER=BBOX."""
+    lyr = h2gis_ds.CreateLayer("filter_geom_test", geom_type=ogr.wkbPoint)
+    for wkt in ("POINT (1 1)", "POINT (9 1)", "POINT (9 9)", "POINT (20 20)"):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(wkt))
+        assert lyr.CreateFeature(feat) == 0
+    lyr.SyncToDisk()
+
+    # (9 9) is within the envelope of the triangle, not within the triangle
+    triangle = ogr.CreateGeometryFromWkt(
+        "POLYGON ((0 0, 10 0, 0 10, 0 0))")
+    lyr.SetSpatialFilter(triangle)
+    lyr.ResetReading()
+    assert sorted(f.GetGeometryRef().GetX() for f in lyr) == [1, 9]
+    assert lyr.GetFeatureCount() == 2
+
+    # Moving the filter reruns the same statement with another geometry
+    lyr.SetSpatialFilterRect(15, 15, 25, 25)
+    assert lyr.GetFeatureCount() == 1
+    lyr.ResetReading()
+    assert lyr.GetNextFeature().GetGeometryRef().GetX() == 20
+    lyr.SetSpatialFilter(None)
+
+    ds = gdal.OpenEx(h2gis_ds.GetDescription(), gdal.OF_VECTOR,
+                     open_options=["SPATIAL_FILTER=BBOX"])
+    lyr = ds.GetLayerByName("filter_geom_test")
+    lyr.SetSpatialFilter(triangle)
+    lyr.ResetReading()
+    assert sorted(f.GetGeometryRef().GetY() for f in lyr) == [1, 1, 9]
+    assert lyr.GetFeatureCount() == 3
+    ds = None
+
+
+def test_ogr_h2gis_parallel_scan(h2gis_ds):
+    """Test PARALLEL_SCAN=N returns every row once, with and without filter."""
+    lyr = h2gis_ds.CreateLayer("parallel_scan_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("idx", ogr.OFTInteger))
+
+    nFeatures = 45000  # 4 ranges of at least 10000 rows
+    assert h2gis_ds.StartTransaction() == 0
+    for i in range(nFeatures):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("idx", i)
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} 0)"))
+        assert lyr.CreateFeature(feat) == 0
+    assert h2gis_ds.CommitTransaction() == 0
+
+    ds = gdal.OpenEx(h2gis_ds.GetDescription(), gdal.OF_VECTOR,
+                     open_options=["PARALLEL_SCAN=4"])
+    assert ds is not None
+    lyr = ds.GetLayerByName("parallel_scan_test")
+    assert lyr is not None
+
+    # Batches come from the ranges in turn: same rows, in another order.
+    # A single worker thread would read the ranges one after another, so
+    # the option is then ignored (see test_ogr_h2gis_worker_pool).
+    messages = []
+    gdal.PushErrorHandler(lambda cls, no, msg: messages.append(msg))
+    try:
+        assert sorted(f.GetField("idx") for f in lyr) == list(range(nFeatures))
+    finally:
+        gdal.PopErrorHandler()
+    single_worker = int(gdal.GetConfigOption("H2GIS_WORKER_THREADS", "1")) < 2
+    assert any("PARALLEL_SCAN=4 ignored" in m
+               for m in messages) == single_worker
+
+    # The range predicates are ANDed to the whole pushed-down filter
+    lyr.SetAttributeFilter("idx < 10 OR idx >= 44990")
+    assert sorted(f.GetField("idx") for f in lyr) == (
+        list(range(10)) + list(range(44990, nFeatures)))
+
+    # Reset while every range has a batch in flight
+    lyr.SetAttributeFilter(None)
+    for _ in range(1500):
+        assert lyr.GetNextFeature() is not None
+    lyr.ResetReading()
+    assert sum(1 for _ in lyr) == nFeatures
+    ds = None
+
+
+def test_ogr_h2gis_worker_pool(tmp_path):
+    """Test scans spread over several worker threads, in a fresh process
+    started with H2GIS_WORKER_THREADS=4."""
+    import os
+    import subprocess
+    import sys
+
+    db_path = str(tmp_path / "pool.mv.db")
+    script = """
+from osgeo import gdal, ogr
+path = %r
+n = 45000  # 4 ranges of at least 10000 rows
+ds = ogr.GetDriverByName('H2GIS').CreateDataSource(path)
+lyr = ds.CreateLayer('pool', geom_type=ogr.wkbPoint)
+lyr.CreateField(ogr.FieldDefn('idx', ogr.OFTInteger))
+assert ds.StartTransaction() == 0
+for i in range(n):
+    feat = ogr.Feature(lyr.GetLayerDefn())
+    feat.SetField('idx', i)
+    feat.SetGeometry(ogr.CreateGeometryFromWkt('POINT (%%d 0)' %% i))
+    assert lyr.CreateFeature(feat) == 0
+assert ds.CommitTransaction() == 0
+ds = None
+
+# The ranges of the scan run on their own connections, each on a worker
+ds = gdal.OpenEx(path, gdal.OF_VECTOR,
+                 open_options=['PARALLEL_SCAN=4', 'PREFETCH=YES'])
+lyr = ds.GetLayerByName('pool')
+assert sorted(f.GetField('idx') for f in lyr) == list(range(n))
+
+# Reset while every range has a batch in flight
+for _ in range(1500):
+    assert lyr.GetNextFeature() is not None
+lyr.ResetReading()
+assert sum(1 for _ in lyr) == n
+
+# A second dataset scans, prefetching, in step with the parallel scan
+ds2 = gdal.OpenEx(path, gdal.OF_VECTOR, open_options=['PREFETCH=YES'])
+lyr2 = ds2.GetLayerByName('pool')
+lyr.ResetReading()
+fids = {}
+seen = []
+for f, f2 in zip(lyr, lyr2):
+    seen.append(f.GetField('idx'))
+    fids[f2.GetFID()] = f2.GetField('idx')
+assert len(fids) == n
+assert sorted(seen) == list(range(n))
+
+# GetFeature bursts on both datasets
+for fid in list(fids)[100:400]:
+    assert lyr2.GetFeature(fid).GetField('idx') == fids[fid]
+    assert lyr.GetFeature(fid).GetField('idx') == fids[fid]
+
+# A failure on one worker leaves the datasets usable
+gdal.PushErrorHandler('CPLQuietErrorHandler')
+assert ds2.ExecuteSQL('SELECT * FROM "no_such_table"') is None
+gdal.PopErrorHandler()
+assert lyr2.GetFeatureCount() == n
+lyr.SetAttributeFilter('idx >= 44990')
+assert sorted(f.GetField('idx') for f in lyr) == list(range(44990, n))
+ds2 = None
+ds = None
+print('OK')
+""" % db_path
+    env = dict(os.environ, H2GIS_WORKER_THREADS="4",
+               CPL_DEBUG="H2GIS_WRAPPER")
+    out = subprocess.run([sys.executable, "-c", script], env=env,
+                         capture_output=True, text=True, timeout=600)
+    assert out.returncode == 0, out.stderr[-4000:]
+    assert "OK" in out.stdout
+    assert "4 worker thread(s) running" in out.stderr
+    assert "PARALLEL_SCAN=4 ignored" not in out.stderr
+
+
+def test_ogr_h2gis_arrow_stream(h2gis_ds):
+    """Test native Arrow C stream export built from fetched batches."""
+    pytest.importorskip("osgeo.gdal_array")
+
+    lyr = h2gis_ds.CreateLayer("arrow_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("ival", ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn("rval", ogr.OFTReal))
+    lyr.CreateField(ogr.FieldDefn("sval", ogr.OFTString))
+
+    for i in range(25):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("ival", i)
+        feat.SetField("rval", i * 0.5)
+        feat.SetField("sval", f"name_{i}")
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {-i})"))
+        assert lyr.CreateFeature(feat) == 0
+
+    assert lyr.TestCapability(ogr.OLCFastGetArrowStream)
+
+    lyr.ResetReading()
+    stream = lyr.GetArrowStreamAsNumPy(options=["USE_MASKED_ARRAYS=NO"])
+    ivals, rvals, svals, geoms = [], [], [], []
+    for batch in stream:
+        ivals += list(batch["ival"])
+        rvals += list(batch["rval"])
+        svals += [s.decode("utf-8") for s in batch["sval"]]
+        geoms += list(batch["GEOM"])
+
+    assert ivals == list(range(25))
+    assert rvals == [i * 0.5 for i in range(25)]
+    assert svals == [f"name_{i}" for i in range(25)]
+    # SRID must be stripped: plain WKB readable by OGR
+    g = ogr.CreateGeometryFromWkb(bytes(geoms[3]))
+    assert g is not None
+    assert g.ExportToWkt() == "POINT (3 -3)"
+
+
+def test_ogr_h2gis_arrow_stream_max_features(h2gis_ds):
+    """Test that the native Arrow path splits fetched batches to honour
+    MAX_FEATURES_IN_BATCH."""
+    pytest.importorskip("osgeo.gdal_array")
+
+    lyr = h2gis_ds.CreateLayer("arrow_max_test", geom_type=ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn("ival", ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn("sval", ogr.OFTString))
+    for i in range(25):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField("ival", i)
+        feat.SetField("sval", f"name_{i}")
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(f"POINT ({i} {-i})"))
+        assert lyr.CreateFeature(feat) == 0
+
+    lyr.ResetReading()
+    stream = lyr.GetArrowStreamAsNumPy(
+        options=["USE_MASKED_ARRAYS=NO", "MAX_FEATURES_IN_BATCH=4"])
+    lengths, ivals, svals, geoms = [], [], [], []
+    for batch in stream:
+        lengths.append(len(batch["ival"]))
+        ivals += list(batch["ival"])
+        svals += [s.decode("utf-8") for s in batch["sval"]]
+        geoms += list(batch["GEOM"])
+
+    assert lengths == [4] * 6 + [1]
+    assert ivals == list(range(25))
+    assert svals == [f"name_{i}" for i in range(25)]
+    g = ogr.CreateGeometryFromWkb(bytes(geoms[21]))
+    assert g.ExportToWkt() == "POINT (21 -21)"